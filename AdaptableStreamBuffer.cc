@@ -6,7 +6,7 @@
 	2018/09/09	Originated
 	2023/03/29	Refactored as generic adapter stream
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 
 REFERENCES:
 	https://en.cppreference.com/w/cpp/io/basic_streambuf/
@@ -17,8 +17,18 @@ REFERENCES:
 #include <string.h>
 
 #include <algorithm>
+#include <bit>
 #include <fstream>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LINEFILTER_SSE2
+#endif
+
 #include "AdaptableStreamBuffer.h"
 
 
@@ -178,3 +188,184 @@ return *this;
 // explicit instantiation
 template struct Splicer<char>;
 template struct Splicer<wchar_t>;
+
+
+
+/*
+
+	LineFilter
+
+*/
+
+/*	Find
+	Return the first occurrence of either character in the range, or 'end' if there is none
+*/
+template <typename Char>
+Char *LineFilter<Char>::Find(
+	Char		*begin,
+	Char		*end,
+	Char		a,
+	Char		b
+	)
+{
+#if defined(LINEFILTER_SSE2)
+// compare a vector at a time, in elements of the size of the character
+auto Equal = [](__m128i v, __m128i c) {
+	if constexpr (sizeof(Char) == 1) return _mm_cmpeq_epi8(v, c);
+	else if constexpr (sizeof(Char) == 2) return _mm_cmpeq_epi16(v, c);
+	else return _mm_cmpeq_epi32(v, c);
+	};
+auto Splat = [](Char c) {
+	if constexpr (sizeof(Char) == 1) return _mm_set1_epi8(static_cast<char>(c));
+	else if constexpr (sizeof(Char) == 2) return _mm_set1_epi16(static_cast<short>(c));
+	else return _mm_set1_epi32(static_cast<int>(c));
+	};
+constexpr size_t kVector = sizeof(__m128i) / sizeof(Char);
+
+const __m128i va = Splat(a), vb = Splat(b);
+for (; end - begin >= static_cast<ptrdiff_t>(kVector); begin += kVector) {
+	const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+	if (const unsigned hits = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(Equal(v, va), Equal(v, vb)))))
+		return begin + std::countr_zero(hits) / sizeof(Char);
+	}
+#endif
+
+for (; begin < end; begin++)
+	if (*begin == a || *begin == b) break;
+
+return begin;
+}
+
+
+/*	Filter
+	Filter the data, moving it down to 'out'; return the end of the filtered data
+*/
+template <typename Char>
+Char *LineFilter<Char>::Filter(
+	Char		*out,
+	Char		*in,
+	Char		*end
+	)
+{
+while (in < end) {
+	// move the run up to the next line end
+	Char *const found = Find(in, end, '\r', fUnfold ? '\n' : '\r');
+	if (out != in) std::copy(in, found, out);
+	out += found - in;
+	in = found;
+	if (in == end) break;
+	
+	// CR?  Assume CR/LF always appear in pairs, so just remove it
+	if (*in++ == '\r') continue;
+	
+	// LF; any CRs that follow it would be removed anyway
+	while (in < end && *in == '\r') in++;
+	
+	// LF at the end?  hold it back in case the next data starts with a continuation
+	if (in == end) {
+		fHeldLF = true;
+		break;
+		}
+	
+	// continuation?  remove the LF as well as the whitespace
+	if (*in == ' ' || *in == '\t')
+		in++;
+	
+	else
+		*out++ = '\n';
+	}
+
+return out;
+}
+
+
+/*	()
+	Filter the given data; or at the end of input, if there is none
+	'end' to 'limit' is available should an LF that was held back need to be restored
+*/
+template <typename Char>
+Char *LineFilter<Char>::operator()(
+	Char		*begin,
+	Char		*end,
+	const Char	*limit
+	)
+{
+Char *in = begin;
+
+// LF held back from the last data?
+if (fHeldLF) {
+	// skip the CR of a CR/LF that was split
+	while (in < end && *in == '\r') in++;
+	
+	// nothing else yet?  keep waiting, unless this is the end of input
+	if (in == end && begin < end) return begin;
+	fHeldLF = false;
+	
+	// a continuation after all?
+	if (in < end && (*in == ' ' || *in == '\t'))
+		in++;
+	
+	// LF was rightly a line end, restore it
+	else if (in > begin) {
+		*begin = '\n';
+		return Filter(begin + 1, in, end);
+		}
+	
+	else {
+		Char *const filteredE = Filter(begin, begin, end);
+		assert(filteredE < limit);
+		std::copy_backward(begin, filteredE, filteredE + 1);
+		*begin = '\n';
+		return filteredE + 1;
+		}
+	}
+
+return Filter(begin, in, end);
+}
+
+
+
+/*	CRLF
+	Remove any CRs, and put one back before every LF
+	Any CR that is already there is taken out first, so that nothing depends on what the
+	last data ended with.  The result is at most twice as long as the original.
+*/
+template <typename Char>
+Char *LineFilter<Char>::CRLF(
+	Char		*begin,
+	Char		*end,
+	const Char	*limit
+	)
+{
+// take out the CRs, counting the LFs
+Char *out = begin;
+size_t lfL = 0;
+for (Char *in = begin; ; ) {
+	Char *const found = Find(in, end, '\r', '\n');
+	
+	// move the run down
+	if (out != in) std::copy(in, found, out);
+	out += found - in;
+	
+	if (found == end) break;
+	if (*found == '\n') *out++ = '\n', lfL++;
+	in = found + 1;
+	}
+
+// then working back from the end, open up space for a CR before each LF
+Char *const result = out + lfL;
+assert(result <= limit);
+
+for (Char *in = out, *moved = result; moved > in; ) {
+	Char *const lf = std::find(std::make_reverse_iterator(in), std::make_reverse_iterator(begin), '\n').base() - 1;
+	moved = std::copy_backward(lf, in, moved);
+	*--moved = '\r';
+	in = lf;
+	}
+
+return result;
+}
+
+// explicit instantiation
+template struct LineFilter<char>;
+template struct LineFilter<wchar_t>;
@@ -6,7 +6,7 @@
 	2018/09/09	Originated
 	2023/03/29	Refactored as generic adapter stream
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 	
 	Consider this an experiment in managing templates through explicit instantiation.
 	Of course, this only works if you can predict at build time all the template instantiations
@@ -25,7 +25,11 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include <algorithm>
+#include <new>
 #include <streambuf>
+#include <string>
+#include <vector>
 
 #include "CBuffer.h"
 
@@ -96,6 +100,36 @@ public:
 
 
 
+/*	LineFilter
+	Block filter that removes CRs, and optionally unfolds continuation lines [RFC5545 §3.1]
+	
+	Rather than going through a Splicer a character at a time, it searches for the next CR
+	or LF a vector at a time and moves the runs in between in bulk.  The filtered text is
+	never longer than the original; except that an LF at the end of the data is held back
+	until it is known whether the next data starts with a continuation, and then may have
+	to be put back in front of it.
+*/
+template <typename Char>
+struct LineFilter {
+protected:
+	bool		fUnfold,			// unfold continuation lines
+			fHeldLF;			// LF at the end of the last data was held back
+	
+	static Char	*Find(Char *begin, Char *end, Char, Char);
+	Char		*Filter(Char *out, Char *in, Char *end);
+
+public:
+	explicit	LineFilter(bool unfold = false) : fUnfold(unfold), fHeldLF(false) {}
+	
+	void		unfold() { fUnfold = true; }
+	Char		*operator()(Char *begin, Char *end, const Char *limit);
+	
+	// the other way, for output: CR before every LF
+	static Char	*CRLF(Char *begin, Char *end, const Char *limit);
+	};
+
+
+
 /*	aistreambuf
 	Input stream buffer that supports user-defined associated character sequence and
 	transformations on them
@@ -119,6 +153,7 @@ public:
 			aistreambuf(const aistreambuf&) = delete;
 			~aistreambuf() = default;
 	
+	Adapter		&adapter() { return fAdapter; }
 	void		claimed(size_t);
 	const Char	*data() const { return Base::gptr(); }
 	size_t		size() const { return Base::egptr() - Base::gptr(); }
@@ -213,6 +248,156 @@ return 0;
 
 
 
+/*	ristreambuf
+	Input stream buffer like aistreambuf, but for streaming long responses
+
+	The get area is a window that moves through the buffer as data is housed and consumed.
+	Data not yet consumed is only moved when the window reaches the end of the buffer, and
+	then it's usually not more than an incomplete UTF-8 sequence; rather than every time
+	more data is housed.  The buffer grows by doubling, but not beyond the given capacity;
+	past that, less than is available is housed, and the rest is left for later.
+	
+	One element past the housed data is always left spare, for the filter to put back an LF
+	it held back (see LineFilter).  The filter is only given no data at the end of input.
+*/
+template <typename Char, class Adapter, size_t kCapacity = 0x100000>
+class ristreambuf : public std::basic_streambuf<Char> {
+protected:
+	using Base = typename std::basic_streambuf<Char>;
+	using int_type = typename std::basic_streambuf<Char>::int_type;
+	
+	static constexpr size_t kBufferSizeInitial = 0x1000;
+	static_assert(kCapacity >= kBufferSizeInitial);
+	
+	CBuffer<Char>	fBuffer;
+	Adapter		fAdapter;
+	
+	int_type	underflow() override;
+	int		sync() override;
+
+public:
+	template <typename... Args>
+			ristreambuf(Args&&...);
+			ristreambuf(const ristreambuf&) = delete;
+			~ristreambuf() = default;
+	
+	Adapter		&adapter() { return fAdapter; }
+	void		claimed(size_t);
+	const Char	*data() const { return Base::gptr(); }
+	size_t		size() const { return Base::egptr() - Base::gptr(); }
+	};
+
+
+/*	ristreambuf
+	Present input stream buffer interface
+*/
+template <typename Char, class Adapter, size_t kCapacity>
+template <typename... Args>
+ristreambuf<Char, Adapter, kCapacity>::ristreambuf(
+	Args		&&...args
+	) :
+	fBuffer(kBufferSizeInitial),
+	fAdapter(std::forward<Args>(args)...)
+{
+// buffer empty; available for reading into
+Base::setg(fBuffer.Begin(), fBuffer.Begin(), fBuffer.Begin());
+}
+
+
+/*	claimed
+	Indicate that the given amount of occupied get area space was consumed
+*/
+template <typename Char, class Adapter, size_t kCapacity>
+void ristreambuf<Char, Adapter, kCapacity>::claimed(
+	size_t		size
+	)
+{
+// move gptr() forward by that amount
+Char *const p = Base::gptr() + size;
+assert(p <= Base::egptr());
+Base::setg(Base::eback(), p, Base::egptr());
+}
+
+
+/*	underflow
+	Read data into buffer and return next available character
+*/
+template <typename Char, class Adapter, size_t kCapacity>
+typename std::basic_streambuf<Char>::int_type ristreambuf<Char, Adapter, kCapacity>::underflow()
+{
+const size_t presentL = Base::egptr() - Base::gptr();
+
+// nothing left?  start over at the beginning of the buffer, for free
+if (presentL == 0)
+	Base::setg(fBuffer.Begin(), fBuffer.Begin(), fBuffer.Begin());
+
+// not enough room after the get area?
+const size_t
+	availableL = fAdapter.available(),
+	neededL = availableL * Adapter::kOverflowNumerator / Adapter::kOverflowDenominator;
+if (static_cast<size_t>(fBuffer.End() - Base::egptr()) <= neededL) {
+	// move what's left to the beginning of the buffer
+	if (Base::gptr() > fBuffer.Begin())
+		std::copy(Base::gptr(), Base::egptr(), fBuffer.Begin());
+
+	// still not enough room?  grow geometrically, within limits
+	if (presentL + neededL >= fBuffer.Length() && fBuffer.Length() < kCapacity) {
+		size_t length = fBuffer.Length();
+		while (length <= presentL + neededL && length < kCapacity) length *= 2;
+		fBuffer.Reallocate(std::min(length, kCapacity));
+		}
+
+	Base::setg(fBuffer.Begin(), fBuffer.Begin(), fBuffer.Begin() + presentL);
+	}
+
+// until the filter leaves some new data, or there isn't any more
+Char *adjustedE = Base::egptr();
+for (size_t remainingL = availableL; ; remainingL = fAdapter.available()) {
+	// house as much new data after end of get area as there is room for, but one
+	const size_t spareL = fBuffer.End() - adjustedE;
+	const size_t houseL = spareL > 1 ?
+		std::min(remainingL, (spareL - 1) * Adapter::kOverflowDenominator / Adapter::kOverflowNumerator) :
+		0;
+	
+	// full up to the capacity?  the rest will have to wait until some is consumed
+	if (houseL == 0 && remainingL > 0) break;
+	
+	Char *const housedB = adjustedE;
+	const size_t housedL = fAdapter.house(housedB, houseL);
+	
+	// not even room for the next character (as for a surrogate pair)?  likewise
+	if (housedL == 0 && remainingL > 0) break;
+	
+	// process new data for the associated character sequence
+	adjustedE = fAdapter.filter(housedB, housedB + housedL, fBuffer.End());
+	
+	// anything new; or at the end of input?
+	if (adjustedE > Base::egptr() || housedL == 0) break;
+	}
+
+// account for change in length of new data
+Base::setg(fBuffer.Begin(), Base::gptr(), adjustedE);
+
+// return first byte of available data, or EOF
+return Base::gptr() < Base::egptr() ? Base::traits_type::to_int_type(*Base::gptr()) : Base::traits_type::eof();
+}
+
+
+/*	sync
+	Synchronize get area with underlying external character sequence
+*/
+template <typename Char, class Adapter, size_t kCapacity>
+int ristreambuf<Char, Adapter, kCapacity>::sync()
+{
+// force the put area to be flooded
+(void) underflow();
+
+// success
+return 0;
+}
+
+
+
 /*	aostreambuf
 	Generically adapt native text stream to a text buffer that is suitable for submission through HTTP
 	
@@ -245,6 +430,9 @@ protected:
 	int_type	overflow(int_type) override;
 	int		sync() override;
 	
+	// three-argument form is a Microsoft extension
+	void		setp(Char *pbase, Char *pptr, Char *epptr) { Base::setp(pbase, epptr); Base::pbump(static_cast<int>(pptr - pbase)); }
+	
 public:
 	template <typename... Args>
 			aostreambuf(Args&&...);
@@ -273,7 +461,7 @@ aostreambuf<Char, Adapter>::aostreambuf(
 	fAdapter(std::forward<Args>(args)...)
 {
 // buffer empty; available for writing into
-Base::setp(fBuffer.Begin(), fBuffer.Begin(), fBuffer.End());
+setp(fBuffer.Begin(), fBuffer.Begin(), fBuffer.End());
 }
 
 
@@ -303,12 +491,12 @@ if (
 		neededL = presentL + size;
 	
 	// reallocate
-	/* *** probably a buffer chain would make more sense than a repeated monstrous reallocation */
+	/* request bodies go into a costreambuf instead, which doesn't need this */
 	fBuffer.Reallocate(
 		(neededL + (kBufferSizeIncrement - 1)) / kBufferSizeIncrement * kBufferSizeIncrement
 		);
 	
-	Base::setp(fBuffer.Begin() + usedL, fBuffer.Begin() + presentL, fBuffer.End());
+	setp(fBuffer.Begin() + usedL, fBuffer.Begin() + presentL, fBuffer.End());
 	}
 
 // return available put area
@@ -327,7 +515,7 @@ void aostreambuf<Char, Adapter>::used(
 // account
 Char *const p = Base::pptr() + size;
 assert(p <= Base::epptr());
-Base::setp(Base::pbase(), p, Base::epptr());
+setp(Base::pbase(), p, Base::epptr());
 
 // flush immediately
 sync();
@@ -371,12 +559,12 @@ if (neededL > fBuffer.Length()) {
 	fBuffer.Reallocate(reallocatedL);
 	
 	// account after relocation and resizing
-	Base::setp(fBuffer.Begin() + remainingL, fBuffer.Begin() + remainingL, fBuffer.Begin() + reallocatedL);
+	setp(fBuffer.Begin() + remainingL, fBuffer.Begin() + remainingL, fBuffer.Begin() + reallocatedL);
 	}
 
 else
 	// account
-	Base::setp(fBuffer.Begin() + remainingL, fBuffer.Begin() + remainingL, Base::epptr());
+	setp(fBuffer.Begin() + remainingL, fBuffer.Begin() + remainingL, Base::epptr());
 
 // buffer the character
 if (c != Base::traits_type::eof())
@@ -398,3 +586,314 @@ int aostreambuf<Char, Adapter>::sync()
 // success
 return 0;
 }
+
+
+
+/*	costreambuf
+	Output stream buffer like aostreambuf, but that keeps what's written in a chain of blocks
+	
+	For request bodies, which have to be generated in their entirety before they're sent so
+	their length is known: rather than reallocating one buffer over and over as the body
+	grows, blocks of a fixed size are added as they're needed; and handed to the transport
+	one after the other, never concatenated.  Emptied blocks are kept for reuse by the next
+	body on the same thread.
+	
+	Everything written is kept, so the adapter only filters; nothing is evicted.  Since
+	the filter can't spill into the next block, the put area is only that fraction of
+	what's left of the block that the filtered data is sure to fit in.
+*/
+template <typename Char, class Adapter, size_t kBlockSize = 0x10000>
+class costreambuf : public std::basic_streambuf<Char> {
+protected:
+	using Base = typename std::basic_streambuf<Char>;
+	using int_type = typename std::basic_streambuf<Char>::int_type;
+	
+	static constexpr size_t kPooled = 16;
+	
+	struct Block {
+		Char		*fBegin;
+		size_t		fLength,			// allocated
+				fUsed;				// filtered data
+		};
+	
+	std::vector<Block> fBlocks;			// the last one is being written into
+	Adapter		fAdapter;
+	
+	// blocks of the standard size, kept for reuse on this thread
+	struct Pooled : std::vector<Char*> {
+			~Pooled() { for (Char *block: *this) free(block); }
+		};
+	static Pooled	&Pool() { static thread_local Pooled pool; return pool; }
+	void		Append(size_t);
+	void		Release(const Block&);
+	void		Put(Char *pbase, Char *pptr);
+	
+	int_type	overflow(int_type) override;
+	int		sync() override;
+	
+	// three-argument form is a Microsoft extension
+	void		setp(Char *pbase, Char *pptr, Char *epptr) { Base::setp(pbase, epptr); Base::pbump(static_cast<int>(pptr - pbase)); }
+
+public:
+	template <typename... Args>
+			costreambuf(Args&&...);
+			costreambuf(const costreambuf&) = delete;
+			~costreambuf();
+	
+	Adapter		&adapter() { return fAdapter; }
+	
+	Char		*reserve(size_t);
+	void		used(size_t);
+	size_t		size() const;
+	std::basic_string<Char> str() const;
+	
+	template <typename F>
+	void		segments(F&&) const;
+	template <typename F>
+	void		drain(F&&);
+	};
+
+
+
+/*	costreambuf
+	Present stream buffer interface for consumption by HTTP
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+template <typename... Args>
+costreambuf<Char, Adapter, kBlockSize>::costreambuf(
+	Args		&&...args
+	) :
+	fAdapter(std::forward<Args>(args)...)
+{
+Append(kBlockSize);
+}
+
+
+/*	~costreambuf
+	Return the blocks to the pool, as far as it will take them
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+costreambuf<Char, Adapter, kBlockSize>::~costreambuf()
+{
+for (const Block &block: fBlocks) Release(block);
+}
+
+
+/*	Append
+	Start writing into a new block of at least the given size
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+void costreambuf<Char, Adapter, kBlockSize>::Append(
+	size_t		size
+	)
+{
+Block block { nullptr, std::max(size, kBlockSize), 0 };
+
+// a standard size block from the pool if there is one
+Pooled &pool = Pool();
+if (block.fLength == kBlockSize && !pool.empty()) {
+	block.fBegin = pool.back();
+	pool.pop_back();
+	}
+
+else
+	if (!(block.fBegin = static_cast<Char*>(malloc(block.fLength * sizeof(Char))))) throw std::bad_alloc();
+
+fBlocks.push_back(block);
+Put(block.fBegin, block.fBegin);
+}
+
+
+/*	Release
+	Return a block to the pool, or free it if it's not wanted there
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+void costreambuf<Char, Adapter, kBlockSize>::Release(
+	const Block	&block
+	)
+{
+Pooled &pool = Pool();
+if (block.fLength == kBlockSize && pool.size() < kPooled)
+	pool.push_back(block.fBegin);
+else
+	free(block.fBegin);
+}
+
+
+/*	Put
+	Set the put area in the current block, as far as filtered data is sure to fit in it
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+void costreambuf<Char, Adapter, kBlockSize>::Put(
+	Char		*pbase,
+	Char		*pptr
+	)
+{
+const Block &block = fBlocks.back();
+const size_t roomL = block.fBegin + block.fLength - pbase;
+setp(pbase, pptr, pbase + roomL * Adapter::kOverflowDenominator / Adapter::kOverflowNumerator);
+}
+
+
+/*	reserve
+	Ensure at least the given amount of contiguous put area space is available,
+	and return a pointer to it
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+Char *costreambuf<Char, Adapter, kBlockSize>::reserve(
+	size_t		size
+	)
+{
+// need additional space?
+assert(Base::epptr() >= Base::pptr());
+if (static_cast<size_t>(Base::epptr() - Base::pptr()) < size) {
+	// filter what's in the put area, which leaves it the most space it can have in this block
+	(void) overflow(Base::traits_type::eof());
+	
+	// still not enough?
+	if (static_cast<size_t>(Base::epptr() - Base::pptr()) < size) {
+		// current block is no use if there's nothing in it
+		if (fBlocks.back().fUsed == 0) {
+			Release(fBlocks.back());
+			fBlocks.pop_back();
+			}
+		
+		// continue in a new block that will take it
+		Append(
+			(size * Adapter::kOverflowNumerator + (Adapter::kOverflowDenominator - 1)) / Adapter::kOverflowDenominator
+			);
+		}
+	}
+
+// return available put area
+return Base::pptr();
+}
+
+
+/*	used
+	Indicate that the given amount of reserved put area space was populated
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+void costreambuf<Char, Adapter, kBlockSize>::used(
+	size_t		size
+	)
+{
+// account
+Char *const p = Base::pptr() + size;
+assert(p <= Base::epptr());
+setp(Base::pbase(), p, Base::epptr());
+
+// flush immediately
+sync();
+}
+
+
+/*	size
+	Return the total length of the filtered data
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+size_t costreambuf<Char, Adapter, kBlockSize>::size() const
+{
+size_t result = 0;
+for (const Block &block: fBlocks) result += block.fUsed;
+return result;
+}
+
+
+/*	segments
+	Present the filtered data to the given function, one block at a time
+	There's always at least one segment, even if it's empty
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+template <typename F>
+void costreambuf<Char, Adapter, kBlockSize>::segments(
+	F		&&Segment
+	) const
+{
+for (const Block &block: fBlocks)
+	Segment(static_cast<const Char*>(block.fBegin), block.fUsed);
+}
+
+
+/*	drain
+	Present the filtered data to the given function, and then discard it
+	For when it's sent as it's written, rather than kept until it's complete
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+template <typename F>
+void costreambuf<Char, Adapter, kBlockSize>::drain(
+	F		&&Segment
+	)
+{
+sync();
+segments(Segment);
+
+// continue in the first block
+while (fBlocks.size() > 1) {
+	Release(fBlocks.back());
+	fBlocks.pop_back();
+	}
+
+fBlocks.front().fUsed = 0;
+Put(fBlocks.front().fBegin, fBlocks.front().fBegin);
+}
+
+
+/*	str
+	Return all of the filtered data in one piece
+	For when that is needed anyway, and the data isn't large
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+std::basic_string<Char> costreambuf<Char, Adapter, kBlockSize>::str() const
+{
+std::basic_string<Char> result;
+result.reserve(size());
+segments([&result](const Char *data, size_t dataL) { result.append(data, dataL); });
+return result;
+}
+
+
+/*	overflow
+	Filter the put area into the current block; and make space available
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+typename std::basic_streambuf<Char>::int_type costreambuf<Char, Adapter, kBlockSize>::overflow(
+	int_type	c
+	)
+{
+Block &block = fBlocks.back();
+
+// process new data for the associated character sequence
+const Char *adjustedE = fAdapter.filter(
+	Base::pbase(),					// beginning of new, unprocessed data
+	Base::pptr(),					// end of new, unprocessed data
+	block.fBegin + block.fLength			// end of block
+	);
+block.fUsed = adjustedE - block.fBegin;
+
+// put area continues after the filtered data; unless there's no useful space left
+if ((block.fLength - block.fUsed) * Adapter::kOverflowDenominator / Adapter::kOverflowNumerator > 0)
+	Put(block.fBegin + block.fUsed, block.fBegin + block.fUsed);
+
+else
+	Append(kBlockSize);
+
+// buffer the character
+if (c != Base::traits_type::eof())
+	*Base::pptr() = c, Base::pbump(+1);
+
+return c;
+}
+
+
+/*	sync
+	Filter the put area
+*/
+template <typename Char, class Adapter, size_t kBlockSize>
+int costreambuf<Char, Adapter, kBlockSize>::sync()
+{
+(void) overflow(Base::traits_type::eof());
+
+// success
+return 0;
+}
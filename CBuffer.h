@@ -5,7 +5,7 @@
 	
 	2023/03/03	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 */
 
 #pragma once
@@ -6,15 +6,19 @@
 	2019/05/02	Originated
 	2023/05/21	Factored out session management
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "AdaptableStreamBuffer.h"
 #include "CalDAV.h"
+#include "String.h"
 #include "Versioning.h"
 
 
@@ -23,104 +27,18 @@
 
 	CalDAVIAdapter::DecodingInputAdapter
 	
-	Unfolding of content lines [RFC5545 3.1]
+	Unfolding of content lines [RFC5545 §3.1]
 
 */
 
 struct CalDAVIAdapter : CHTTPClient::DecodingInputAdapter<wchar_t> {
-protected:
-	bool		fConsumedLF;
-	
-	void		filterData(Splicer<wchar_t>&),
-			filterEOF(Splicer<wchar_t>&);
-
-public:
+	// CR and LF are ASCII, so unfold in the same pass that removes the CRs, before conversion
 			CalDAVIAdapter(CHTTPClient::Response &response) :
-				CHTTPClient::DecodingInputAdapter<wchar_t>(response),
-				fConsumedLF(false)
-				{}
-	
-	wchar_t		*filter(wchar_t *begin, wchar_t *end, const wchar_t *limit);
+				CHTTPClient::DecodingInputAdapter<wchar_t>(response)
+				{ fNarrow.adapter().unfold(); }
 	};
 
 
-/*	filterData
-	Filter the splicer buffer
-*/
-void CalDAVIAdapter::filterData(
-	Splicer<wchar_t> &ci
-	)
-{
-// for each character of the buffer
-while (ci) {
-	const wchar_t c = ci.read();
-	
-	if (fConsumedLF) {
-		fConsumedLF = false;
-		
-		// linear whitespace?
-		if (c == L' ' || c == L'\t')
-			// LF had been legitimately removed; and the whitespace is a continuation 'control' character
-			;
-		
-		else {
-			// LF was mistakenly removed, restore it
-			ci << L'\n';
-			
-			ci << c;
-			}
-		}
-	
-	else
-		if (c == L'\n')
-			// hold back the LF in case we're followed by 'continuation' whitespace
-			fConsumedLF = true;
-		
-		else
-			ci << c;
-	}
-}
-
-
-/*	filterEOF
-	Filter at the end of input
-*/
-void CalDAVIAdapter::filterEOF(
-	Splicer<wchar_t> &ci
-	)
-{
-// if we had presumptively swallowed a LF, then restore it
-if (fConsumedLF) {
-	ci << L'\n';
-		
-	fConsumedLF = false;
-	}
-}
-
-
-/*	filter
-	Filter the given data
-*/
-wchar_t *CalDAVIAdapter::filter(
-	wchar_t		*begin,
-	wchar_t		*end,
-	const wchar_t	*limit
-	)
-{
-Splicer<wchar_t> ci(begin, end, limit);
-
-// data in input, so not at end of input stream?
-if (ci)
-	filterData(ci);
-
-// at end of input
-else
-	filterEOF(ci);
-
-return ci.end();
-}
-
-
 
 /*
 
@@ -293,7 +211,7 @@ client.Request(
 	CHTTPClient::Rekwest(),
 	[&](CHTTPClient::Response &response) {
 		// present the response as a C++ stream
-		aistreambuf<wchar_t, CalDAVIAdapter> isb(response);
+		ristreambuf<wchar_t, CalDAVIAdapter> isb(response);
 		std::wistream is(&isb);
 		
 		// present response
@@ -303,6 +221,57 @@ client.Request(
 }
 
 
+/*	GetItemContent
+	Get the CalDAV item at the given path as a single piece of UTF-8 text, as received
+	
+	Unlike GetItem this doesn't unfold; it's for a parser that can find the folds in place,
+	such as DynamicCalendar<char>::Parser.
+*/
+void CalDAV::GetItemContent(
+	CHTTPClient	&client,
+	const wchar_t	path[],
+	const std::function<void (std::string_view)> &Recipient
+	)
+{
+// make HTTP 'GET' request
+client.Request(
+	path,
+	L"GET",
+	[](const std::function<void (const wchar_t*, const wchar_t*)>&) {},
+	CHTTPClient::Rekwest(),
+	[&](CHTTPClient::Response &response) {
+		// collect the body as received
+		std::string body;
+		char buffer[0x4000];
+		while (const size_t received = response.Receive(buffer, sizeof buffer))
+			body.append(buffer, received);
+		
+		Recipient(body);
+		}
+	);
+}
+
+
+/*	GetItemContent
+	Get the CalDAV item at the given path as a single piece of text in native wide characters
+*/
+void CalDAV::GetItemContent(
+	CHTTPClient	&client,
+	const wchar_t	path[],
+	const std::function<void (std::wstring_view)> &Recipient
+	)
+{
+GetItemContent(
+	client,
+	path,
+	[&Recipient](const std::string_view content) {
+		// present it in wide characters, converted in one go
+		Recipient(Widen(content));
+		}
+	);
+}
+
+
 /*	SeItem
 	Set the CalDAV item at the given path from text
 */
@@ -312,11 +281,31 @@ void CalDAV::SetItem(
 	const std::function<void (std::wstreambuf&)> &Sender
 	)
 {
-// buffer entire converted stream so we can establish its length
-aostreambuf<wchar_t, CHTTPClient::EncodingOutputAdapter<wchar_t>> osb;
-Sender(osb);
-osb.pubsync();
+// make HTTP 'PUT' request, with the body sent as it's written
+/* (or if the server wants its length first, buffered by the client after all) */
+client.Request(
+	path,
+	L"PUT",
+	[](const std::function<void (const wchar_t*, const wchar_t*)> &AcceptHeaders) {
+		AcceptHeaders(L"Content-Type", L"text/calendar; charset=utf-8");
+		},
+	CHTTPClient::StreamRekwest(Sender),
+	[&](CHTTPClient::Response &response) {
+		// *** ignore response body
+		}
+	);
+}
+
 
+/*	SetItemContent
+	Set the CalDAV item at the given path from a single piece of UTF-8 text, sent as it is
+*/
+void CalDAV::SetItemContent(
+	CHTTPClient	&client,
+	const wchar_t	path[],
+	const std::string_view content
+	)
+{
 // make HTTP 'PUT' request
 client.Request(
 	path,
@@ -324,7 +313,7 @@ client.Request(
 	[](const std::function<void (const wchar_t*, const wchar_t*)> &AcceptHeaders) {
 		AcceptHeaders(L"Content-Type", L"text/calendar; charset=utf-8");
 		},
-	CHTTPClient::Rekwest(osb.adapter().narrow().data(), osb.adapter().narrow().size()),
+	CHTTPClient::Rekwest(content.data(), content.size()),
 	[&](CHTTPClient::Response &response) {
 		// *** ignore response body
 		}
@@ -362,9 +351,89 @@ client.Request(
 	CHTTPClient::Rekwest(body, bodyL),
 	[&](CHTTPClient::Response &response) {
 		// present the response as a C++ stream
-		aistreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(response);
+		ristreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(response);
 		
 		std::wcout << &isb;
 		}
 	);
 }
+
+
+
+/*	MultiGet::Batch
+	Split the paths into lists of <href>, and have each of them requested; several at once,
+	each on its own client to the same server
+*/
+void CalDAV::MultiGet::Batch(
+	CHTTPClient	&client,
+	const std::vector<std::wstring> &paths,
+	const Batching	&batching,
+	const std::function<void (CHTTPClient&, const std::wstring &hrefs)> &Request
+	)
+{
+// split the paths into batches
+std::vector<std::wstring> batches;
+size_t batchN = 0;
+for (const std::wstring &p: paths) {
+	const size_t hrefL = p.size() + std::size(L"<D:href></D:href>") - 1;
+	
+	// start a new batch?
+	if (
+		batches.empty() ||
+		batchN >= batching.fCount ||
+		batches.back().size() + hrefL > batching.fSize
+		) {
+		batches.emplace_back();
+		batchN = 0;
+		}
+	
+	batches.back().append(L"<D:href>").append(p).append(L"</D:href>");
+	batchN++;
+	}
+
+// only one at a time?
+const size_t workersN = std::min<size_t>(std::max(batching.fConcurrency, 1u), batches.size());
+if (workersN <= 1) {
+	for (const std::wstring &hrefs: batches)
+		Request(client, hrefs);
+	return;
+	}
+
+// take batches off the list until there are none left, or one of them failed
+std::mutex mutex;
+size_t next = 0;
+std::exception_ptr error;
+
+std::vector<std::thread> workers;
+workers.reserve(workersN);
+for (size_t i = 0; i < workersN; i++)
+	workers.emplace_back(
+		[&]() {
+			try {
+				// this worker's own connection
+				CHTTPClient batchClient(client);
+				
+				for (;;) {
+					size_t batch;
+					{
+						std::lock_guard lock(mutex);
+						if (error || next == batches.size()) break;
+						batch = next++;
+						}
+					
+					Request(batchClient, batches[batch]);
+					}
+				}
+			
+			catch (...) {
+				std::lock_guard lock(mutex);
+				if (!error) error = std::current_exception();
+				}
+			}
+		);
+
+for (std::thread &worker: workers)
+	worker.join();
+
+if (error) std::rethrow_exception(error);
+}
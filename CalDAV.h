@@ -6,16 +6,21 @@
 	2019/05/02	Originated
 	2023/05/21	Factored out session management
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 	
 	RFC 4791	Calendaring Extensions to WebDAV (CalDAV)
 */
 
 #pragma once
 
+#include <format>
+#include <functional>
 #include <istream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "HTTPClient.h"
 #include "WebDAV.h"
@@ -30,7 +35,10 @@ namespace CalDAV {
 	std::wstring	GetCalendarHomeSet(CHTTPClient&, const wchar_t principalPath[]);
 	void		GetCalendars(CHTTPClient&, const wchar_t path[], const std::function<void (const std::wstring&, const std::wstring&)>&);
 	void		GetItem(CHTTPClient&, const wchar_t path[], const std::function<void (std::wistream&)> &Recipient);
+	void		GetItemContent(CHTTPClient&, const wchar_t path[], const std::function<void (std::string_view)> &Recipient),
+			GetItemContent(CHTTPClient&, const wchar_t path[], const std::function<void (std::wstring_view)> &Recipient);
 	void		SetItem(CHTTPClient&, const wchar_t path[], const std::function<void (std::wstreambuf&)> &Sender);
+	void		SetItemContent(CHTTPClient&, const wchar_t path[], std::string_view content);
 	void		Query(CHTTPClient&, const wchar_t path[], WebDAV::Depth, const char query[]);
 	
 	
@@ -44,7 +52,7 @@ namespace CalDAV {
 	struct SupportedCollationSet;
 	
 	
-	// calendar-multiget RFC 4719 7.9
+	// calendar-multiget RFC 4719 §7.9
 	namespace MultiGet {
 		template <class A, class... Is>
 		void		Properties(
@@ -56,6 +64,36 @@ namespace CalDAV {
 					Is...		is
 					);
 		
+		
+		/*	Batching
+			How to split up a calendar-multiget of many items
+			
+			A batch is closed when it has reached either limit.
+		*/
+		struct Batching {
+			size_t		fCount = 100;			// maximum number of <href> in a request
+			size_t		fSize = 0x8000;			// approximate maximum size of the <href> list in a request
+			unsigned	fConcurrency = 4;		// maximum number of requests in flight
+			};
+		
+		template <class A, class... Is>
+		void		BatchedProperties(
+					CHTTPClient	&client,
+					const wchar_t	path[],
+					DAV::Depth	depth,
+					const std::vector<std::wstring> &paths,
+					const Batching	&batching,
+					A		a,
+					Is...		is
+					);
+		
+		void		Batch(
+					CHTTPClient	&client,
+					const std::vector<std::wstring> &paths,
+					const Batching	&batching,
+					const std::function<void (CHTTPClient&, const std::wstring &hrefs)> &Request
+					);
+		
 		template <class A, class... Is>
 		struct Query;
 		}
@@ -65,17 +103,17 @@ namespace CalDAV {
 
 /*	CalendarData
 	Specify which parts of calendar object resources need to be returned
-	RFC 4791 9.6
+	RFC 4791 §9.6
 */
 template <typename Callable>
 struct CalDAV::CalendarData : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"calendar-data";
+	static constexpr char tag[] = "calendar-data";
 	static constexpr std::wstring_view gXML = L"<C:calendar-data/>";
 	
 	static constexpr StateParser::State
@@ -92,7 +130,7 @@ public:
 
 /*	CalendarHomeSet
 	Return calendar collection resources associated with a given principal resource
-	RFC 4791 6.2.1
+	RFC 4791 §6.2.1
 	
 	This seems actually to be returned within the response 'href', not within the 'calendar-home-set'.
 	On iCloud:
@@ -110,10 +148,10 @@ struct CalDAV::CalendarHomeSet : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"calendar-home-set";
+	static constexpr char tag[] = "calendar-home-set";
 	static constexpr std::wstring_view gXML = L"<calendar-home-set xmlns='urn:ietf:params:xml:ns:caldav'/>";
 	
 	static constexpr StateParser::State gStateHREF {
@@ -123,7 +161,7 @@ public:
 			};
 			
 	static constexpr StateParser::State::Transition gTransitionsFromState[2] = {
-			{ L"href", &gStateHREF },
+			{ "href", &gStateHREF },
 			{}
 			};
 	
@@ -139,17 +177,17 @@ public:
 /*	SupportedCollationSet
 	Return supported collation methods
 	Example of a property with internal structure
-	RFC 4791 7.5.1
+	RFC 4791 §7.5.1
 */
 template <typename Callable>
 struct CalDAV::SupportedCollationSet : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"supported-collation-set";
+	static constexpr char tag[] = "supported-collation-set";
 	static constexpr std::wstring_view gXML = L"<supported-collation-set xmlns='urn:ietf:params:xml:ns:caldav'/>";
 	
 	static constexpr StateParser::State gStateAnything {
@@ -158,7 +196,7 @@ public:
 			};
 			
 	static constexpr StateParser::State::Transition gTransitionsFromState[2] = {
-			{ L"supported-collation", &gStateAnything },
+			{ "supported-collation", &gStateAnything },
 			{}
 			};
 	
@@ -186,12 +224,13 @@ struct CalDAV::MultiGet::Query : public WebDAV::Multistatus<A, WebDAV::PropertyT
 	using PT = WebDAV::PropertyTransitions<Is...>;
 
 protected:
-	// note the end tag has a formatter for the <href> list (see RFC 4719 9.10)
+	// note the end tag has a formatter for the <href> list (see RFC 4719 §9.10)
 	static constexpr std::wstring_view
 			gStartTag = LR"(<C:calendar-multiget xmlns:D="DAV:" xmlns:C="urn:ietf:params:xml:ns:caldav">)",
 			gEndTag = L"{}</C:calendar-multiget>";
 	
 	
+	void		*dummy;				// property transitions are relative to this
 	PT		fProperties;
 
 public:
@@ -266,13 +305,57 @@ FormatString(
 			path, depth,
 			body,
 			[&](CHTTPClient::Response &httpResponse) {
-				// parse XML response
-				StateParser events(decltype(response)::gStateDocument, response);
-				XMLParser parser(events);
-				parser(httpResponse.Content());
+				// parse XML response as it arrives
+				response.Parse([&httpResponse](void *buffer, size_t bufferL) { return httpResponse.Receive(buffer, bufferL); });
 				}
 			);
 		},
 	oss
 	);
 }
+
+
+/*	MultiGet::BatchedProperties
+	Like Properties, but split into several requests of limited size, some of them in flight at once
+	
+	The responses are all parsed into the same response structures as they're received, one at
+	a time; but in the order that they arrive in, not necessarily the order of the paths.
+*/
+template <class A, class... Is>
+void CalDAV::MultiGet::BatchedProperties(
+	CHTTPClient	&client,
+	const wchar_t	path[],
+	DAV::Depth	depth,
+	const std::vector<std::wstring> &paths,
+	const Batching	&batching,
+	A		a,
+	Is...		is
+	)
+{
+// create XML property query string and response parser data structures
+WebDAV::Basic response { Query<A, Is...>(a, is...) };
+std::mutex parsing;
+
+// make HTTP 'REPORT' request for each batch of <href>
+Batch(
+	client,
+	paths,
+	batching,
+	[&](CHTTPClient &batchClient, const std::wstring &hrefs) {
+		// on the heap, as a big batch won't fit on a worker thread's stack
+		const std::wstring body = std::format(decltype(response)::gXML.data(), hrefs);
+		
+		DAV::Report(
+			batchClient,
+			path, depth,
+			body.c_str(),
+			[&](CHTTPClient::Response &httpResponse) {
+				/* Parse XML response as it arrives, one at a time; the other responses wait in
+				   their connections meanwhile, rather than in memory */
+				std::lock_guard lock(parsing);
+				response.Parse([&httpResponse](void *buffer, size_t bufferL) { return httpResponse.Receive(buffer, bufferL); });
+				}
+			);
+		}
+	);
+}
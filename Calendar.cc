@@ -6,7 +6,7 @@
 	
 	2019/05/19	Originated
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 	
 	We've basically implemented based on what we've experienced.  The entire spec ought to be
 	gone through, top to bottom, and conformance checked with unit tests.
@@ -19,12 +19,102 @@
 #include <cctype>
 #include <cstring>
 #include <ctime>
+#include <limits>
 #include <string>
 
 #include "Calendar.h"
 
 
 
+/*	Digits
+	Parse exactly N decimal digits at the start of the string, in the range from minimum to maximum
+	
+	Every DTSTART, DTSTAMP, CREATED and so on comes through here, so the digits are checked
+	and accumulated without any conversion to std::basic_string or stoul; and there's just
+	the one test of the whole field at the end.
+*/
+template <size_t N, typename Char>
+static unsigned Digits(
+	const std::basic_string_view<Char> string,
+	const unsigned	minimum,
+	const unsigned	maximum,
+	const char	error[]
+	)
+{
+if (string.size() < N) throw error;
+
+unsigned value = 0;
+bool invalid = false;
+for (size_t i = 0; i < N; i++) {
+	const unsigned digit = static_cast<unsigned>(string[i]) - '0';
+	invalid |= digit > 9;
+	value = value * 10 + digit;
+	}
+
+if (invalid || value - minimum > maximum - minimum) throw error;
+
+return value;
+}
+
+
+/*	Number
+	Parse the decimal digits at the start of the string, up to the given maximum; and remove them
+*/
+template <typename Char>
+static unsigned long Number(
+	std::basic_string_view<Char> &string,
+	const unsigned long maximum,
+	const char	error[]
+	)
+{
+unsigned long value = 0;
+
+size_t length = 0;
+for (; length < string.size(); length++) {
+	const unsigned digit = static_cast<unsigned>(string[length]) - '0';
+	if (digit > 9) break;
+	
+	if (value > (maximum - digit) / 10) throw error;
+	value = value * 10 + digit;
+	}
+
+if (length == 0) throw error;
+string.remove_prefix(length);
+
+return value;
+}
+
+
+/*	PhysicalLine
+	Return the line at the start of the buffer without its CR/LF; and remove it and the line break
+*/
+template <typename Char>
+static std::basic_string_view<Char> PhysicalLine(
+	std::basic_string_view<Char> &buffer
+	)
+{
+const size_t lineE = buffer.find('\n');
+std::basic_string_view<Char> line = buffer.substr(0, lineE);
+buffer.remove_prefix(lineE != buffer.npos ? lineE + 1 : buffer.size());
+
+if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+return line;
+}
+
+
+/*	Continues
+	Return whether the buffer starts with a continuation line [RFC 5545 §3.1]
+*/
+template <typename Char>
+static bool Continues(
+	const std::basic_string_view<Char> buffer
+	)
+{
+return !buffer.empty() && (buffer.front() == ' ' || buffer.front() == '\t');
+}
+
+
 /*	DateTime::MakeForNowUTC
 	Create a date-time-zone for the current date-time in UTC
 */
@@ -69,9 +159,9 @@ const static struct Parser {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"AUDIO", Action::kAudio },
-	{ L"DISPLAY", Action::kDisplay },
-	{ L"EMAIL", Action::kEMail },
+	{ Literal<Char, "AUDIO">, Action::kAudio },
+	{ Literal<Char, "DISPLAY">, Action::kDisplay },
+	{ Literal<Char, "EMAIL">, Action::kEMail },
 	};
 
 // look for the key
@@ -95,9 +185,9 @@ const static struct Parser {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"CONFIDENTIAL", Classification::kConfidential },
-	{ L"PRIVATE", Classification::kPrivate },
-	{ L"PUBLIC", Classification::kPublic },
+	{ Literal<Char, "CONFIDENTIAL">, Classification::kConfidential },
+	{ Literal<Char, "PRIVATE">, Classification::kPrivate },
+	{ Literal<Char, "PUBLIC">, Classification::kPublic },
 	};
 
 // look for the key
@@ -107,7 +197,7 @@ return parser != std::end(parsers) ? parser->classification : Classification::kO
 
 
 /*	ParseDate
-	Parse "date" (3.3.4)
+	Parse "date" (§3.3.4)
 */
 template <typename Char>
 typename Calendar<Char>::Date Calendar<Char>::Parser::ParseDate(
@@ -117,20 +207,18 @@ typename Calendar<Char>::Date Calendar<Char>::Parser::ParseDate(
 if (date.size() != 8) throw "unexpected date format";
 
 /* I used to have this built on std::from_chars, which operates directly on a string_view;
-   unfortunately, only the narrow-character string_view is available.  sscanf() actually seems
-   a better solution; but then it's a little harder to transparently support the narrow and wide
-   versions.  This way is transparent; rely on short string optimization. */
+   unfortunately, only the narrow-character string_view is available.  Digits works on either. */
 Date result;
-result.fYear = static_cast<unsigned short>(stoul(string(string_view(date.data() + 0, 4))));
-result.fMonth0 = static_cast<unsigned char>(stoul(string(string_view(date.data() + 4, 2))) - 1);
-result.fDay0 = static_cast<unsigned char>(stoul(string(string_view(date.data() + 6, 2))) - 1);
+result.fYear = static_cast<unsigned short>(Digits<4>(date, 0, 9999, "invalid date year"));
+result.fMonth0 = static_cast<unsigned char>(Digits<2>(date.substr(4), 1, 12, "invalid date month") - 1);
+result.fDay0 = static_cast<unsigned char>(Digits<2>(date.substr(6), 1, 31, "invalid date day") - 1);
 
 return result;
 }
 
 
 /*	ParseDateTime
-	Parse Date-Time (3.3.5)
+	Parse Date-Time (§3.3.5)
 	Implemented:
 		FORM #1: DATE WITH LOCAL TIME ("19980118T230000", 15 characters)
 		FORM #2: DATE WITH UTC TIME ("19980119T070000Z", 16 characters)
@@ -147,9 +235,9 @@ DateTime result;
 if (created.size() < 8 + 1 + 6) throw "unexpected date/time format";
 result.fDate = ParseDate(created.substr(0, 8));
 if (created[8] != 'T') throw "no date-time separator";
-result.fTime.fHour = static_cast<unsigned char>(stoul(string(string_view(created.data() + 9, 2))));
-result.fTime.fMinute = static_cast<unsigned char>(stoul(string(string_view(created.data() + 11, 2))));
-result.fTime.fSecond = static_cast<unsigned char>(stoul(string(string_view(created.data() + 13, 2))));
+result.fTime.fHour = static_cast<unsigned char>(Digits<2>(created.substr(9), 0, 23, "invalid time hour"));
+result.fTime.fMinute = static_cast<unsigned char>(Digits<2>(created.substr(11), 0, 59, "invalid time minute"));
+result.fTime.fSecond = static_cast<unsigned char>(Digits<2>(created.substr(13), 0, 60 /* leap second */, "invalid time second"));
 
 // local time zone?
 if (created.size() == 15)
@@ -168,7 +256,7 @@ return result;
 
 
 /*	ParseDuration
-	Parse Duration (3.3.6)
+	Parse Duration (§3.3.6)
 */
 template <typename Char>
 typename Calendar<Char>::Duration Calendar<Char>::Parser::ParseDuration(
@@ -179,19 +267,21 @@ Duration result;
 result.fStyle = Duration::Style::kNone;
 
 // sign
-switch (duration.at(0)) {
+if (duration.empty()) throw "invalid duration";
+switch (duration[0]) {
 	case '+':	result.fNegative = false; duration.remove_prefix(1); break;
 	case '-':	result.fNegative = true; duration.remove_prefix(1); break;
 
 	default:	result.fNegative = false;
 	}
 
-// duration indicator
-if (duration.at(0) != 'P') throw "invalid duration";
+// duration indicator, which must be followed by something
+if (!duration.starts_with('P')) throw "invalid duration";
 duration.remove_prefix(1);
+if (duration.empty()) throw "invalid duration";
 
 while (!duration.empty()) {
-	if (duration.at(0) == 'T') {
+	if (duration[0] == 'T') {
 		duration.remove_prefix(1);
 
 		switch (result.fStyle) {
@@ -204,14 +294,11 @@ while (!duration.empty()) {
 		}
 
 	// parse number
-	typename Duration::Value value; {
-		size_t length;
-		value = static_cast<Duration::Value>(stoul(string(string_view(duration.data(), duration.size())), &length));
-		duration.remove_prefix(length);
-		}
+	const auto value = static_cast<typename Duration::Value>(Number(duration, std::numeric_limits<typename Duration::Value>::max(), "invalid duration"));
 
 	// parse signifier
-	switch (duration.at(0)) {
+	if (duration.empty()) throw "invalid duration";
+	switch (duration[0]) {
 		case 'W':
 			switch (result.fStyle) {
 				case Duration::Style::kNone:	result.fStyle = Duration::Style::kWeek; break;
@@ -252,7 +339,7 @@ while (!duration.empty()) {
 				case Duration::Style::kTime:
 					switch (result.fFrom) {
 						case Duration::Unit::kNone:	result.fFrom = Duration::Unit::kMinute; break;
-						case Duration::Unit::kHour:	if (result.fTo != Duration::Unit::kMinute) throw "invalid duration";
+						case Duration::Unit::kHour:	if (result.fTo != Duration::Unit::kMinute) throw "invalid duration"; break;
 						default:			throw "invalid duration";
 						}
 					break;
@@ -270,7 +357,7 @@ while (!duration.empty()) {
 					switch (result.fFrom) {
 						case Duration::Unit::kNone:	result.fFrom = Duration::Unit::kSecond; break;
 						case Duration::Unit::kHour:
-						case Duration::Unit::kMinute:	if (result.fTo != Duration::Unit::kSecond) throw "invalid duration";
+						case Duration::Unit::kMinute:	if (result.fTo != Duration::Unit::kSecond) throw "invalid duration"; break;
 						default:			throw "invalid duration";
 						}
 					break;
@@ -278,8 +365,11 @@ while (!duration.empty()) {
 				}
 
 			result.fTo = Duration::Unit::kNone;
-			result.fMinutes = value;
+			result.fSeconds = value;
 			break;
+		
+		default:
+			throw "invalid duration";
 		}
 
 	duration.remove_prefix(1);
@@ -303,13 +393,13 @@ static const struct {
 
 	operator	const string_view() const { return key; }
 	} frequencies[] = {
-	{ L"DAILY", Unit::kDaily },
-	{ L"HOURLY", Unit::kHourly },
-	{ L"MINUTELY", Unit::kMinutely },
-	{ L"MONTHLY", Unit::kMonthly },
-	{ L"SECONDLY", Unit::kSecondly },
-	{ L"WEEKLY", Unit::kWeekly },
-	{ L"YEARLY", Unit::kYearly }
+	{ Literal<Char, "DAILY">, Unit::kDaily },
+	{ Literal<Char, "HOURLY">, Unit::kHourly },
+	{ Literal<Char, "MINUTELY">, Unit::kMinutely },
+	{ Literal<Char, "MONTHLY">, Unit::kMonthly },
+	{ Literal<Char, "SECONDLY">, Unit::kSecondly },
+	{ Literal<Char, "WEEKLY">, Unit::kWeekly },
+	{ Literal<Char, "YEARLY">, Unit::kYearly }
 	};
 
 // find the lower bound of key
@@ -361,9 +451,8 @@ void Calendar<Char>::Parser::RecurrenceRule::ParseInterval(
 	)
 {
 // convert to integer
-size_t intervalL;
-unsigned interval = stoul(string(string_view(rule.data(), rule.size())), &intervalL);
-if (intervalL != rule.size()) throw "invalid recurrence rule interval";
+const unsigned interval = static_cast<unsigned>(Number(rule, std::numeric_limits<unsigned>::max(), "invalid recurrence rule interval"));
+if (interval == 0 || !rule.empty()) throw "invalid recurrence rule interval";
 
 Interval(interval);
 }
@@ -433,12 +522,10 @@ for (
 
 	// ordinal value
 	signed char ordinal;
-	if (std::isdigit(weekdaynum.at(0))) {
-		size_t ordinalL;
-		ordinal = stoi(string(string_view(weekdaynum.data(), weekdaynum.length())), &ordinalL);
-		if (ordinalL == 0) throw "invalid recurrence by-day ordinal";
+	if (weekdaynum.at(0) >= '0' && weekdaynum[0] <= '9') {
+		ordinal = static_cast<signed char>(Number(weekdaynum, 53, "invalid recurrence by-day ordinal"));
+		if (ordinal == 0) throw "invalid recurrence by-day ordinal";
 		
-		weekdaynum.remove_prefix(ordinalL);
 		if (negative) ordinal = -ordinal;
 		}
 
@@ -447,13 +534,13 @@ for (
 	
 	// parse weekday
 	static const Char *const weekdays[] = {
-		L"SU",
-		L"MO",
-		L"TU",
-		L"WE",
-		L"TH",
-		L"FR",
-		L"SA"
+		Literal<Char, "SU">,
+		Literal<Char, "MO">,
+		Literal<Char, "TU">,
+		Literal<Char, "WE">,
+		Literal<Char, "TH">,
+		Literal<Char, "FR">,
+		Literal<Char, "SA">
 		};
 	const Char *const *weekday;
 	for (weekday = weekdays; weekday != std::end(weekdays); ++weekday)
@@ -517,14 +604,13 @@ for (
 	) {
 	// find the end of this month
 	separatorI = months.find_first_of(',');
-	const unsigned nextL = separatorI != std::string_view::npos ? separatorI : months.length();
+	string_view month = months.substr(0, separatorI != std::string_view::npos ? separatorI : months.length());
 	
 	// parse month
-	unsigned monthL;
-	unsigned char month0 = static_cast<unsigned char>(stoul(string(string_view(months.data(), nextL)), &monthL)) - 1;
-	if (monthL != nextL) throw "invalid recurrence month";
+	const unsigned long month1 = Number(month, 12, "invalid recurrence month");
+	if (month1 == 0 || !month.empty()) throw "invalid recurrence month";
 	
-	ByMonth0(month0);
+	ByMonth0(static_cast<unsigned char>(month1 - 1));
 	}
 }
 
@@ -552,7 +638,7 @@ void Calendar<Char>::Parser::RecurrenceRule::ParseWkst(
 
 
 /*	ParseRecurrenceRule
-	Parse Recurrence Rule (3.8.5.3)
+	Parse Recurrence Rule (§3.8.5.3)
 */
 template <typename Char>
 void Calendar<Char>::Parser::RecurrenceRule::Parse(
@@ -565,20 +651,20 @@ const static struct {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"BYDAY", &RecurrenceRule::ParseByDay },
-	{ L"BYHOUR", &RecurrenceRule::ParseByHour },
-	{ L"BYMINUTE", &RecurrenceRule::ParseByMinute },
-	{ L"BYMONTH", &RecurrenceRule::ParseByMonth },
-	{ L"BYMONTHDAY", &RecurrenceRule::ParseByMonthDay },
-	{ L"BYSECOND", &RecurrenceRule::ParseBySecond },
-	{ L"BYSETPOS", &RecurrenceRule::ParseBySetPos },
-	{ L"BYWEEKNO", &RecurrenceRule::ParseByWeekNumber },
-	{ L"BYYEARDAY", &RecurrenceRule::ParseByYearDay },
-	{ L"COUNT", &RecurrenceRule::ParseCount },
-	{ L"FREQ", &RecurrenceRule::ParseFrequency },
-	{ L"INTERVAL", &RecurrenceRule::ParseInterval },
-	{ L"UNTIL", &RecurrenceRule::ParseUntil },
-	{ L"WKST", &RecurrenceRule::ParseWkst }
+	{ Literal<Char, "BYDAY">, &RecurrenceRule::ParseByDay },
+	{ Literal<Char, "BYHOUR">, &RecurrenceRule::ParseByHour },
+	{ Literal<Char, "BYMINUTE">, &RecurrenceRule::ParseByMinute },
+	{ Literal<Char, "BYMONTH">, &RecurrenceRule::ParseByMonth },
+	{ Literal<Char, "BYMONTHDAY">, &RecurrenceRule::ParseByMonthDay },
+	{ Literal<Char, "BYSECOND">, &RecurrenceRule::ParseBySecond },
+	{ Literal<Char, "BYSETPOS">, &RecurrenceRule::ParseBySetPos },
+	{ Literal<Char, "BYWEEKNO">, &RecurrenceRule::ParseByWeekNumber },
+	{ Literal<Char, "BYYEARDAY">, &RecurrenceRule::ParseByYearDay },
+	{ Literal<Char, "COUNT">, &RecurrenceRule::ParseCount },
+	{ Literal<Char, "FREQ">, &RecurrenceRule::ParseFrequency },
+	{ Literal<Char, "INTERVAL">, &RecurrenceRule::ParseInterval },
+	{ Literal<Char, "UNTIL">, &RecurrenceRule::ParseUntil },
+	{ Literal<Char, "WKST">, &RecurrenceRule::ParseWkst }
 	};
 
 // for all recurrence rule parts
@@ -627,7 +713,7 @@ const static struct Parser {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"GREGORIAN", Scale::kGregorian},
+	{ Literal<Char, "GREGORIAN">, Scale::kGregorian},
 	};
 
 // look for the key
@@ -652,9 +738,9 @@ const static struct Parser {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"CANCELLED", StatusEvent::kCancelled },
-	{ L"CONFIRMED", StatusEvent::kConfirmed},
-	{ L"TENTATIVE", StatusEvent::kTentative },
+	{ Literal<Char, "CANCELLED">, StatusEvent::kCancelled },
+	{ Literal<Char, "CONFIRMED">, StatusEvent::kConfirmed},
+	{ Literal<Char, "TENTATIVE">, StatusEvent::kTentative },
 	};
 
 // look for the key
@@ -680,10 +766,10 @@ const static struct Parser {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"CANCELLED", StatusToDo::kCancelled },
-	{ L"COMPLETED", StatusToDo::kCompleted },
-	{ L"IN-PROCESS", StatusToDo::kInProcess },
-	{ L"NEEDS-ACTION", StatusToDo::kNeedsAction }
+	{ Literal<Char, "CANCELLED">, StatusToDo::kCancelled },
+	{ Literal<Char, "COMPLETED">, StatusToDo::kCompleted },
+	{ Literal<Char, "IN-PROCESS">, StatusToDo::kInProcess },
+	{ Literal<Char, "NEEDS-ACTION">, StatusToDo::kNeedsAction }
 	};
 
 // look for the key
@@ -710,8 +796,8 @@ const static struct Parser {
 
 	operator	const string_view() const { return key; }
 	} parsers[] = {
-	{ L"OPAQUE", Transparency::kOpaque },
-	{ L"TRANSPARENT", Transparency::kTransparent },
+	{ Literal<Char, "OPAQUE">, Transparency::kOpaque },
+	{ Literal<Char, "TRANSPARENT">, Transparency::kTransparent },
 	};
 
 // look for the key
@@ -723,7 +809,7 @@ return parser->transparency;
 
 
 /*	ParseUTCOffset
-	Parse UTC Offset (3.3.14)
+	Parse UTC Offset (§3.3.14)
 */
 template <typename Char>
 typename Calendar<Char>::UTCOffset Calendar<Char>::Parser::ParseUTCOffset(
@@ -742,30 +828,20 @@ switch (offset[0]) {
 	}
 
 // parse hours and minutes
-if (offset.length() < 4) throw "invalid UTC Offset";
-result.fHour = static_cast<unsigned char>(stoul(string(string_view(offset.data(), 2))));
+if (offset.length() != 4 && offset.length() != 6) throw "invalid UTC Offset";
+result.fHour = static_cast<signed char>(Digits<2>(offset, 0, 23, "invalid UTC Offset hour"));
 if (negative) result.fHour = -result.fHour;
-offset.remove_prefix(2);
-result.fMinute = static_cast<unsigned char>(stoul(string(string_view(offset.data(), 2))));
-offset.remove_prefix(2);
-
-// parse optional seconds
-if (offset.length() >= 2) {
-	result.fSecond = static_cast<unsigned char>(stoul(string(string_view(offset.data(), 2))));
-	offset.remove_prefix(2);
-	}
-
-else
-	result.fSecond = 0;
+result.fMinute = static_cast<unsigned char>(Digits<2>(offset.substr(2), 0, 59, "invalid UTC Offset minute"));
 
-if (!offset.empty()) throw "invalid UTC Offset";
+// optional seconds
+result.fSecond = offset.length() == 6 ? static_cast<unsigned char>(Digits<2>(offset.substr(4), 0, 59, "invalid UTC Offset second")) : 0;
 
 return result;
 }
 
 
 /*	ParseValueType
-	Parse value type (3.2.20)
+	Parse value type (§3.2.20)
 */
 template <typename Char>
 typename Calendar<Char>::ValueType Calendar<Char>::Parser::ParseValueType(
@@ -778,19 +854,19 @@ static const struct Parser {
 
 	operator	const string_view() const { return name; }
 	} parsers[] = {
-	{ L"BINARY", ValueType::kBinary },
-	{ L"BOOLEAN", ValueType::kBoolean },
-	{ L"CAL-ADDRESS", ValueType::kCalendarAddress },
-	{ L"DATE", ValueType::kDate },
-	{ L"DATE-TIME", ValueType::kDateTime },
-	{ L"DURATION", ValueType::kDuration },
-	{ L"FLOAT", ValueType::kFloat },
-	{ L"INTEGER", ValueType::kInteger },
-	{ L"PERIOD", ValueType::kPeriod },
-	{ L"RECUR", ValueType::kRecurrence },
-	{ L"TEXT", ValueType::kText },
-	{ L"URI", ValueType::kURI },
-	{ L"UTC-OFFSET", ValueType::kUTCOffset }
+	{ Literal<Char, "BINARY">, ValueType::kBinary },
+	{ Literal<Char, "BOOLEAN">, ValueType::kBoolean },
+	{ Literal<Char, "CAL-ADDRESS">, ValueType::kCalendarAddress },
+	{ Literal<Char, "DATE">, ValueType::kDate },
+	{ Literal<Char, "DATE-TIME">, ValueType::kDateTime },
+	{ Literal<Char, "DURATION">, ValueType::kDuration },
+	{ Literal<Char, "FLOAT">, ValueType::kFloat },
+	{ Literal<Char, "INTEGER">, ValueType::kInteger },
+	{ Literal<Char, "PERIOD">, ValueType::kPeriod },
+	{ Literal<Char, "RECUR">, ValueType::kRecurrence },
+	{ Literal<Char, "TEXT">, ValueType::kText },
+	{ Literal<Char, "URI">, ValueType::kURI },
+	{ Literal<Char, "UTC-OFFSET">, ValueType::kUTCOffset }
 	};
 
 // look for the key
@@ -810,7 +886,22 @@ Calendar<Char>::Parser::Parser(
 	const Context	&context,
 	istream		&input
 	) :
-	fInput(input),
+	fInput(&input),
+	fContext(&context)
+{
+}
+
+
+/*	Calendar::Parser
+	Parse the iCalendar object in the given buffer, which must outlast the parser
+*/
+template <typename Char>
+Calendar<Char>::Parser::Parser(
+	const Context	&context,
+	const string_view buffer
+	) :
+	fInput(nullptr),
+	fBuffer(buffer),
 	fContext(&context)
 {
 }
@@ -912,15 +1003,9 @@ for (
 		value(parameter.substr(nameValuesSeparatorI + 1));
 
 	// find a parser based on the parameter name
-	if (
-		// find the lower bound of key
-		const Context::Line::Parameter *const parameter = std::lower_bound(line.fParameters, line.fParametersE, name);
-
-		// is it the key we're looking for?
-		parameter != line.fParametersE && *parameter == name
-		)
+	if (const unsigned char parameterI = line.fIndex(name); parameterI != kNoKey)
 		// invoke property parameter parser
-		(this->*parameter->Callback)(value);
+		(this->*line.fParameters[parameterI].Callback)(value);
 
 	// else invoke the default parser
 	else if (void (Parser::*ExtraParameter)(string_view, string_view, string_view) = component.FExtraParameter)
@@ -932,10 +1017,48 @@ for (
 }
 
 
+/*	NextLine
+	Get the next content line: from the stream, into 'unfolded'; or in place from the buffer, using
+	'unfolded' only to join a line to its continuation lines
+*/
+template <typename Char>
+bool Calendar<Char>::Parser::NextLine(
+	string		&unfolded,
+	string_view	&line
+	)
+{
+// the stream's adapter has already done the unfolding
+if (fInput) {
+	if (!std::getline(*fInput, unfolded)) return false;
+	
+	line = unfolded;
+	return true;
+	}
+
+if (fBuffer.empty()) return false;
+
+line = PhysicalLine(fBuffer);
+
+// folded?
+if (Continues(fBuffer)) {
+	unfolded.assign(line);
+	do {
+		// drop the leading white space
+		fBuffer.remove_prefix(1);
+		unfolded.append(PhysicalLine(fBuffer));
+		} while (Continues(fBuffer));
+	
+	line = unfolded;
+	}
+
+return true;
+}
+
+
 /*	Calendar::Parser::()
 	iCalendar is a line-oriented format; but with some twists:
 	*	lines are key [; optional parameters ]: value
-	*	content lines can have continuation lines (see our 'CalDAVIAdapter')
+	*	content lines can have continuation lines (see our 'CalDAVIAdapter' and NextLine)
 	
 	FHackNextLine allows a property parser to invoke a specific property parser (possibly the same one)
 	in case the next line can't be parsed as expected (see DynamicCalendar::XAppleStructuredLocation).
@@ -943,16 +1066,15 @@ for (
 template <typename Char>
 void Calendar<Char>::Parser::operator()()
 {
-// for each line in the input stream
-for (string line; std::getline(fInput, line); ) {
-	const string_view view = line;
-	
+// for each content line of the input
+string unfolded;
+for (string_view view; NextLine(unfolded, view); ) {
 	// reset 'hack' next line parser
 	void (Parser::*const hackNextLine)(string_view) = FHackNextLine;
 	FHackNextLine = nullptr;
 	
 	// find the name/value separator
-	const size_t colonI = view.find_first_of(L':');
+	const size_t colonI = view.find_first_of(':');
 		if (colonI == string_view::npos) {
 			// invoke 'hack' next line parser if we have one
 			if (hackNextLine) {
@@ -973,32 +1095,32 @@ for (string line; std::getline(fInput, line); ) {
 		key = view.substr(0, hasParam ? semicolonI : colonI),
 		parameters = view.substr(semicolonI + 1, hasParam ? colonI - (semicolonI + 1) : 0),
 		value = view.substr(colonI + 1);
-	if (
-		// find the lower bound of key
-		const Context::Line *const line = std::lower_bound(fContext->fLines, fContext->fLinesE, key);
-
-		// is it the key we're looking for?
-		line != fContext->fLinesE && *line == key
-		)
-		Property(*fContext, *line, parameters, value);
-	
-	else if (key == L"BEGIN")
-		Begin(parameters, value);
-	
-	else if (key == L"END")
-		{ if (End(parameters, value)) break; }
-	
-	// unrecognized line for 'hack' parser?
-	else if (hackNextLine)
-		(this->*hackNextLine)(view);
-	
-	// unspecified keys
-	else if (void (Parser::*ExtraLine)(string_view, string_view, string_view) = fContext->FExtraLine)
-		(this->*ExtraLine)(key, parameters, value);
+	switch (const unsigned char lineI = fContext->fIndex(key)) {
+		case kBeginKey:
+			Begin(parameters, value);
+			break;
+		
+		case kEndKey:
+			if (End(parameters, value)) return;
+			break;
+		
+		case kNoKey:
+			// unrecognized line for 'hack' parser?
+			if (hackNextLine)
+				(this->*hackNextLine)(view);
+			
+			// unspecified keys
+			else if (void (Parser::*ExtraLine)(string_view, string_view, string_view) = fContext->FExtraLine)
+				(this->*ExtraLine)(key, parameters, value);
+			break;
+		
+		default:
+			Property(*fContext, fContext->fLines[lineI], parameters, value);
+		}
 	}
 }
 
 
 // explicit instantiation
-//template struct Calendar<char>;
+template struct Calendar<char>;
 template struct Calendar<wchar_t>;
\ No newline at end of file
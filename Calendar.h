@@ -5,18 +5,53 @@
 	
 	2019/05/19	Originated
 	
-	Copyright  2019 by: Ben Hekster
+	Copyright © 2019 by: Ben Hekster
 
 	iCalendar handling; independent of transport or storage
 */
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
 #include <functional>
 #include <istream>
 #include <string_view>
 
 
+
+/*	ASCII
+	String literal that can be a template argument
+*/
+template <size_t N>
+struct ASCII {
+	char		fCharacters[N];
+	
+	consteval	ASCII(const char (&characters)[N]) { std::copy_n(characters, N, fCharacters); }
+	};
+
+
+/*	Literal
+	The given string literal in the given character type, converted at compile time
+	
+	The tables and writers are shared between the narrow (UTF-8) and wide instantiations, so
+	their keywords can't be spelled either "..." or L"...".  All of them are ASCII, which
+	converts by just widening each character.
+*/
+template <typename Char, ASCII literal>
+inline constexpr std::array<Char, sizeof literal.fCharacters> gLiteral = [] {
+	std::array<Char, sizeof literal.fCharacters> result {};
+	std::copy_n(literal.fCharacters, result.size(), result.begin());
+	return result;
+	}();
+
+template <typename Char, ASCII literal>
+inline constexpr const Char *Literal = gLiteral<Char, literal>.data();
+
+
 /*	Calendar
 	Represents the ability to parse a stream into an iCalendar object
 
@@ -42,7 +77,7 @@ struct Calendar {
 	
 	
 	/*	Date
-		Date (3.3.4)
+		Date (§3.3.4)
 	*/
 	struct Date {
 		unsigned short	fYear;
@@ -52,7 +87,7 @@ struct Calendar {
 	
 	
 	/*	Duration
-		Duration (3.3.6)
+		Duration (§3.3.6)
 	*/
 	struct Duration {
 		enum class Style : unsigned char {
@@ -82,7 +117,7 @@ struct Calendar {
 	
 	
 	/*	Time
-		Time (3.3.12)
+		Time (§3.3.12)
 	*/
 	struct Time {
 		enum class Zone : unsigned char {
@@ -98,7 +133,7 @@ struct Calendar {
 	
 	
 	/*	DateTime
-		Date-Time (3.3.5)
+		Date-Time (§3.3.5)
 	*/
 	struct DateTime {
 		static DateTime MakeForNowUTC();
@@ -109,7 +144,7 @@ struct Calendar {
 	
 	
 	/*	UTCOffset
-		UTC Offset (3.3.14)
+		UTC Offset (§3.3.14)
 	*/
 	struct UTCOffset {
 		signed char	fHour;
@@ -122,10 +157,15 @@ struct Calendar {
 	
 	/*	Parser
 		iCalendar stream parser
+		
+		Input comes either from a stream, which has already done any unfolding, or from a buffer
+		holding the whole of an iCalendar object; as from a mapped file or a response body.  The
+		lines of a buffer are handed to the callbacks in place, and only a folded line is copied
+		to be put back together.
 	*/
 	struct Parser {
 		/*	RecurrenceRule
-			Recurrence rule (3.3.10)
+			Recurrence rule (§3.3.10)
 		*/
 		class RecurrenceRule {
 		public:
@@ -163,6 +203,52 @@ struct Calendar {
 	protected:
 		typedef void (Parser::*Extra)(string_view name, string_view parameters, string_view value);
 		
+		static constexpr const Char
+				*gBegin = Literal<Char, "BEGIN">,
+				*gEnd = Literal<Char, "END">;
+		
+		// what an Index finds other than a position in its table
+		static constexpr unsigned char
+				kNoKey = 0xFF,
+				kBeginKey = 0xFE,
+				kEndKey = 0xFD;
+		
+		
+		/*	Index
+			Perfect hash of the keys of a table of lines or parameters, worked out at compile time
+			
+			Like StateParser::State::Index, the hash only looks at the length and three characters
+			of the key; so finding the entry takes one multiplication and one comparison however
+			many there are.  Falls back to a binary search if no perfect hash can be found.
+			
+			The tables are constexpr, so one that isn't sorted or has a key twice fails to compile.
+			A line index can also recognize BEGIN and END, so that those don't take comparisons
+			of their own.
+		*/
+		template <typename Entry, unsigned kSlotsBits>
+		struct Index {
+			const Entry	*fEntries,
+					*fEntriesE;
+			bool		fDelimiters;			// recognizes BEGIN and END
+			uint32_t	fMultiplier;			// zero if not hashed
+			unsigned char	fShift,
+					fSlots[1 << kSlotsBits];	// entry for each hash
+			
+			static constexpr uint32_t Key(string_view key) {
+				return key.empty() ? 0 :
+					static_cast<uint32_t>(key.size()) ^
+					static_cast<uint32_t>(key.front()) << 8 ^
+					static_cast<uint32_t>(key[key.size() / 2]) << 16 ^
+					static_cast<uint32_t>(key.back()) << 24;
+				}
+			
+			constexpr unsigned Slot(string_view key) const { return Key(key) * fMultiplier >> fShift; }
+			
+			constexpr	Index(const Entry *entries, const Entry *entriesE, bool delimiters);
+			
+			unsigned char	operator()(string_view key) const;	// position in table, kBeginKey, kEndKey or kNoKey
+			};
+		
 		
 		/*	Context
 			Define parseable VBEGIN/VEND context
@@ -180,7 +266,7 @@ struct Calendar {
 					
 					void		(Parser::*Callback)(string_view value);
 					
-					operator	const string_view() const { return name; }
+					constexpr	operator const string_view() const { return name; }
 					};
 				
 				
@@ -188,7 +274,9 @@ struct Calendar {
 				void		(Parser::*Callback)(string_view value);
 				const Parameter	*fParameters, *fParametersE;
 				
-				operator	const string_view() const { return key; }
+				Index<Parameter, 3> fIndex { fParameters, fParametersE, false };
+				
+				constexpr	operator const string_view() const { return key; }
 				};
 			
 			// BEGIN name
@@ -211,7 +299,9 @@ struct Calendar {
 			void		(Parser::*FExtraLine)(string_view name, string_view parameters, string_view value);
 			void		(Parser::*FExtraParameter)(string_view name, string_view parameterName, string_view parameterValue);
 			
-			operator	const string_view() const { return fName; }
+			Index<Line, 6>	fIndex { fLines, fLinesE, true };
+			
+			constexpr	operator const string_view() const { return fName; }
 			};
 	
 	public:
@@ -232,7 +322,8 @@ struct Calendar {
 		bool		EndAlarm();
 	
 	protected:
-		istream		&fInput;
+		istream		*const fInput;				// or null if parsing fBuffer
+		string_view	fBuffer;				// remainder to be parsed
 		const Context	*fContext;
 		
 		// work around iCloud bug: see operator()
@@ -241,13 +332,109 @@ struct Calendar {
 		
 		virtual void	ParseAlarm() = 0;
 		
+		bool		NextLine(string &unfolded, string_view &line);
 		bool		End(string_view, string_view);
 		void		Begin(string_view, string_view),
 				Property(const Context&, const typename Context::Line&, string_view, string_view);
 	
 	public:
 		explicit	Parser(const Context&, istream&);
+		explicit	Parser(const Context&, string_view);
 		
 		void		operator()();
 		};
 	};
+
+
+/*	Index
+	Check that the keys are sorted and distinct, and find a multiplier that hashes them into distinct slots
+*/
+template <typename Char>
+template <typename Entry, unsigned kSlotsBits>
+constexpr Calendar<Char>::Parser::Index<Entry, kSlotsBits>::Index(
+	const Entry	*const entries,
+	const Entry	*const entriesE,
+	const bool	delimiters
+	) :
+	fEntries(entries),
+	fEntriesE(entriesE),
+	fDelimiters(delimiters),
+	fMultiplier(0),
+	fShift(0),
+	fSlots {}
+{
+const unsigned entriesN = static_cast<unsigned>(entriesE - entries);
+if (entriesN >= kEndKey) throw "too many keys";
+
+// the table is searched by key
+for (unsigned i = 0; i < entriesN; i++) {
+	if (i > 0 && !(string_view(entries[i - 1]) < string_view(entries[i]))) throw "keys are not sorted and distinct";
+	if (delimiters && (string_view(entries[i]) == gBegin || string_view(entries[i]) == gEnd)) throw "BEGIN and END are not properties";
+	}
+
+// not worth hashing?  or too many to?
+const unsigned keysN = entriesN + (delimiters ? 2 : 0);
+if (keysN < 2 || 2 * keysN > (1u << kSlotsBits)) return;
+
+// start with a table twice as large as necessary, and make it larger if that doesn't work out
+unsigned bits = 1;
+while ((1u << bits) < 2 * keysN) bits++;
+
+for (; bits <= kSlotsBits; bits++)
+	for (uint32_t multiplier = 0x9E3779B1; multiplier != 0x9E3779B1 + 2 * 64; multiplier += 2) {
+		fMultiplier = multiplier;
+		fShift = static_cast<unsigned char>(32 - bits);
+		for (unsigned char &slot: fSlots) slot = kNoKey;
+		
+		const auto Place = [this](string_view key, unsigned char entry) {
+			unsigned char &slot = fSlots[Slot(key)];
+			if (slot != kNoKey) return false;
+			
+			slot = entry;
+			return true;
+			};
+		
+		bool perfect = !delimiters || (Place(gBegin, kBeginKey) && Place(gEnd, kEndKey));
+		for (unsigned i = 0; perfect && i < entriesN; i++)
+			perfect = Place(entries[i], static_cast<unsigned char>(i));
+		
+		if (perfect) return;
+		}
+
+// no luck
+fMultiplier = 0;
+}
+
+
+/*	Index::()
+	Return the position in the table of the entry with the given key
+*/
+template <typename Char>
+template <typename Entry, unsigned kSlotsBits>
+inline unsigned char Calendar<Char>::Parser::Index<Entry, kSlotsBits>::operator()(
+	const string_view key
+	) const
+{
+// hashed?
+if (fMultiplier)
+	switch (const unsigned char entry = fSlots[Slot(key)]) {
+		case kNoKey:	return kNoKey;
+		case kBeginKey:	return key == gBegin ? kBeginKey : kNoKey;
+		case kEndKey:	return key == gEnd ? kEndKey : kNoKey;
+		default:	return key == string_view(fEntries[entry]) ? entry : kNoKey;
+		}
+
+// find the lower bound of key
+if (
+	const Entry *const entry = std::lower_bound(fEntries, fEntriesE, key);
+	entry != fEntriesE && string_view(*entry) == key
+	)
+	return static_cast<unsigned char>(entry - fEntries);
+
+if (fDelimiters) {
+	if (key == gBegin) return kBeginKey;
+	if (key == gEnd) return kEndKey;
+	}
+
+return kNoKey;
+}
@@ -8,7 +8,7 @@
 	2018/09/09	Originated
 	2023/03/15	Factored from base class DAV
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 */
 
 #include <cctype>
@@ -23,7 +23,7 @@
 
 
 /*	TokenizeTrim
-	Apply the function f to each token in the given string, trimming whitespace off both ends
+	Apply the function ÔfÕ to each token in the given string, trimming whitespace off both ends
 */
 static void TokenizeTrim(
 	std::string_view line,
@@ -97,7 +97,7 @@ SupplyHeader(L"Content-Type", L"application/xml; charset=utf-8");
 
 
 /*	PropertyFind
-	Access WebDAV properties 9.1
+	Access WebDAV properties §9.1
 	'body' is the entire XML document including the declaration
 */
 void DAV::PropertyFind(
@@ -114,7 +114,7 @@ std::wostream(&osb) << body;
 osb.pubsync();
 		
 // make HTTP request
-// MUST supply Depth header [RFC 4918 9.1]
+// MUST supply Depth header [RFC 4918 §9.1]
 client.Request(
 	path,
 	L"PROPFIND",
@@ -123,7 +123,7 @@ client.Request(
 	DepthHeader(depth),
 	
 	// request body
-	CHTTPClient::Rekwest(osb.adapter().narrow().data(), osb.adapter().narrow().size()),
+	CHTTPClient::GatherRekwest(osb.adapter().narrow()),
 	
 	// response
 	Recipient
@@ -132,7 +132,7 @@ client.Request(
 
 
 /*	PropertyPatch
-	Modify WebDAV properties 9.2
+	Modify WebDAV properties §9.2
 	'body' is the entire XML document including the declaration
 */
 void DAV::PropertyPatch(
@@ -149,7 +149,7 @@ std::wostream(&osb) << body;
 osb.pubsync();
 		
 // make HTTP request
-// MUST supply Depth header [RFC 4918 9.1]
+// MUST supply Depth header [RFC 4918 §9.1]
 client.Request(
 	path,
 	L"PROPPATCH",
@@ -158,7 +158,7 @@ client.Request(
 	DepthHeader(depth),
 	
 	// request body
-	CHTTPClient::Rekwest(osb.adapter().narrow().data(), osb.adapter().narrow().size()),
+	CHTTPClient::GatherRekwest(osb.adapter().narrow()),
 	
 	// response
 	Recipient
@@ -231,7 +231,7 @@ client.Request(
 
 
 /*	MakeCollection
-	Modify WebDAV properties 9.2
+	Modify WebDAV properties §9.2
 	'body' is the entire XML document including the declaration
 */
 void DAV::MakeCollection(
@@ -262,7 +262,7 @@ client.Request(
 
 
 /*	Report
-	RFC 3253 3.6
+	RFC 3253 §3.6
 */
 void DAV::Report(
 	CHTTPClient	&client,
@@ -282,12 +282,12 @@ client.Request(
 	path,
 	L"REPORT",
 	
-	/* Note that the Depth header is optional and defaults to zero; but [RFC 3253 3.6] suggests
+	/* Note that the Depth header is optional and defaults to zero; but [RFC 3253 §3.6] suggests
 	   that without it the response might not predictably be 207 Multi-Status. */
 	DepthHeader(depth),
 	
 	// request body
-	CHTTPClient::Rekwest(osb.adapter().narrow().data(), osb.adapter().narrow().size()),
+	CHTTPClient::GatherRekwest(osb.adapter().narrow()),
 	
 	// response
 	Recipient
@@ -306,7 +306,7 @@ DAV::Allow::Allow(
 	const char	string[]
 	)
 {
-// tokenize Allow: header
+// tokenize Allow: header
 TokenizeTrim(
 	string,
 	',',
@@ -367,7 +367,7 @@ DAV::Capabilities::Capabilities(
 	const char	string[]
 	)
 {
-// tokenize DAV: header
+// tokenize DAV: header
 TokenizeTrim(
 	string,
 	',',
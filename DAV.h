@@ -8,7 +8,7 @@
 	2018/09/09	Originated
 	2023/03/15	Factored from base class DAV
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 	
 	RFC 4918	HTTP Extensions for Web Distributed Authoring and Versioning (WebDAV)
 	
@@ -34,7 +34,7 @@ namespace DAV {
 	
 	
 	/*	Allow
-		Parsed form of HTTP Allow: header
+		Parsed form of HTTP Allow: header
 	*/
 	struct Allow {
 		bool		fOptions {},
@@ -61,7 +61,7 @@ namespace DAV {
 	
 	
 	/*	Capabilities
-		Parsed form of HTTP DAV: header
+		Parsed form of HTTP DAV: header
 		*** clearly we see some CalDAV capabilities leaking in here
 	*/
 	struct Capabilities {
@@ -129,7 +129,7 @@ namespace DAV {
 	
 	void		Delete(CHTTPClient&, const wchar_t path[]);
 	
-	// PROPFIND 9.1
+	// PROPFIND §9.1
 	void		PropertyFind(
 				CHTTPClient&,
 				const wchar_t	path[],
@@ -138,7 +138,7 @@ namespace DAV {
 				const std::function<void (CHTTPClient::Response&)>&
 				);
 	
-	// PROPPATCH 9.2
+	// PROPPATCH §9.2
 	void		PropertyPatch(
 				CHTTPClient&,
 				const wchar_t	path[],
@@ -147,7 +147,7 @@ namespace DAV {
 				const std::function<void (CHTTPClient::Response&)>&
 				);
 	
-	// MKCOL 9.3
+	// MKCOL §9.3
 	void		MakeCollection(
 				CHTTPClient	&client,
 				const wchar_t	path[],
@@ -0,0 +1,168 @@
+/*
+	DiscoveryCache
+
+	What was learned bootstrapping a CalDAV session, kept between runs
+
+	2023/10/04	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include <fstream>
+
+#include "DiscoveryCache.h"
+#include "String.h"
+
+
+
+/*
+	The file is a signature line followed by each entry as a sequence of lines, all in UTF-8:
+	the hostname and username it was discovered for, its expiry in seconds since the epoch,
+	the service host, port and context path, the principal and home set URLs, the 'Allow'
+	and 'DAV' headers, and the number of supported reports followed by their names.
+
+	CalDAV discovery 1
+	example.com
+	user
+	1696464000
+	caldav.example.com
+	443
+	/dav/
+	/dav/principals/user/
+	https://p01-caldav.example.com/1234/calendars/
+	OPTIONS, GET, PROPFIND, REPORT
+	1, 3, calendar-access
+	2
+	calendar-multiget
+	sync-collection
+*/
+static constexpr char kSignature[] = "CalDAV discovery 1";
+
+
+
+/*	DiscoveryCache
+	Read the cache from the given file, if there is one
+*/
+DiscoveryCache::DiscoveryCache(
+	const wchar_t	path[]
+	) :
+	fPath(path)
+{
+std::ifstream ifs(fPath, std::ios::binary);
+
+std::string line;
+if (!std::getline(ifs, line) || line != kSignature) return;
+
+const auto Wide = [&ifs, &line]() {
+	if (!std::getline(ifs, line)) throw "discovery cache is truncated";
+	return Widen(line);
+	};
+const auto Number = [&ifs, &line]() {
+	if (!std::getline(ifs, line)) throw "discovery cache is truncated";
+	return std::stoll(line);
+	};
+
+try {
+	for (std::string hostname; std::getline(ifs, hostname); ) {
+		const std::wstring username = Wide();
+
+		Entry entry;
+		entry.fExpires = std::chrono::system_clock::time_point(std::chrono::seconds(Number()));
+		entry.fHost = Wide();
+		entry.fPort = static_cast<unsigned short>(Number());
+		entry.fContextPath = Wide();
+		entry.fPrincipalURL = Wide();
+		entry.fHomeSetURL = Wide();
+		if (!std::getline(ifs, entry.fAllow) || !std::getline(ifs, entry.fDAV)) throw "discovery cache is truncated";
+		for (long long n = Number(); n > 0; n--)
+			if (!std::getline(ifs, entry.fReports.emplace_back())) throw "discovery cache is truncated";
+
+		fEntries.insert_or_assign(Key(Widen(hostname), username), std::move(entry));
+		}
+	}
+
+// we'll just have to discover again
+catch (...) {
+	fEntries.clear();
+	}
+}
+
+
+/*	Save
+	Write the cache to its file
+*/
+void DiscoveryCache::Save() const
+{
+const std::filesystem::path temporary = std::filesystem::path(fPath) += L".new";
+
+std::filesystem::create_directories(fPath.parent_path());
+
+{
+std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+if (!ofs) throw "can't write discovery cache";
+
+ofs << kSignature << '\n';
+for (const auto &[key, entry]: fEntries) {
+	ofs <<
+		Narrow(key.first) << '\n' <<
+		Narrow(key.second) << '\n' <<
+		std::chrono::duration_cast<std::chrono::seconds>(entry.fExpires.time_since_epoch()).count() << '\n' <<
+		Narrow(entry.fHost) << '\n' <<
+		entry.fPort << '\n' <<
+		Narrow(entry.fContextPath) << '\n' <<
+		Narrow(entry.fPrincipalURL) << '\n' <<
+		Narrow(entry.fHomeSetURL) << '\n' <<
+		entry.fAllow << '\n' <<
+		entry.fDAV << '\n' <<
+		entry.fReports.size() << '\n';
+	for (const std::string &report: entry.fReports)
+		ofs << report << '\n';
+	}
+
+if (!ofs.flush()) throw "can't write discovery cache";
+}
+
+std::filesystem::rename(temporary, fPath);
+}
+
+
+/*	Find
+	Return the unexpired entry for the given hostname and username; or null if there is none
+*/
+const DiscoveryCache::Entry *DiscoveryCache::Find(
+	const wchar_t	hostname[],
+	const wchar_t	username[]
+	) const
+{
+const auto found = fEntries.find(Key(hostname, username));
+return found != fEntries.end() && std::chrono::system_clock::now() < found->second.fExpires ? &found->second : nullptr;
+}
+
+
+/*	Store
+	Remember what was discovered for the given hostname and username, as of now
+*/
+void DiscoveryCache::Store(
+	const wchar_t	hostname[],
+	const wchar_t	username[],
+	Entry		entry
+	)
+{
+entry.fExpires = std::chrono::system_clock::now() + kTTL;
+fEntries.insert_or_assign(Key(hostname, username), std::move(entry));
+
+Save();
+}
+
+
+/*	Forget
+	Drop the entry for the given hostname and username
+*/
+void DiscoveryCache::Forget(
+	const wchar_t	hostname[],
+	const wchar_t	username[]
+	)
+{
+if (fEntries.erase(Key(hostname, username)) > 0)
+	Save();
+}
@@ -0,0 +1,70 @@
+/*
+	DiscoveryCache
+
+	What was learned bootstrapping a CalDAV session, kept between runs
+
+	2023/10/04	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+/*	DiscoveryCache
+	Results of service location and principal and home set discovery, by hostname and username
+
+	Bootstrapping a session takes a DNS lookup and half a dozen requests before the first
+	useful one; none of which are likely to give a different answer from one run to the next.
+	An entry is good for kTTL after it was discovered.  It's up to the user to Forget an entry
+	that turns out to be wrong, as when the credentials are refused or the cached home set is
+	no longer found.
+
+	Like Mirror, the file is written beside the old one and then renamed over it.  A cache
+	that can't be read is treated as empty, since the worst that costs is a rediscovery.
+*/
+class DiscoveryCache {
+public:
+	struct Entry {
+		// service location
+		std::wstring	fHost;
+		unsigned short	fPort {};
+		std::wstring	fContextPath;
+
+		// as returned by the server; either may be a full URL on another server, or a path
+		std::wstring	fPrincipalURL,
+				fHomeSetURL;
+
+		// at the home set
+		std::string	fAllow,				// 'Allow' header
+				fDAV;				// 'DAV' header
+		std::vector<std::string> fReports;		// names of 'supported-report-set' reports
+
+		std::chrono::system_clock::time_point fExpires;
+		};
+
+	static constexpr std::chrono::hours kTTL { 24 };
+
+protected:
+	using Key = std::pair<std::wstring, std::wstring>;	// hostname, username
+
+	const std::filesystem::path fPath;
+	std::map<Key, Entry> fEntries;
+
+	void		Save() const;
+
+public:
+	explicit	DiscoveryCache(const wchar_t path[]);
+
+	const Entry	*Find(const wchar_t hostname[], const wchar_t username[]) const;
+	void		Store(const wchar_t hostname[], const wchar_t username[], Entry);
+	void		Forget(const wchar_t hostname[], const wchar_t username[]);
+	};
@@ -5,7 +5,7 @@
 	
 	2019/05/19	Originated
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
 #include <assert.h>
@@ -24,122 +24,122 @@
 
 */
 
-// list of property parameter parsers, sorted by key; [RFC 5545]
+// list of property parameter parsers, sorted by key (which their Index checks at compile time); [RFC 5545]
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line::Parameter
-	// [3.8.2.2]
+constexpr typename Calendar<Char>::Parser::Context::Line::Parameter
+	// [§3.8.2.2]
 	DynamicCalendar<Char>::Parser::gContextLineParametersDateTimeEnd[] = {
-		{ L"TZID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneIdentifier) },
-		{ L"VALUE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
+		{ Literal<Char, "TZID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneIdentifier) },
+		{ Literal<Char, "VALUE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line::Parameter
+constexpr typename Calendar<Char>::Parser::Context::Line::Parameter
 	DynamicCalendar<Char>::Parser::gContextLineParametersDateTimeStart[] = {
-		{ L"TZID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneIdentifier) },
-		{ L"VALUE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
+		{ Literal<Char, "TZID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneIdentifier) },
+		{ Literal<Char, "VALUE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line::Parameter
+constexpr typename Calendar<Char>::Parser::Context::Line::Parameter
 	DynamicCalendar<Char>::Parser::gContextLineParametersDue[] = {
-		{ L"TZID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneIdentifier) },
-		{ L"VALUE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
+		{ Literal<Char, "TZID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneIdentifier) },
+		{ Literal<Char, "VALUE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line::Parameter
+constexpr typename Calendar<Char>::Parser::Context::Line::Parameter
 	DynamicCalendar<Char>::Parser::gContextLineParametersTrigger[] = {
-		{ L"VALUE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
+		{ Literal<Char, "VALUE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Value) }
 		};
 
 
-// list of property parsers, sorted by key
+// list of property parsers, sorted by key (which their Index checks at compile time)
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line
+constexpr typename Calendar<Char>::Parser::Context::Line
 	DynamicCalendar<Char>::Parser::gContextLinesAlarm[] = {
-		{ L"ACKNOWLEDGED", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Acknowledged) },
-		{ L"ACTION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Action) },
-		{ L"DESCRIPTION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DescriptionAlarm) },
-		{ L"TRIGGER", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Trigger),
+		{ Literal<Char, "ACKNOWLEDGED">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Acknowledged) },
+		{ Literal<Char, "ACTION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Action) },
+		{ Literal<Char, "DESCRIPTION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DescriptionAlarm) },
+		{ Literal<Char, "TRIGGER">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Trigger),
 			std::begin(gContextLineParametersTrigger), std::end(gContextLineParametersTrigger) },
-		{ L"UID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::UIDAlarm) },
+		{ Literal<Char, "UID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::UIDAlarm) },
 		};
 	
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line
+constexpr typename Calendar<Char>::Parser::Context::Line
 	DynamicCalendar<Char>::Parser::gContextLinesCalendar[] = {
-		{ L"CALSCALE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Scale) },
-		{ L"PRODID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::ProductID) },
-		{ L"VERSION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Version) }
+		{ Literal<Char, "CALSCALE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Scale) },
+		{ Literal<Char, "PRODID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::ProductID) },
+		{ Literal<Char, "VERSION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Version) }
 		};
 	
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line
+constexpr typename Calendar<Char>::Parser::Context::Line
 	DynamicCalendar<Char>::Parser::gContextLinesToDo[] = {
 		// COMPLETED
-		{ L"CREATED", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Created) },
-		{ L"DESCRIPTION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Description) },
-		{ L"DTSTAMP", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStamp) },
-		{ L"DTSTART", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStart),
+		{ Literal<Char, "CREATED">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Created) },
+		{ Literal<Char, "DESCRIPTION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Description) },
+		{ Literal<Char, "DTSTAMP">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStamp) },
+		{ Literal<Char, "DTSTART">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStart),
 			std::begin(gContextLineParametersDateTimeStart), std::end(gContextLineParametersDateTimeStart) },
-		{ L"DUE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Due),
+		{ Literal<Char, "DUE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Due),
 			std::begin(gContextLineParametersDue), std::end(gContextLineParametersDue) },
-		{ L"LAST-MODIFIED", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::LastModified) },
-		{ L"LOCATION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Location) },
-		{ L"PRIORITY", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Priority) },
-		{ L"SEQUENCE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Sequence) },
-		{ L"STATUS", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::StatusToDo) },
-		{ L"SUMMARY", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Summary) },
-		{ L"UID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::UID) },
+		{ Literal<Char, "LAST-MODIFIED">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::LastModified) },
+		{ Literal<Char, "LOCATION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Location) },
+		{ Literal<Char, "PRIORITY">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Priority) },
+		{ Literal<Char, "SEQUENCE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Sequence) },
+		{ Literal<Char, "STATUS">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::StatusToDo) },
+		{ Literal<Char, "SUMMARY">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Summary) },
+		{ Literal<Char, "UID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::UID) },
 		};
 	
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line
+constexpr typename Calendar<Char>::Parser::Context::Line
 	DynamicCalendar<Char>::Parser::gContextLinesEvent[] = {
-		{ L"CLASS", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Classification) },
-		{ L"CREATED", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Created) },
-		{ L"DESCRIPTION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Description) },
-		{ L"DTEND", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeEnd),
+		{ Literal<Char, "CLASS">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Classification) },
+		{ Literal<Char, "CREATED">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Created) },
+		{ Literal<Char, "DESCRIPTION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Description) },
+		{ Literal<Char, "DTEND">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeEnd),
 			std::begin(gContextLineParametersDateTimeEnd), std::end(gContextLineParametersDateTimeEnd) },
-		{ L"DTSTAMP", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStamp) },
-		{ L"DTSTART", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStart),
+		{ Literal<Char, "DTSTAMP">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStamp) },
+		{ Literal<Char, "DTSTART">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::DateTimeStart),
 			std::begin(gContextLineParametersDateTimeStart), std::end(gContextLineParametersDateTimeStart) },
-		{ L"LAST-MODIFIED", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::LastModified) },
-		{ L"LOCATION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Location) },
-		{ L"RRULE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::RecurrenceRule) },
-		{ L"SEQUENCE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Sequence) },
-		{ L"STATUS", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::StatusEvent) },
-		{ L"SUMMARY", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Summary) },
-		{ L"TRANSP", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Transparency) },
-		{ L"UID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::UID) },
-		{ L"URL", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::URL) },
-		{ L"X-APPLE-STRUCTURED-LOCATION", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::XAppleStructuredLocation) }
+		{ Literal<Char, "LAST-MODIFIED">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::LastModified) },
+		{ Literal<Char, "LOCATION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Location) },
+		{ Literal<Char, "RRULE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::RecurrenceRule) },
+		{ Literal<Char, "SEQUENCE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Sequence) },
+		{ Literal<Char, "STATUS">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::StatusEvent) },
+		{ Literal<Char, "SUMMARY">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Summary) },
+		{ Literal<Char, "TRANSP">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::Transparency) },
+		{ Literal<Char, "UID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::UID) },
+		{ Literal<Char, "URL">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::URL) },
+		{ Literal<Char, "X-APPLE-STRUCTURED-LOCATION">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::XAppleStructuredLocation) }
 		};
 	
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line
+constexpr typename Calendar<Char>::Parser::Context::Line
 	DynamicCalendar<Char>::Parser::gContextLinesTimeZone[] = {
-		{ L"LAST-MODIFIED", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::LastModified) },
-		{ L"TZID", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneID) },
+		{ Literal<Char, "LAST-MODIFIED">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::LastModified) },
+		{ Literal<Char, "TZID">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneID) },
 		};
 	
 template <typename Char>
-const typename Calendar<Char>::Parser::Context::Line
+constexpr typename Calendar<Char>::Parser::Context::Line
 	DynamicCalendar<Char>::Parser::gContextLinesTimeZoneDivision[] = {
-		{ L"DTSTART", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneDivisionDateTimeStart) },
-		{ L"RDATE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneDivisionRecurrenceDate) },
-		{ L"RRULE", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneDivisionRecurrenceRule) },
-		{ L"TZNAME", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneName) },
-		{ L"TZOFFSETFROM", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneOffsetFrom) },
-		{ L"TZOFFSETTO", static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneOffsetTo) },
+		{ Literal<Char, "DTSTART">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneDivisionDateTimeStart) },
+		{ Literal<Char, "RDATE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneDivisionRecurrenceDate) },
+		{ Literal<Char, "RRULE">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneDivisionRecurrenceRule) },
+		{ Literal<Char, "TZNAME">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneName) },
+		{ Literal<Char, "TZOFFSETFROM">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneOffsetFrom) },
+		{ Literal<Char, "TZOFFSETTO">, static_cast<void (Calendar<Char>::Parser::*)(string_view)>(&DynamicCalendar::Parser::TimeZoneOffsetTo) },
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context
+constexpr typename Calendar<Char>::Parser::Context
 	DynamicCalendar<Char>::Parser::gContextCalendarEventInner[] = {
 		{
-			L"VALARM",
+			Literal<Char, "VALARM">,
 			&gContextCalendarInner[0],
 			nullptr, nullptr,
 			std::begin(gContextLinesAlarm), std::end(gContextLinesAlarm),
@@ -151,10 +151,10 @@ const typename Calendar<Char>::Parser::Context
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context
+constexpr typename Calendar<Char>::Parser::Context
 	DynamicCalendar<Char>::Parser::gContextCalendarToDoInner[] = {
 		{
-			L"VALARM",
+			Literal<Char, "VALARM">,
 			&gContextCalendarInner[2],
 			nullptr, nullptr,
 			std::begin(gContextLinesAlarm), std::end(gContextLinesAlarm),
@@ -166,10 +166,10 @@ const typename Calendar<Char>::Parser::Context
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context
+constexpr typename Calendar<Char>::Parser::Context
 	DynamicCalendar<Char>::Parser::gContextCalendarTimeZoneInner[] = {
 		{
-			L"DAYLIGHT",
+			Literal<Char, "DAYLIGHT">,
 			&gContextCalendarInner[1],
 			nullptr, nullptr,
 			std::begin(gContextLinesTimeZoneDivision), std::end(gContextLinesTimeZoneDivision),
@@ -178,7 +178,7 @@ const typename Calendar<Char>::Parser::Context
 			},
 
 		{
-			L"STANDARD",
+			Literal<Char, "STANDARD">,
 			&gContextCalendarInner[1],
 			nullptr, nullptr,
 			std::begin(gContextLinesTimeZoneDivision), std::end(gContextLinesTimeZoneDivision),
@@ -188,10 +188,10 @@ const typename Calendar<Char>::Parser::Context
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context
+constexpr typename Calendar<Char>::Parser::Context
 	DynamicCalendar<Char>::Parser::gContextCalendarInner[3] = {
 		{
-			L"VEVENT",
+			Literal<Char, "VEVENT">,
 			&gContextInner[0],
 			std::begin(gContextCalendarEventInner), std::end(gContextCalendarEventInner),
 			std::begin(gContextLinesEvent), std::end(gContextLinesEvent),
@@ -201,7 +201,7 @@ const typename Calendar<Char>::Parser::Context
 			},
 
 		{
-			L"VTIMEZONE",
+			Literal<Char, "VTIMEZONE">,
 			&gContextInner[0],
 			std::begin(gContextCalendarTimeZoneInner), std::end(gContextCalendarTimeZoneInner),
 			std::begin(gContextLinesTimeZone), std::end(gContextLinesTimeZone),
@@ -211,7 +211,7 @@ const typename Calendar<Char>::Parser::Context
 			},
 
 		{
-			L"VTODO",
+			Literal<Char, "VTODO">,
 			&gContextInner[0],
 			std::begin(gContextCalendarToDoInner), std::end(gContextCalendarToDoInner),
 			std::begin(gContextLinesToDo), std::end(gContextLinesToDo),
@@ -222,10 +222,10 @@ const typename Calendar<Char>::Parser::Context
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context
+constexpr typename Calendar<Char>::Parser::Context
 	DynamicCalendar<Char>::Parser::gContextInner[] = {
 		{
-			L"VCALENDAR",
+			Literal<Char, "VCALENDAR">,
 			&gContext,
 			std::begin(gContextCalendarInner), std::end(gContextCalendarInner),
 			std::begin(gContextLinesCalendar), std::end(gContextLinesCalendar),
@@ -235,9 +235,9 @@ const typename Calendar<Char>::Parser::Context
 		};
 
 template <typename Char>
-const typename Calendar<Char>::Parser::Context
+constexpr typename Calendar<Char>::Parser::Context
 	DynamicCalendar<Char>::Parser::gContext = {
-		L"",
+		Literal<Char, "">,
 		nullptr,
 		gContextInner, gContextInner + 1,
 		nullptr, nullptr
@@ -275,10 +275,30 @@ return result;
 template <typename Char>
 DynamicCalendar<Char>::Parser::Parser(
 	DynamicCalendar<Char> &into,
-	istream		&input
+	istream		&input,
+	InternTable<Char> &intern
 	) :
 	Calendar<Char>::Parser::Parser(gContext, input),
 	fInto(into),
+	fIntern(intern),
+	fComponent(nullptr),
+	fValue(ValueType::kNone)
+{
+}
+
+
+/*	Parser
+	Parse the iCalendar object in the given buffer
+*/
+template <typename Char>
+DynamicCalendar<Char>::Parser::Parser(
+	DynamicCalendar<Char> &into,
+	const string_view buffer,
+	InternTable<Char> &intern
+	) :
+	Calendar<Char>::Parser::Parser(gContext, buffer),
+	fInto(into),
+	fIntern(intern),
 	fComponent(nullptr),
 	fValue(ValueType::kNone)
 {
@@ -294,7 +314,7 @@ void DynamicCalendar<Char>::Parser::BeginTimeZoneStandard()
 // should not currently be parsing any time zone divisions
 assert(!fTimeZoneDivision);
 
-fTimeZoneDivision.emplace();
+fTimeZoneDivision.emplace(fInto.GetAllocator());
 fTimeZoneDivision->fKind = TimeZone::Division::kStandard;
 }
 
@@ -308,7 +328,7 @@ void DynamicCalendar<Char>::Parser::BeginTimeZoneDaylight()
 // should not currently be parsing any time zone divisions
 assert(!fTimeZoneDivision);
 
-fTimeZoneDivision.emplace();
+fTimeZoneDivision.emplace(fInto.GetAllocator());
 fTimeZoneDivision->fKind = TimeZone::Division::kDaylight;
 }
 
@@ -342,7 +362,7 @@ assert(fComponent);
 // should not currently be parsing an alarm
 if (fAlarm) throw "duplicate alarm";
 
-fAlarm.emplace();
+fAlarm.emplace(fInto.GetAllocator());
 
 Calendar<Char>::Parser::operator()();
 
@@ -364,7 +384,7 @@ void DynamicCalendar<Char>::Parser::BeginEvent()
 // should not currently be parsing any item
 if (!std::holds_alternative<std::monostate>(fOuter)) throw "unexpected start of event";
 
-fOuter = Event();
+fOuter.template emplace<Event>(fInto.GetAllocator());
 fComponent = std::get_if<Event>(&fOuter);
 }
 
@@ -394,7 +414,7 @@ void DynamicCalendar<Char>::Parser::BeginToDo()
 // should not currently be parsing any item
 if (!std::holds_alternative<std::monostate>(fOuter)) throw "unexpected to-do";
 
-fOuter = ToDo();
+fOuter.template emplace<ToDo>(fInto.GetAllocator());
 fComponent = std::get_if<ToDo>(&fOuter);
 }
 
@@ -425,7 +445,7 @@ void DynamicCalendar<Char>::Parser::BeginTimeZone()
 // should not currently be parsing any item
 if (!std::holds_alternative<std::monostate>(fOuter)) throw "unexpected timezone component";
 
-fOuter = TimeZone();
+fOuter.template emplace<TimeZone>(fInto.GetAllocator());
 }
 
 
@@ -460,7 +480,7 @@ void DynamicCalendar<Char>::Parser::TimeZoneIdentifier(
 	string_view	tzid
 	)
 {
-fTimeZoneIdentifier = tzid;
+fTimeZoneIdentifier = fIntern(tzid);
 }
 
 
@@ -615,7 +635,7 @@ fComponent->fStamp = Calendar<Char>::Parser::ParseDateTime(stamp);
 
 
 /*	Description
-	Description in top-level component (3.8.1.5)
+	Description in top-level component (§3.8.1.5)
 */
 template <typename Char>
 void DynamicCalendar<Char>::Parser::Description(
@@ -629,7 +649,7 @@ fComponent->fDescription = description;
 
 
 /*	DescriptionAlarm
-	Description in alarm component (3.8.1.5)
+	Description in alarm component (§3.8.1.5)
 */
 template <typename Char>
 void DynamicCalendar<Char>::Parser::DescriptionAlarm(
@@ -643,7 +663,7 @@ fAlarm->fDescription = description;
 
 
 /*	Due
-	Parse Date-Time Due (3.8.2.3)
+	Parse Date-Time Due (§3.8.2.3)
 */
 template <typename Char>
 void DynamicCalendar<Char>::Parser::Due(
@@ -685,7 +705,7 @@ void DynamicCalendar<Char>::Parser::RecurrenceRule(
 if (fComponent->fRecurrenceRule) throw "multiple recurrence rule";
 
 // construct 
-fComponent->fRecurrenceRule.emplace().Parse(recurrenceRule);
+fComponent->fRecurrenceRule.emplace(fInto.GetAllocator()).Parse(recurrenceRule);
 }
 
 
@@ -733,7 +753,7 @@ void DynamicCalendar<Char>::Parser::Priority(
 ToDo &todo = std::get<ToDo>(fOuter);
 
 if (todo.fPriority != 0) throw "multiple priority";
-todo.fPriority = static_cast<unsigned char>(stoul(string(string_view(priority.data(), priority.size()))));
+todo.fPriority = static_cast<unsigned char>(stoul(std::basic_string<Char>(priority)));
 }
 
 
@@ -747,7 +767,7 @@ void DynamicCalendar<Char>::Parser::ProductID(
 {
 if (!fInto.fProductID.empty()) throw "multiple Product ID";
 
-fInto.fProductID = productID;
+fInto.fProductID = fIntern(productID);
 }
 
 
@@ -777,7 +797,7 @@ void DynamicCalendar<Char>::Parser::Sequence(
 if (!fComponent) throw "unexpected sequence";
 
 if (fComponent->fSequence != 0) throw "multiple sequence";
-fComponent->fSequence = stoul(string(string_view(sequence.data(), sequence.size())));
+fComponent->fSequence = stoul(std::basic_string<Char>(sequence));
 }
 
 
@@ -830,7 +850,7 @@ fComponent->fSummary = summary;
 
 
 /*	TimeZoneID
-	3.6.5
+	§3.6.5
 */
 template <typename Char>
 void DynamicCalendar<Char>::Parser::TimeZoneID(
@@ -840,7 +860,7 @@ void DynamicCalendar<Char>::Parser::TimeZoneID(
 TimeZone &timeZone = std::get<TimeZone>(fOuter);
 if (!timeZone.fID.empty()) throw "multiple time zone ID";
 
-timeZone.fID = timeZoneID;
+timeZone.fID = fIntern(timeZoneID);
 }
 
 
@@ -860,7 +880,7 @@ fTimeZoneDivision->fName = timeZoneName;
 
 /*	TimeZoneOffsetFrom
 	TimeZoneOffsetTo
-	Parse Time Zone Offset From (3.8.3.3)
+	Parse Time Zone Offset From (§3.8.3.3)
 */
 template <typename Char>
 void DynamicCalendar<Char>::Parser::TimeZoneOffsetFrom(
@@ -926,7 +946,7 @@ void DynamicCalendar<Char>::Parser::TimeZoneDivisionRecurrenceRule(
 {
 if (fTimeZoneDivision->fRecurrenceRule) throw "multiple recurrence rule";
 
-fTimeZoneDivision->fRecurrenceRule.emplace().Parse(recurrenceRule);
+fTimeZoneDivision->fRecurrenceRule.emplace(fInto.GetAllocator()).Parse(recurrenceRule);
 }
 
 
@@ -947,7 +967,7 @@ event.fTransparency = Calendar<Char>::Parser::ParseTransparency(transparency);
 
 
 /*	Trigger
-	Parse Alarm component trigger (3.8.6.3)
+	Parse Alarm component trigger (§3.8.6.3)
 */
 template <typename Char>
 void DynamicCalendar<Char>::Parser::Trigger(
@@ -1031,7 +1051,7 @@ void DynamicCalendar<Char>::Parser::Version(
 	string_view	version
 	)
 {
-if (version != L"2.0") throw "unexpected version";
+if (version != Literal<Char, "2.0">) throw "unexpected version";
 }
 
 
@@ -1069,7 +1089,7 @@ this->FHackNextLine = static_cast<void (Calendar<Char>::Parser::*)(string_view)>
 
 // try to record as new property
 if (
-	auto [ propertyP, inserted ] = fComponent->fExtra.try_emplace(L"X-APPLE-STRUCTURED-LOCATION", location);
+	auto [ propertyP, inserted ] = fComponent->fExtra.try_emplace(fIntern(Literal<Char, "X-APPLE-STRUCTURED-LOCATION">), location);
 	
 	// did not insert a new property (because it already existed)?
 	!inserted
@@ -1079,7 +1099,7 @@ if (
 	// extend existing property value ***** this loses the distinction of the parameters
 	/* ***	This 'fixes' the broken property by creating an escaped newline.  It would probably actually
 		be better if we allowed actual newlines in properties and escaped/unescaped in the emitter/parser. */
-	property.append(L"\\n");
+	property.append(Literal<Char, "\\n">);
 	property.append(location);
 	}
 }
@@ -1098,7 +1118,7 @@ void DynamicCalendar<Char>::Parser::Other(
 // ***** loses the parameters
 fInto.fExtra.emplace(
 	std::piecewise_construct,
-	std::forward_as_tuple(key),
+	std::forward_as_tuple(fIntern(key)),
 	std::forward_as_tuple(value)
 	);
 }
@@ -1114,9 +1134,10 @@ void DynamicCalendar<Char>::Parser::OtherAlarmLine(
 	string_view	value
 	)
 {
-fAlarm->fLines.try_emplace(
-	string(key),
-	std::pair<string, string>(parameters, value)
+fAlarm->fLines.emplace(
+	std::piecewise_construct,
+	std::forward_as_tuple(fIntern(key)),
+	std::forward_as_tuple(parameters, value)
 	);
 }
 
@@ -1132,13 +1153,18 @@ void DynamicCalendar<Char>::Parser::OtherAlarmParameter(
 	)
 {
 // find or construct the map of extra property parameters for this key
-std::map<string, string> &parameters =
-	fAlarm->fParameters.try_emplace(
-		string(key),
-		std::map<string, string>()
+std::pmr::map<interned, string> &parameters =
+	fAlarm->fParameters.emplace(
+		std::piecewise_construct,
+		std::forward_as_tuple(fIntern(key)),
+		std::forward_as_tuple()
 		).first->second;
 
-parameters.try_emplace(string(parameterName), string(parameterValue));
+parameters.emplace(
+	std::piecewise_construct,
+	std::forward_as_tuple(fIntern(parameterName)),
+	std::forward_as_tuple(parameterValue)
+	);
 }
 
 
@@ -1155,7 +1181,7 @@ void DynamicCalendar<Char>::Parser::OtherComponent(
 // ***** this loses the parameters
 fComponent->fExtra.emplace(
 	std::piecewise_construct,
-	std::forward_as_tuple(key),
+	std::forward_as_tuple(fIntern(key)),
 	std::forward_as_tuple(value)
 	);
 }
@@ -1173,7 +1199,7 @@ void DynamicCalendar<Char>::Parser::OtherTimeZone(
 {
 std::get<TimeZone>(fOuter).fExtra.emplace(
 	std::piecewise_construct,
-	std::forward_as_tuple(key),
+	std::forward_as_tuple(fIntern(key)),
 	std::forward_as_tuple(value)
 	);
 }
@@ -1261,7 +1287,7 @@ static std::basic_ostream<Char> &operator<<(
 
 
 /*	DynamicCalendar::Action::<<
-	Alarm action (3.8.6.1)
+	Alarm action (§3.8.6.1)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1272,9 +1298,9 @@ static std::basic_ostream<Char> &operator<<(
 
 	switch (action) {
 		case Action::kNone:		break;
-		case Action::kAudio:		output << L"AUDIO"; break;
-		case Action::kDisplay:		output << L"DISPLAY"; break;
-		case Action::kEMail:		output << L"EMAIL"; break;
+		case Action::kAudio:		output << Literal<Char, "AUDIO">; break;
+		case Action::kDisplay:		output << Literal<Char, "DISPLAY">; break;
+		case Action::kEMail:		output << Literal<Char, "EMAIL">; break;
 		case Action::kOther:		throw "other calendar scale";
 		}
 
@@ -1283,7 +1309,7 @@ static std::basic_ostream<Char> &operator<<(
 
 
 /*	DynamicCalendar::Scale::<<
-	Calendar scale (3.7.1)
+	Calendar scale (§3.7.1)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1294,7 +1320,7 @@ static std::basic_ostream<Char> &operator<<(
 
 	switch (scale) {
 		case Scale::kNone:		break;
-		case Scale::kGregorian:		output << L"GREGORIAN"; break;
+		case Scale::kGregorian:		output << Literal<Char, "GREGORIAN">; break;
 		case Scale::kOther:		throw "other calendar scale";
 		}
 
@@ -1303,7 +1329,7 @@ static std::basic_ostream<Char> &operator<<(
 
 
 /*	DynamicCalendar::Classification::<<
-	Classification (3.8.1.3)
+	Classification (§3.8.1.3)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1314,9 +1340,9 @@ static std::basic_ostream<Char> &operator<<(
 
 	switch (classification) {
 		case Classification::kNone:		break;
-		case Classification::kPublic:		output << L"PUBLIC"; break;
-		case Classification::kPrivate:		output << L"PRIVATE"; break;
-		case Classification::kConfidential:	output << L"CONFIDENTIAL"; break;
+		case Classification::kPublic:		output << Literal<Char, "PUBLIC">; break;
+		case Classification::kPrivate:		output << Literal<Char, "PRIVATE">; break;
+		case Classification::kConfidential:	output << Literal<Char, "CONFIDENTIAL">; break;
 		case Classification::kOther:		throw "other classification";
 		}
 
@@ -1332,7 +1358,7 @@ static std::basic_ostream<Char> &operator<<(
 	std::basic_ostream<Char> &output,
 	const typename DynamicCalendar<Char>::Date &date
 	) {
-	output << std::setfill(L'0') <<
+	output << std::setfill<Char>('0') <<
 		std::setw(2) << static_cast<unsigned>(date.fYear) <<
 		std::setw(2) << 1 + static_cast<unsigned>(date.fMonth0) <<
 		std::setw(2) << 1 + static_cast<unsigned>(date.fDay0);
@@ -1362,7 +1388,7 @@ static std::basic_ostream<Char> &operator<<(
 	std::basic_ostream<Char> &output,
 	const typename DynamicCalendar<Char>::Time &time
 	) {
-	output << std::setfill(L'0') <<
+	output << std::setfill<Char>('0') <<
 		std::setw(2) << static_cast<unsigned>(time.fHour) <<
 		std::setw(2) << static_cast<unsigned>(time.fMinute) <<
 		std::setw(2) << static_cast<unsigned>(time.fSecond) <<
@@ -1377,7 +1403,7 @@ static std::basic_ostream<Char> &operator<<(
 	std::basic_ostream<Char> &output,
 	const typename DynamicCalendar<Char>::DateTime &dtz
 	) {
-	output << dtz.fDate << L'T' << dtz.fTime;
+	output << dtz.fDate << 'T' << dtz.fTime;
 	
 	return output;
 	}
@@ -1391,9 +1417,9 @@ static std::basic_ostream<Char> &operator<<(
 	using Style = typename DynamicCalendar<Char>::Duration::Style;
 	using Unit = typename DynamicCalendar<Char>::Duration::Unit;
 	
-	if (duration.fNegative) output << L'-';
+	if (duration.fNegative) output << '-';
 	
-	output << L'P';
+	output << 'P';
 	
 	// week style?
 	if (duration.fStyle == Style::kWeek)
@@ -1403,7 +1429,7 @@ static std::basic_ostream<Char> &operator<<(
 	else {
 		// date?
 		if (duration.fStyle == Style::kDate || duration.fStyle == Style::kDateTime)
-			output << duration.fDay << L'D';
+			output << duration.fDay << 'D';
 		
 		// time?
 		if (duration.fStyle == Style::kDateTime || duration.fStyle == Style::kTime) {
@@ -1411,15 +1437,15 @@ static std::basic_ostream<Char> &operator<<(
 			
 			// hours?
 			if (duration.fFrom <= Unit::kHour && duration.fTo > Unit::kHour)
-				output << duration.fHours << L'H';
+				output << duration.fHours << 'H';
 			
 			// minutes?
 			if (duration.fFrom <= Unit::kMinute && duration.fTo > Unit::kMinute)
-				output << duration.fMinutes << L'M';
+				output << duration.fMinutes << 'M';
 			
 			// seconds?
 			if (duration.fFrom <= Unit::kSecond && duration.fTo > Unit::kSecond)
-				output << duration.fSeconds << L'S';
+				output << duration.fSeconds << 'S';
 			}
 		}
 	
@@ -1433,13 +1459,13 @@ static std::basic_ostream<Char> &operator<<(
 	const typename DynamicCalendar<Char>::RecurrenceRule::Unit frequency
 	) {
 	static const Char *const frequencies[] = {
-		L"SECONDLY",
-		L"MINUTELY",
-		L"HOURLY",
-		L"DAILY",
-		L"WEEKLY",
-		L"MONTHLY",
-		L"YEARLY"
+		Literal<Char, "SECONDLY">,
+		Literal<Char, "MINUTELY">,
+		Literal<Char, "HOURLY">,
+		Literal<Char, "DAILY">,
+		Literal<Char, "WEEKLY">,
+		Literal<Char, "MONTHLY">,
+		Literal<Char, "YEARLY">
 		};
 	
 	// emit corresponding string
@@ -1485,13 +1511,13 @@ static std::basic_ostream<Char> &operator<<(
 			// ordinal
 			if (byDay.first) output << static_cast<signed>(byDay.first);
 			const Char *weekdays[] = {
-				L"SU",
-				L"MO",
-				L"TU",
-				L"WE",
-				L"TH",
-				L"FR",
-				L"SA"
+				Literal<Char, "SU">,
+				Literal<Char, "MO">,
+				Literal<Char, "TU">,
+				Literal<Char, "WE">,
+				Literal<Char, "TH">,
+				Literal<Char, "FR">,
+				Literal<Char, "SA">
 				};
 			output << weekdays[static_cast<unsigned char>(byDay.second) - 1];
 			}
@@ -1508,13 +1534,13 @@ static std::basic_ostream<Char> &operator<<(
 	) {
 	// output hour
 	if (offset.fHour < 0)
-		output << '-'<< std::setfill(L'0') << std::setw(2) << static_cast<unsigned>(-offset.fHour);
+		output << '-'<< std::setfill<Char>('0') << std::setw(2) << static_cast<unsigned>(-offset.fHour);
 	
 	else
-		output << std::setfill(L'0') << std::setw(2) << static_cast<unsigned>(offset.fHour);
+		output << std::setfill<Char>('0') << std::setw(2) << static_cast<unsigned>(offset.fHour);
 	
 	// output minute
-	output << std::setfill(L'0') << std::setw(2) << static_cast<unsigned>(offset.fMinute);
+	output << std::setfill<Char>('0') << std::setw(2) << static_cast<unsigned>(offset.fMinute);
 	
 	// optionally output second
 	if (offset.fSecond)
@@ -1525,7 +1551,7 @@ static std::basic_ostream<Char> &operator<<(
 
 
 /*	DynamicCalendar::StatusEvent::<<
-	Emit event status (3.8.1.11)
+	Emit event status (§3.8.1.11)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1536,9 +1562,9 @@ static std::basic_ostream<Char> &operator<<(
 	
 	switch (status) {
 		case Status::kNone:		break;
-		case Status::kTentative:	output << L"TENTATIVE"; break;
-		case Status::kConfirmed:	output << L"CONFIRMED"; break;
-		case Status::kCancelled:	output << L"CANCELLED"; break;
+		case Status::kTentative:	output << Literal<Char, "TENTATIVE">; break;
+		case Status::kConfirmed:	output << Literal<Char, "CONFIRMED">; break;
+		case Status::kCancelled:	output << Literal<Char, "CANCELLED">; break;
 		}
 	
 	return output;
@@ -1546,7 +1572,7 @@ static std::basic_ostream<Char> &operator<<(
 
 
 /*	DynamicCalendar::StatusToDo::<<
-	Emit To-Do status (3.8.1.11)
+	Emit To-Do status (§3.8.1.11)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1557,10 +1583,10 @@ static std::basic_ostream<Char> &operator<<(
 	
 	switch (status) {
 		case Status::kNone:		break;
-		case Status::kNeedsAction:	output << L"NEEDS-ACTION"; break;
-		case Status::kCompleted:	output << L"COMPLETED"; break;
-		case Status::kInProcess:	output << L"IN-PROCESS"; break;
-		case Status::kCancelled:	output << L"CANCELLED"; break;
+		case Status::kNeedsAction:	output << Literal<Char, "NEEDS-ACTION">; break;
+		case Status::kCompleted:	output << Literal<Char, "COMPLETED">; break;
+		case Status::kInProcess:	output << Literal<Char, "IN-PROCESS">; break;
+		case Status::kCancelled:	output << Literal<Char, "CANCELLED">; break;
 		}
 	
 	return output;
@@ -1568,7 +1594,7 @@ static std::basic_ostream<Char> &operator<<(
 
 
 /*	DynamicCalendar::Transparency::<<
-	Emit time transparency (3.8.2.7)
+	Emit time transparency (§3.8.2.7)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1579,8 +1605,8 @@ static std::basic_ostream<Char> &operator<<(
 	
 	switch (transparency) {
 		case Transparency::kNone:		break;
-		case Transparency::kOpaque:		output << L"OPAQUE"; break;
-		case Transparency::kTransparent:	output << L"TRANSPARENT"; break;
+		case Transparency::kOpaque:		output << Literal<Char, "OPAQUE">; break;
+		case Transparency::kTransparent:	output << Literal<Char, "TRANSPARENT">; break;
 		}
 	
 	return output;
@@ -1603,7 +1629,7 @@ static std::basic_ostream<Char> &operator<<(
 		const Char *value;
 		switch (trigger.index()) {
 			case 1:		value = nullptr /* duration */; break;
-			case 2:		value = L"DATE-TIME"; break;
+			case 2:		value = Literal<Char, "DATE-TIME">; break;
 			default:	abort();
 			}
 		
@@ -1611,18 +1637,18 @@ static std::basic_ostream<Char> &operator<<(
 		};
 	
 	// *** may be required depending on action type
-	if (alarm.fAction != DynamicCalendar<Char>::Action::kNone) output << L"ACTION:" << alarm.fAction << '\n';
+	if (alarm.fAction != DynamicCalendar<Char>::Action::kNone) output << Literal<Char, "ACTION:"> << alarm.fAction << '\n';
 	if (!std::holds_alternative<std::monostate>(alarm.fTrigger)) {
-		output << L"TRIGGER";
+		output << Literal<Char, "TRIGGER">;
 		OutputTrigger(alarm.fTrigger);
 		output << ':';
 		std::visit([&](const auto &value) { output << value; }, alarm.fTrigger);
 		output << '\n';
 		}
-	if (!alarm.fDescription.empty()) output << L"DESCRIPTION:" << alarm.fDescription << '\n';
+	if (!alarm.fDescription.empty()) output << Literal<Char, "DESCRIPTION:"> << alarm.fDescription << '\n';
 	
-	if (alarm.fAcknowledged) output << L"ACKNOWLEDGED:" << *alarm.fAcknowledged << '\n';
-	if (!alarm.fUID.empty()) output << L"UID:" << alarm.fUID << '\n';
+	if (alarm.fAcknowledged) output << Literal<Char, "ACKNOWLEDGED:"> << *alarm.fAcknowledged << '\n';
+	if (!alarm.fUID.empty()) output << Literal<Char, "UID:"> << alarm.fUID << '\n';
 	
 	// extra lines
 	for (const auto &line: alarm.fLines) {
@@ -1636,14 +1662,14 @@ static std::basic_ostream<Char> &operator<<(
 		output << ':' << line.second.second << '\n';
 		}
 	
-	output << L"END:VALARM\n";
+	output << Literal<Char, "END:VALARM\n">;
 	
 	return output;
 	}
 
 
 /*	DynamicCalendar::Event::<<
-	Emit Event component (3.6.1)
+	Emit Event component (§3.6.1)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1717,7 +1743,7 @@ return output;
 
 
 /*	DynamicCalendar::ToDo::<<
-	Emit To-Do component (3.6.2)
+	Emit To-Do component (§3.6.2)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1725,48 +1751,48 @@ static std::basic_ostream<Char> &operator<<(
 	const typename DynamicCalendar<Char>::ToDo &todo
 	)
 {
-output << L"BEGIN:VTODO\n";
+output << Literal<Char, "BEGIN:VTODO\n">;
 
 // required properties
-if (todo.fStamp) output << L"DTSTAMP:" << *todo.fStamp << '\n'; // not always present in practice
-output << L"UID:" << todo.fUID << '\n';
+if (todo.fStamp) output << Literal<Char, "DTSTAMP:"> << *todo.fStamp << '\n'; // not always present in practice
+output << Literal<Char, "UID:"> << todo.fUID << '\n';
 
 // optional properties
-if (todo.fClassification != DynamicCalendar<Char>::Classification::kNone) output << L"CLASS:" << todo.fClassification << '\n';
+if (todo.fClassification != DynamicCalendar<Char>::Classification::kNone) output << Literal<Char, "CLASS:"> << todo.fClassification << '\n';
 // COMPLETED
-if (todo.fCreated) output << L"CREATED:" << *todo.fCreated << '\n';
-if (!todo.fDescription.empty()) output << L"DESCRIPTION:" << todo.fDescription << '\n';
+if (todo.fCreated) output << Literal<Char, "CREATED:"> << *todo.fCreated << '\n';
+if (!todo.fDescription.empty()) output << Literal<Char, "DESCRIPTION:"> << todo.fDescription << '\n';
 if (!std::holds_alternative<std::monostate>(todo.fStart)) {
-	output << L"DTSTART";
-	if (!todo.fStartTimeZoneID.empty()) output << L";TZID=" << todo.fStartTimeZoneID;
+	output << Literal<Char, "DTSTART">;
+	if (!todo.fStartTimeZoneID.empty()) output << Literal<Char, ";TZID="> << todo.fStartTimeZoneID;
 	output << ':';
 	std::visit([&output](const auto &start) { output << start; }, todo.fStart);
 	output << '\n';
 	}
 // GEO
-if (todo.fLastModified) output << L"LAST-MODIFIED:" << *todo.fLastModified << '\n';
-if (!todo.fLocation.empty()) output << L"LOCATION:" << todo.fLocation << '\n';
+if (todo.fLastModified) output << Literal<Char, "LAST-MODIFIED:"> << *todo.fLastModified << '\n';
+if (!todo.fLocation.empty()) output << Literal<Char, "LOCATION:"> << todo.fLocation << '\n';
 // ORGANIZER
 // PERCENT
-if (todo.fPriority != 0) output << L"PRIORITY:" << static_cast<unsigned>(todo.fPriority) << '\n'; // not specifying is equivalent to zero
+if (todo.fPriority != 0) output << Literal<Char, "PRIORITY:"> << static_cast<unsigned>(todo.fPriority) << '\n'; // not specifying is equivalent to zero
 // RECURRENCE-ID
-if (todo.fSequence != 0) output << L"SEQUENCE:" << todo.fSequence << '\n'; // default is zero, so is okay not to emit it in that case
-if (todo.fStatus != DynamicCalendar<Char>::StatusToDo::kNone) output << L"STATUS:" << todo.fStatus << '\n';
-if (!todo.fSummary.empty()) output << L"SUMMARY:" << todo.fSummary << '\n';
+if (todo.fSequence != 0) output << Literal<Char, "SEQUENCE:"> << todo.fSequence << '\n'; // default is zero, so is okay not to emit it in that case
+if (todo.fStatus != DynamicCalendar<Char>::StatusToDo::kNone) output << Literal<Char, "STATUS:"> << todo.fStatus << '\n';
+if (!todo.fSummary.empty()) output << Literal<Char, "SUMMARY:"> << todo.fSummary << '\n';
 
 // optional properties
 // RRULE
 
-// optional but exclusive 3.8.2.3
+// optional but exclusive §3.8.2.3
 if (!std::holds_alternative<std::monostate>(todo.fDue)) {
-	output << L"DUE";
+	output << Literal<Char, "DUE">;
 	
 	// value data type property parameter
-	if (std::holds_alternative<DynamicCalendar<wchar_t>::Date>(todo.fDue))
+	if (std::holds_alternative<typename DynamicCalendar<Char>::Date>(todo.fDue))
 		output << ";VALUE=DATE";
 	
 	// time zone identifier property parameter
-	if (!todo.fDueTimeZoneID.empty()) output << L";TZID=" << todo.fDueTimeZoneID;
+	if (!todo.fDueTimeZoneID.empty()) output << Literal<Char, ";TZID="> << todo.fDueTimeZoneID;
 	
 	output << ':';
 	
@@ -1796,14 +1822,14 @@ for (const auto &extra: todo.fExtra)
 for (const typename DynamicCalendar<Char>::Alarm &alarm: todo.fAlarms)
 	output << alarm;
 
-output << L"END:VTODO\n";
+output << Literal<Char, "END:VTODO\n">;
 
 return output;
 }
 
 
 /*	DynamicCalendar::TimeZone::Division::<<
-	Time zone division (3.6.5)
+	Time zone division (§3.6.5)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1813,29 +1839,29 @@ static std::basic_ostream<Char> &operator<<(
 {
 const Char *const kind =
 	division.fKind == DynamicCalendar<Char>::TimeZone::Division::kStandard ?
-		L"STANDARD" :
-		L"DAYLIGHT";
+		Literal<Char, "STANDARD"> :
+		Literal<Char, "DAYLIGHT">;
 
-output << L"BEGIN:" << kind << '\n';
+output << Literal<Char, "BEGIN:"> << kind << '\n';
 
 if (!std::holds_alternative<std::monostate>(division.fStart))
-	std::visit([&output](const auto &start) { output << L"DTSTART:" << start << '\n'; }, division.fStart);
-if (division.fOffsetFrom && *division.fOffsetFrom) output << L"TZOFFSETFROM:" << *division.fOffsetFrom << '\n';
-if (division.fOffsetTo && *division.fOffsetTo) output << L"TZOFFSETTO:" << *division.fOffsetTo << '\n';
-if (division.fRecurrenceRule) output << L"RRULE:" << *division.fRecurrenceRule << '\n';
+	std::visit([&output](const auto &start) { output << Literal<Char, "DTSTART:"> << start << '\n'; }, division.fStart);
+if (division.fOffsetFrom && *division.fOffsetFrom) output << Literal<Char, "TZOFFSETFROM:"> << *division.fOffsetFrom << '\n';
+if (division.fOffsetTo && *division.fOffsetTo) output << Literal<Char, "TZOFFSETTO:"> << *division.fOffsetTo << '\n';
+if (division.fRecurrenceRule) output << Literal<Char, "RRULE:"> << *division.fRecurrenceRule << '\n';
 // *** comment
 for (const typename DynamicCalendar<Char>::RecurrenceDateTime &recurrenceVariant: division.fRecurrence)
-	std::visit([&output](const auto &recurrence) { output << L"RDATE:" << recurrence << '\n'; }, recurrenceVariant);
-if (!division.fName.empty()) output << L"TZNAME:" << division.fName << '\n';
+	std::visit([&output](const auto &recurrence) { output << Literal<Char, "RDATE:"> << recurrence << '\n'; }, recurrenceVariant);
+if (!division.fName.empty()) output << Literal<Char, "TZNAME:"> << division.fName << '\n';
 
-output << L"END:" << kind << '\n';
+output << Literal<Char, "END:"> << kind << '\n';
 
 return output;
 }
 
 
 /*	DynamicCalendar::TimeZone::<<
-	Emit time zone component (3.6.5)
+	Emit time zone component (§3.6.5)
 */
 template <typename Char>
 static std::basic_ostream<Char> &operator<<(
@@ -1843,9 +1869,9 @@ static std::basic_ostream<Char> &operator<<(
 	const typename DynamicCalendar<Char>::TimeZone &timeZone
 	)
 {
-output << L"BEGIN:VTIMEZONE\n";
+output << Literal<Char, "BEGIN:VTIMEZONE\n">;
 
-if (const std::basic_string<Char> &id = timeZone.fID; !id.empty()) output << L"TZID:" << id << '\n';
+if (!timeZone.fID.empty()) output << Literal<Char, "TZID:"> << timeZone.fID << '\n';
 // *****
 
 // extra properties
@@ -1856,14 +1882,14 @@ for (const auto &extra: timeZone.fExtra)
 for (const typename DynamicCalendar<Char>::TimeZone::Division &division: timeZone.fDivisions)
 	output << division;
 
-output << L"END:VTIMEZONE\n";
+output << Literal<Char, "END:VTIMEZONE\n">;
 
 return output;
 }
 
 
 /*	DynamicCalendar::<<
-	Emit iCalendar object (3.4)
+	Emit iCalendar object (§3.4)
 */
 template <typename Char>
 std::basic_ostream<Char> &operator<<(
@@ -1874,14 +1900,14 @@ std::basic_ostream<Char> &operator<<(
 // object must include at least one calendar component
 if (calendar.fComponents.size() == 0) return output;
 
-output << L"BEGIN:VCALENDAR\n";
+output << Literal<Char, "BEGIN:VCALENDAR\n">;
 
 // required properties
-if (!calendar.fProductID.empty()) output << L"PRODID:" << calendar.fProductID << '\n';
-output << L"VERSION:2.0\n";
+if (!calendar.fProductID.empty()) output << Literal<Char, "PRODID:"> << calendar.fProductID << '\n';
+output << Literal<Char, "VERSION:2.0\n">;
 
 // optional properties
-if (calendar.fScale != DynamicCalendar<Char>::Scale::kNone) output << L"CALSCALE:" << calendar.fScale << '\n';
+if (calendar.fScale != DynamicCalendar<Char>::Scale::kNone) output << Literal<Char, "CALSCALE:"> << calendar.fScale << '\n';
 // *** method
 
 // extra properties
@@ -1896,20 +1922,17 @@ for (const auto &component: calendar.fComponents)
 		component
 		);
 
-output << L"END:VCALENDAR\n";
+output << Literal<Char, "END:VCALENDAR\n">;
 
 return output;
 }
 
 
 // explicit instantiation
-/* Unfortunately we can't instantiate both at the same time; not until I find a solution to string literals
-   that doesn't depend on the preprocessor ("CFSTR"). */
-#if 0
+/* Both widths, now that the string literals are spelled with Literal rather than the preprocessor ("CFSTR"):
+   UTF-8 for parsing responses as received, and wide for the console. */
 template struct DynamicCalendar<char>;
 template std::basic_ostream<char> &operator<<(std::basic_ostream<char>&, const DynamicCalendar<char>&);
 
-#else
 template struct DynamicCalendar<wchar_t>;
 template std::basic_ostream<wchar_t> &operator<<(std::basic_ostream<wchar_t>&, const DynamicCalendar<wchar_t>&);
-#endif
@@ -5,7 +5,7 @@
 	
 	2019/05/19	Originated
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 
 	iCalendar handling; independent of transport or storage
 */
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <map>
+#include <memory_resource>
 #include <optional>
 #include <set>
 #include <iostream>
@@ -22,6 +23,7 @@
 #include <vector>
 
 #include "Calendar.h"
+#include "Intern.h"
 
 
 
@@ -33,11 +35,24 @@
 	the following reasons:
 	1)	the standards mostly don't dictate order of properties within components
 	2)	we don't emit values that are also the default for that property
+	
+	Everything in the item tree comes from the memory resource the calendar is constructed with;
+	by default, the heap.  Given a std::pmr::monotonic_buffer_resource instead, none of the strings
+	and containers of a parsed item are allocated from the heap; and however many items are loaded
+	into the one resource are all freed at once when it is released.  Copies are made on the heap,
+	as usual for pmr.
+	
+	Time zone identifiers, the product identifier and the names of extra properties and parameters
+	are interned by the parser, in the InternTable it was given; which must outlast the calendar.
+	Give it one constructed with the same memory resource, so that a calendar on an arena stays
+	self-contained, and that is let go of with the calendar.
 */
 template <typename Char = wchar_t>
 struct DynamicCalendar : public Calendar<Char> {
-	using string = std::basic_string<Char>;	
+	using Allocator = std::pmr::polymorphic_allocator<>;
+	using string = std::pmr::basic_string<Char>;
 	using string_view = std::basic_string_view<Char>;
+	using interned = Interned<Char>;
 	using istream = std::basic_istream<Char>;
 	using ostream = std::basic_ostream<Char>;
 	
@@ -57,7 +72,7 @@ struct DynamicCalendar : public Calendar<Char> {
 	
 	
 	/*	RecurrenceDateTime
-		Recurrence date-time (3.8.5.2)
+		Recurrence date-time (§3.8.5.2)
 	*/
 	using RecurrenceDateTime = std::variant<
 		DateTime,
@@ -67,7 +82,7 @@ struct DynamicCalendar : public Calendar<Char> {
 
 
 	/*	Alarm
-		Alarm component 3.6.6
+		Alarm component §3.6.6
 	*/
 	struct Alarm {
 		using Trigger = std::variant<std::monostate, Duration, DateTime>;
@@ -75,12 +90,15 @@ struct DynamicCalendar : public Calendar<Char> {
 		Action		fAction {};
 		string		fDescription;
 		Trigger		fTrigger;
-		std::map<string, std::pair<string, string>> fLines;
-		std::map<string, std::map<string, string>> fParameters;
+		std::pmr::map<interned, std::pair<string, string>> fLines;
+		std::pmr::map<interned, std::pmr::map<interned, string>> fParameters;
 		
 		// VALARM Extensions for iCalendar 4
 		std::optional<DateTime> fAcknowledged;
 		string		fUID;
+		
+		explicit	Alarm(const Allocator &allocator = {}) :
+					fDescription(allocator), fLines(allocator), fParameters(allocator), fUID(allocator) {}
 		};
 
 
@@ -96,8 +114,10 @@ struct DynamicCalendar : public Calendar<Char> {
 		Unit		fFrequency { Unit::kNone };
 		unsigned	fInterval {};
 		std::variant<std::monostate, Date, DateTime> fUntil;
-		std::set<std::pair<signed char, Weekday>> fByDay;
-		std::set<unsigned char> fMonths0;
+		std::pmr::set<std::pair<signed char, Weekday>> fByDay;
+		std::pmr::set<unsigned char> fMonths0;
+		
+		explicit	RecurrenceRule(const Allocator &allocator = {}) : fByDay(allocator), fMonths0(allocator) {}
 
 	protected:
 		virtual void	Frequency(Unit),
@@ -110,12 +130,12 @@ struct DynamicCalendar : public Calendar<Char> {
 
 
 	/*	Component
-		Event/To-Do/Journal 3.6.3 Calendar Components
+		Event/To-Do/Journal §3.6.3 Calendar Components
 	*/
 	struct Component {
-		std::vector<Alarm> fAlarms;
+		std::pmr::vector<Alarm> fAlarms;
 
-		// descriptive properties 3.8.1
+		// descriptive properties §3.8.1
 		// attachment
 		// categories
 		Classification	fClassification {};
@@ -127,16 +147,16 @@ struct DynamicCalendar : public Calendar<Char> {
 		// resources
 		string		fSummary;
 
-		// date and time component properties 3.8.2
+		// date and time component properties §3.8.2
 		std::variant<std::monostate, Date, DateTime> fStart;
-		string		fStartTimeZoneID,
+		interned	fStartTimeZoneID,
 				fEndTimeZoneID;
 		//		duration
 		//		free/busy time
 
-		// time zone component properties 3.8.3
+		// time zone component properties §3.8.3
 
-		// relationship component properties 3.8.4
+		// relationship component properties §3.8.4
 		//		attendee
 		//		contact
 		//		organizer
@@ -145,56 +165,66 @@ struct DynamicCalendar : public Calendar<Char> {
 		string		fURL;
 		string		fUID;
 
-		// recurrence component properties 3.8.5
+		// recurrence component properties §3.8.5
 		//		exception date-times
 		//		recurrence date-times
 		//		recurrence rule
 		std::optional<RecurrenceRule> fRecurrenceRule;
 
-		// alarm component properties 3.8.6
+		// alarm component properties §3.8.6
 
-		// change management component properties 3.8.7
+		// change management component properties §3.8.7
 		std::optional<DateTime>
 				fCreated,
 				fStamp,
 				fLastModified;
 		unsigned	fSequence {};
 
-		// miscellaneous component properties 3.8.8
-		std::map<string, string> fExtra;
+		// miscellaneous component properties §3.8.8
+		std::pmr::map<interned, string> fExtra;
+		
+		explicit	Component(const Allocator &allocator = {}) :
+					fAlarms(allocator),
+					fDescription(allocator), fLocation(allocator), fSummary(allocator),
+					fURL(allocator), fUID(allocator),
+					fExtra(allocator) {}
 		};
 
 
 	/*	Event
-		Event calendar component 3.6.1
+		Event calendar component §3.6.1
 	*/
 	struct Event : public Component {
-		// descriptive properties 3.8.1
+		// descriptive properties §3.8.1
 		StatusEvent	fStatus {};
 
-		// date and time component properties 3.8.2
+		// date and time component properties §3.8.2
 		std::variant<std::monostate, Date, DateTime> fEnd;
 		Transparency	fTransparency {};
+		
+		explicit	Event(const Allocator &allocator = {}) : Component(allocator) {}
 		};
 
 
 	/*	ToDo
-		To-Do calendar component 3.6.2
+		To-Do calendar component §3.6.2
 	*/
 	struct ToDo : public Component {
-		// descriptive properties 3.8.1
+		// descriptive properties §3.8.1
 		// percent complete
 		StatusToDo	fStatus {};
 
-		// date and time component properties 3.8.2
+		// date and time component properties §3.8.2
 		//		completed
 		std::variant<std::monostate, Date, DateTime> fDue;
-		string		fDueTimeZoneID;
+		interned	fDueTimeZoneID;
+		
+		explicit	ToDo(const Allocator &allocator = {}) : Component(allocator) {}
 		};
 
 	
 	/*	TimeZone
-		Time zone component (3.6.5)
+		Time zone component (§3.6.5)
 	*/
 	struct TimeZone {
 		struct Division {
@@ -214,23 +244,27 @@ struct DynamicCalendar : public Calendar<Char> {
 			std::optional<RecurrenceRule> fRecurrenceRule;
 			
 			// *** comment
-			std::vector<RecurrenceDateTime> fRecurrence;
+			std::pmr::vector<RecurrenceDateTime> fRecurrence;
 			string		fName;
 
 			// *** extra
+			
+			explicit	Division(const Allocator &allocator = {}) : fRecurrence(allocator), fName(allocator) {}
 			};
 		
 
-		// time zone component properties 3.8.3
-		string		fID;
+		// time zone component properties §3.8.3
+		interned	fID;
 		
 		// *** last-mod
 		// *** tzurl
 
-		// miscellaneous component properties 3.8.8
-		std::map<string, string> fExtra;
+		// miscellaneous component properties §3.8.8
+		std::pmr::map<interned, string> fExtra;
+		
+		std::pmr::vector<Division> fDivisions;
 		
-		std::vector<Division> fDivisions;
+		explicit	TimeZone(const Allocator &allocator = {}) : fExtra(allocator), fDivisions(allocator) {}
 		};
 	
 	
@@ -271,6 +305,7 @@ struct DynamicCalendar : public Calendar<Char> {
 		
 		// calendar we're parsing into
 		DynamicCalendar	&fInto;
+		InternTable<Char> &fIntern;
 		
 		// component being parsed
 		std::variant<std::monostate, Event, ToDo, TimeZone> fOuter;
@@ -279,7 +314,7 @@ struct DynamicCalendar : public Calendar<Char> {
 		std::optional<typename TimeZone::Division> fTimeZoneDivision;
 		
 		// parameters
-		string		fTimeZoneIdentifier;
+		interned	fTimeZoneIdentifier;
 		ValueType	fValue;
 		
 		
@@ -342,7 +377,8 @@ struct DynamicCalendar : public Calendar<Char> {
 				XAppleStructuredLocation(string_view);
 	
 	public:
-		explicit	Parser(DynamicCalendar&, istream&);
+		explicit	Parser(DynamicCalendar&, istream&, InternTable<Char>&);
+		explicit	Parser(DynamicCalendar&, string_view, InternTable<Char>&);
 				Parser(const DynamicCalendar&) = delete;
 		};
 	
@@ -362,13 +398,17 @@ struct DynamicCalendar : public Calendar<Char> {
 			>;
 	
 	
-	string		fProductID;
-	std::vector<ComponentVariant> fComponents;
+	interned	fProductID;
+	std::pmr::vector<ComponentVariant> fComponents;
 	
-	// calendar properties 3.7
+	// calendar properties §3.7
 	Scale		fScale {};
 	// version is implied "2.0"
-	std::map<string, string> fExtra;
+	std::pmr::map<interned, string> fExtra;
+	
+	explicit	DynamicCalendar(const Allocator &allocator = {}) : fComponents(allocator), fExtra(allocator) {}
+	
+	Allocator	GetAllocator() const { return fComponents.get_allocator(); }
 	
 	template <typename C>
 	friend std::basic_ostream<C> &operator<<(std::basic_ostream<C>&, const DynamicCalendar<C>&);
@@ -5,13 +5,14 @@
 	
 	2023/04/22	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 	
 	Paragraph references refer to RFC 5545
 */
 
 #include "Dynamic.h"
 #include "Edit.h"
+#include "String.h"
 
 
 using namespace std::string_literals;
@@ -20,18 +21,18 @@ using namespace std::string_literals;
 /*	Get1ToDo
 
 */
-static DynamicCalendar<wchar_t>::ToDo &Get1ToDo(
-	DynamicCalendar<wchar_t> &item
+static DynamicCalendar<char>::ToDo &Get1ToDo(
+	DynamicCalendar<char> &item
 	)
 {
-DynamicCalendar<wchar_t>::ToDo *todo = nullptr;
+DynamicCalendar<char>::ToDo *todo = nullptr;
 
 // make sure there is exactly one To-Do component
 for (auto &component: item.fComponents)
-	if (std::holds_alternative<DynamicCalendar<wchar_t>::ToDo>(component)) {
+	if (std::holds_alternative<DynamicCalendar<char>::ToDo>(component)) {
 		if (todo) throw "expected exactly one to-do component in calendar item";
 		
-		todo = &std::get<DynamicCalendar<wchar_t>::ToDo>(component);
+		todo = &std::get<DynamicCalendar<char>::ToDo>(component);
 		}
 if (!todo) throw "no to-do component in calendar item";
 
@@ -41,22 +42,22 @@ return *todo;
 
 /*	ApplyDueDateTime
 	ApplyDueDate
-	Set Due property of To-Do Component as per 3.8.2.3
+	Set Due property of To-Do Component as per §3.8.2.3
 */
 static void ApplyDueDateTime(
-	DynamicCalendar<wchar_t> &item,
+	DynamicCalendar<char> &item,
 	const wchar_t	arg[]
 	)
 {
-Get1ToDo(item).fDue = DynamicCalendar<wchar_t>::Parser::ParseDateTime(arg);
+Get1ToDo(item).fDue = DynamicCalendar<char>::Parser::ParseDateTime(Narrow(arg));
 }
 
 static void ApplyDueDate(
-	DynamicCalendar<wchar_t> &item,
+	DynamicCalendar<char> &item,
 	const wchar_t	arg[]
 	)
 {
-Get1ToDo(item).fDue = DynamicCalendar<wchar_t>::Parser::ParseDate(arg);
+Get1ToDo(item).fDue = DynamicCalendar<char>::Parser::ParseDate(Narrow(arg));
 }
 
 
@@ -64,7 +65,7 @@ Get1ToDo(item).fDue = DynamicCalendar<wchar_t>::Parser::ParseDate(arg);
 	This should probably accompany a change to the due date to have UTC format
 */
 static void DeleteDueTimeZoneIdentifier(
-	DynamicCalendar<wchar_t> &item
+	DynamicCalendar<char> &item
 	)
 {
 // clear the Due property time zone identifier parameter string
@@ -76,15 +77,15 @@ Get1ToDo(item).fDueTimeZoneID.clear();
 	Delete any Time Zone components
 */
 static void DeleteComponentTimeZone(
-	DynamicCalendar<wchar_t> &item
+	DynamicCalendar<char> &item
 	)
 {
 // remove-erase all Time Zone components
 item.fComponents.erase(
 	std::remove_if(
 		item.fComponents.begin(), item.fComponents.end(),
-		[](DynamicCalendar<wchar_t>::ComponentVariant &component) {
-			return std::holds_alternative<DynamicCalendar<wchar_t>::TimeZone>(component);
+		[](DynamicCalendar<char>::ComponentVariant &component) {
+			return std::holds_alternative<DynamicCalendar<char>::TimeZone>(component);
 			}
 		),
 	item.fComponents.end()
@@ -96,13 +97,13 @@ item.fComponents.erase(
 
 */
 static void ApplySummary(
-	DynamicCalendar<wchar_t> &item,
+	DynamicCalendar<char> &item,
 	const wchar_t	arg[]
 	)
 {
 // assume for now the calendar item has only one calendar component
 if (item.fComponents.size() != 1) throw "expected exactly 1 component in calendar item";
-DynamicCalendar<wchar_t>::ComponentVariant &component = item.fComponents[0];
+DynamicCalendar<char>::ComponentVariant &component = item.fComponents[0];
 
 /* This is a compile-time construct; the 'auto' lambda is instantiated once for each of
    the variants; and the 'constexpr' selects the variants that have a summary.
@@ -113,8 +114,8 @@ DynamicCalendar<wchar_t>::ComponentVariant &component = item.fComponents[0];
 std::visit(
 	[&arg](auto &c) {
 		// only certain component types have a 'summary'
-		if constexpr (std::is_base_of_v<DynamicCalendar<wchar_t>::Component, std::remove_reference_t<decltype(c)>>)
-			c.fSummary = arg;
+		if constexpr (std::is_base_of_v<DynamicCalendar<char>::Component, std::remove_reference_t<decltype(c)>>)
+			c.fSummary = Narrow(arg);
 					
 		else
 			throw "can't set summary on this type of calendar component";
@@ -128,7 +129,7 @@ std::visit(
 	Apply changes to a calendar item on a CalDAV server
 */
 void ApplyEditsToCalendarItem(
-	DynamicCalendar<wchar_t> &calendarItem,
+	DynamicCalendar<char> &calendarItem,
 	int		argc,
 	const wchar_t	*argv[]
 	)
@@ -136,7 +137,7 @@ void ApplyEditsToCalendarItem(
 // no-argument commands
 const static struct Command0 {
 	const wchar_t	*name;
-	void		(*action)(DynamicCalendar<wchar_t>&);
+	void		(*action)(DynamicCalendar<char>&);
 	} commands0[] = {
 	{ L"delete-due-tzid", DeleteDueTimeZoneIdentifier },
 	{ L"delete-timezone", DeleteComponentTimeZone }
@@ -145,7 +146,7 @@ const static struct Command0 {
 // single-argument commands
 const static struct Command1 {
 	const wchar_t	*name;
-	void		(*action)(DynamicCalendar<wchar_t>&, const wchar_t arg[]);
+	void		(*action)(DynamicCalendar<char>&, const wchar_t arg[]);
 	} commands1[] = {
 	{ L"due", ApplyDueDateTime },
 	{ L"due-datetime", ApplyDueDateTime },
@@ -185,8 +186,8 @@ for (; argc > 0; --argc, ++argv)
 
 #if 0
 // create DTSTAMP if not present (*** should be set whenever an update is made)
-if (DynamicCalendar<wchar_t>::ToDo *const toDo = std::get_if<DynamicCalendar<wchar_t>::ToDo>(&calendarItem.fComponents[0]))
+if (DynamicCalendar<char>::ToDo *const toDo = std::get_if<DynamicCalendar<char>::ToDo>(&calendarItem.fComponents[0]))
 	if (!toDo->fStamp)
-		toDo->fStamp = DynamicCalendar<wchar_t>::DateTime::MakeForNowUTC();
+		toDo->fStamp = DynamicCalendar<char>::DateTime::MakeForNowUTC();
 #endif
 }
@@ -5,7 +5,7 @@
 	
 	2023/04/22	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 */
 
 #pragma once
@@ -14,7 +14,7 @@
 
 
 extern void ApplyEditsToCalendarItem(
-	DynamicCalendar<wchar_t> &calendarItem,
+	DynamicCalendar<char> &calendarItem,
 	int		argc,
 	const wchar_t	*argv[]
 	);
@@ -0,0 +1,266 @@
+/*
+	Fetch
+
+	Concurrent retrieval of calendar items
+
+	2023/06/12	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#include "CalDAV.h"
+#include "Fetch.h"
+
+
+
+/*	Fetch
+	Prepare to fetch from the server of the given client
+*/
+Fetch::Fetch(
+	const CHTTPClient &client
+	) :
+	Fetch(client, Options())
+{
+}
+
+
+Fetch::Fetch(
+	const CHTTPClient &client,
+	const Options	&options
+	) :
+	fClient(client),
+	fOptions(options),
+	fPaths(nullptr),
+	fNext(0),
+	fDelivered(0),
+	fLimit(0),
+	fActive(0),
+	fSucceeded(0),
+	fUnavailable(0),
+	fBackoff(0)
+{
+// no worker could ever take a path
+if (fOptions.fOrdered && fOptions.fWindow == 0) throw "ordered fetch needs a window of at least one item";
+}
+
+
+/*	()
+	Fetch the items at the given paths, and deliver each of them to the recipient
+*/
+void Fetch::operator()(
+	const std::vector<std::wstring> &paths,
+	const std::function<void (std::wistream&)> &Recipient
+	)
+{
+fPaths = &paths;
+fNext = fDelivered = 0;
+fRetry.clear();
+fReady.clear();
+fError = nullptr;
+fLimit = std::max(fOptions.fConcurrency, 1u);
+fActive = fSucceeded = fUnavailable = 0;
+fBackoff = std::chrono::milliseconds(0);
+fResume = std::chrono::steady_clock::now();
+
+// start the workers
+std::vector<std::thread> workers;
+const size_t workersN = std::min<size_t>(fLimit, paths.size());
+workers.reserve(workersN);
+for (size_t i = 0; i < workersN; i++)
+	workers.emplace_back([this, &Recipient]() { Work(Recipient); });
+
+// wait for them to run out of work
+for (std::thread &worker: workers)
+	worker.join();
+
+if (fError) std::rethrow_exception(fError);
+}
+
+
+/*	Work
+	Worker thread: keep fetching items until there are none left
+*/
+void Fetch::Work(
+	const std::function<void (std::wistream&)> &Recipient
+	)
+{
+try {
+	// this worker's own connection
+	CHTTPClient client(fClient);
+
+	for (size_t index; Take(index); )
+		try {
+			// buffer the entire item, so the connection is free for the next one
+			std::wstring item;
+			CalDAV::GetItem(
+				client,
+				(*fPaths)[index].c_str(),
+				[&item](std::wistream &is) {
+					item.assign(std::istreambuf_iterator<wchar_t>(is), std::istreambuf_iterator<wchar_t>());
+					}
+				);
+
+			Succeeded();
+			Deliver(index, std::move(item), Recipient);
+			}
+
+		catch (const unsigned status) {
+			// other than the server being overloaded, the error is just passed on
+			if (status != 503 /* Service Unavailable */) throw;
+
+			// try again later
+			std::lock_guard lock(fMutex);
+			fActive--;
+			fRetry.push_back(index);
+			Unavailable();
+			}
+	}
+
+// stop everything and pass on the error
+catch (...) {
+	std::lock_guard lock(fMutex);
+	if (!fError) fError = std::current_exception();
+	fChanged.notify_all();
+	}
+}
+
+
+/*	Take
+	Wait for the next item this worker may fetch; return false if there's nothing left to do
+*/
+bool Fetch::Take(
+	size_t		&index
+	)
+{
+std::unique_lock lock(fMutex);
+
+for (;;) {
+	if (fError) return false;
+
+	// nothing left to take, and no other worker might put anything back?
+	const bool more = !fRetry.empty() || fNext < fPaths->size();
+	if (!more && fActive == 0) return false;
+
+	if (more && fActive < fLimit) {
+		// backing off?
+		if (std::chrono::steady_clock::now() < fResume) {
+			fChanged.wait_until(lock, fResume);
+			continue;
+			}
+
+		// retries first, they're holding up ordered delivery
+		if (!fRetry.empty()) {
+			index = fRetry.back();
+			fRetry.pop_back();
+			fActive++;
+			return true;
+			}
+
+		if (!fOptions.fOrdered || fNext < fDelivered + fOptions.fWindow) {
+			index = fNext++;
+			fActive++;
+			return true;
+			}
+		}
+
+	fChanged.wait(lock);
+	}
+}
+
+
+/*	Succeeded
+	Account for a completed request; slowly recover from any back-off
+*/
+void Fetch::Succeeded()
+{
+std::lock_guard lock(fMutex);
+
+fActive--;
+fUnavailable = 0;
+
+// a full round of successes at the current limit?
+if (++fSucceeded >= fLimit) {
+	fSucceeded = 0;
+	fLimit = std::min(fLimit + 1, std::max(fOptions.fConcurrency, 1u));
+	fBackoff /= 2;
+	}
+
+fChanged.notify_all();
+}
+
+
+/*	Unavailable
+	Back off after the server responded 503
+	The caller holds the mutex
+*/
+void Fetch::Unavailable()
+{
+// given up on ever getting through?  (counting per server rather than per item)
+if (++fUnavailable > fOptions.fRetries) {
+	if (!fError) fError = std::make_exception_ptr(503u);
+	}
+
+else {
+	// pause everyone, for twice as long as last time
+	fBackoff = std::clamp(fBackoff * 2, std::chrono::milliseconds(kBackoffInitial), std::chrono::milliseconds(kBackoffMaximum));
+	fResume = std::chrono::steady_clock::now() + fBackoff;
+
+	// and make fewer requests at a time
+	fLimit = std::max(fLimit / 2, 1u);
+	fSucceeded = 0;
+	}
+
+fChanged.notify_all();
+}
+
+
+/*	Deliver
+	Pass a fetched item on to the recipient; in order, if so required
+*/
+void Fetch::Deliver(
+	size_t		index,
+	std::wstring	&&item,
+	const std::function<void (std::wistream&)> &Recipient
+	)
+{
+if (!fOptions.fOrdered) {
+	std::lock_guard delivering(fDelivering);
+	std::wistringstream is(std::move(item));
+	Recipient(is);
+	return;
+	}
+
+// set it aside until it's its turn
+{
+	std::lock_guard lock(fMutex);
+	fReady.emplace(index, std::move(item));
+	}
+
+// deliver as many as are ready in sequence
+std::lock_guard delivering(fDelivering);
+for (;;) {
+	std::wstring next;
+
+	{
+		std::lock_guard lock(fMutex);
+		const auto found = fReady.find(fDelivered);
+		if (found == fReady.end()) break;
+		next = std::move(found->second);
+		fReady.erase(found);
+		}
+
+	std::wistringstream is(std::move(next));
+	Recipient(is);
+
+	{
+		std::lock_guard lock(fMutex);
+		fDelivered++;
+		}
+	fChanged.notify_all();
+	}
+}
@@ -0,0 +1,92 @@
+/*
+	Fetch
+
+	Concurrent retrieval of calendar items
+
+	2023/06/12	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "HTTPClient.h"
+
+
+
+/*	Fetch
+	GET a list of calendar items over several connections at once
+
+	For servers that don't support calendar-multiget, where the only alternative is
+	a round trip per item.
+
+	Each worker has its own client (hence connection) to the server.  Items are buffered
+	in their entirety before being delivered; so the recipient is called on the worker
+	threads, but never concurrently.  With ordered delivery, the recipient sees the items
+	in the order of the paths; and workers don't get further ahead of delivery than the
+	window allows, to bound the amount of buffered items.
+
+	When the server responds 503 Service Unavailable, all workers pause; the pause doubles
+	with every subsequent 503 and the number of workers allowed to make requests halves.
+	Both recover gradually as requests succeed again.
+*/
+struct Fetch {
+public:
+	struct Options {
+		unsigned	fConcurrency = 4;		// maximum number of connections
+		bool		fOrdered = true;		// deliver in the order of the paths
+		unsigned	fWindow = 64;			// ordered: how far fetching may get ahead of delivery (at least 1)
+		unsigned	fRetries = 8;			// consecutive 503s before giving up
+		};
+
+protected:
+	static constexpr std::chrono::milliseconds
+			kBackoffInitial{250},
+			kBackoffMaximum{30000};
+
+	const CHTTPClient &fClient;
+	const Options	fOptions;
+
+	std::mutex	fMutex;
+	std::condition_variable fChanged;
+
+	// work
+	const std::vector<std::wstring> *fPaths;
+	size_t		fNext;					// next path not yet taken by a worker
+	std::vector<size_t> fRetry;				// paths to be taken again after 503
+	std::exception_ptr fError;
+
+	// delivery
+	std::mutex	fDelivering;
+	size_t		fDelivered;				// ordered: next path to deliver
+	std::map<size_t, std::wstring> fReady;			// ordered: fetched but not yet delivered
+
+	// adaptive back-off
+	unsigned	fLimit,					// number of workers allowed to make requests
+			fActive;				// number of workers making requests
+	unsigned	fSucceeded,				// since the last change of the limit
+			fUnavailable;				// consecutive 503s
+	std::chrono::milliseconds fBackoff;
+	std::chrono::steady_clock::time_point fResume;		// no requests before this
+
+	bool		Take(size_t&);
+	void		Succeeded(), Unavailable();
+	void		Deliver(size_t, std::wstring&&, const std::function<void (std::wistream&)>&);
+	void		Work(const std::function<void (std::wistream&)>&);
+
+public:
+	explicit	Fetch(const CHTTPClient&);
+			Fetch(const CHTTPClient&, const Options&);
+
+	void		operator()(const std::vector<std::wstring> &paths, const std::function<void (std::wistream&)> &Recipient);
+	};
@@ -0,0 +1,569 @@
+/*
+	Inflate
+
+	Decompression of HTTP 'gzip' and 'deflate' content codings
+
+	2023/06/20	Originated
+
+	Copyright © 2023 by: Ben Hekster
+
+	REFERENCES:
+		RFC 1950 ZLIB Compressed Data Format Specification
+		RFC 1951 DEFLATE Compressed Data Format Specification
+		RFC 1952 GZIP file format specification
+*/
+
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+
+#include "Inflate.h"
+
+
+
+/*
+
+	Checks
+
+*/
+
+/*	kCRC32
+	Tables for computing the gzip CRC-32 eight bytes at a time
+*/
+static constexpr std::array<std::array<uint32_t, 256>, 8> kCRC32 = [] {
+	std::array<std::array<uint32_t, 256>, 8> table {};
+
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+		for (unsigned k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320 ^ c >> 1 : c >> 1;
+		table[0][i] = c;
+		}
+
+	for (unsigned t = 1; t < 8; t++)
+		for (unsigned i = 0; i < 256; i++)
+			table[t][i] = table[t - 1][i] >> 8 ^ table[0][table[t - 1][i] & 0xFF];
+
+	return table;
+	}();
+
+
+/*	CRC32
+	Continue the (inverted) CRC-32 over the given bytes
+*/
+static uint32_t CRC32(
+	uint32_t	crc,
+	const uint8_t	*p,
+	const uint8_t	*const e
+	)
+{
+while (e - p >= 8) {
+	const uint32_t
+		lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24),
+		hi = p[4] | p[5] << 8 | p[6] << 16 | static_cast<uint32_t>(p[7]) << 24;
+	crc =
+		kCRC32[7][lo & 0xFF] ^ kCRC32[6][lo >> 8 & 0xFF] ^ kCRC32[5][lo >> 16 & 0xFF] ^ kCRC32[4][lo >> 24] ^
+		kCRC32[3][hi & 0xFF] ^ kCRC32[2][hi >> 8 & 0xFF] ^ kCRC32[1][hi >> 16 & 0xFF] ^ kCRC32[0][hi >> 24];
+	p += 8;
+	}
+
+while (p < e) crc = crc >> 8 ^ kCRC32[0][(crc ^ *p++) & 0xFF];
+
+return crc;
+}
+
+
+/*	Adler32
+	Continue the zlib Adler-32 over the given bytes
+*/
+static uint32_t Adler32(
+	uint32_t	adler,
+	const uint8_t	*p,
+	const uint8_t	*const e
+	)
+{
+// longest run before the sums can overflow
+constexpr size_t kRun = 5552;
+
+uint32_t a = adler & 0xFFFF, b = adler >> 16;
+while (p < e) {
+	const uint8_t *const runE = p + std::min<size_t>(e - p, kRun);
+	for (; p < runE; p++) a += *p, b += a;
+	a %= 65521, b %= 65521;
+	}
+
+return b << 16 | a;
+}
+
+
+
+/*
+
+	Inflater::Huffman
+
+*/
+
+/*	Build
+	Construct the canonical code with the given code lengths
+*/
+void Inflater::Huffman::Build(
+	const uint8_t	lengths[],
+	unsigned	n
+	)
+{
+std::fill(std::begin(fFast), std::end(fFast), 0);
+std::fill(std::begin(fCount), std::end(fCount), 0);
+for (unsigned s = 0; s < n; s++) fCount[lengths[s]]++;
+
+// the code may be incomplete (a single distance code is), but not oversubscribed
+int left = 1;
+for (unsigned l = 1; l < 16; l++)
+	if ((left = (left << 1) - fCount[l]) < 0) throw "invalid compressed content";
+
+// first code and first symbol index of each length
+uint16_t next[16], offset[16];
+next[0] = offset[1] = fCount[0] = 0;
+for (unsigned l = 1; l < 16; l++) {
+	next[l] = (next[l - 1] + fCount[l - 1]) << 1;
+	if (l < 15) offset[l + 1] = offset[l] + fCount[l];
+	}
+
+for (unsigned s = 0; s < n; s++)
+	if (const unsigned l = lengths[s]) {
+		fSymbol[offset[l]++] = static_cast<uint16_t>(s);
+
+		// codes are sent most significant bit first, so they appear reversed in the bit buffer
+		const unsigned code = next[l]++;
+		if (l <= kFastBits) {
+			unsigned reversed = 0;
+			for (unsigned b = 0; b < l; b++) reversed |= (code >> b & 1) << (l - 1 - b);
+			for (unsigned i = reversed; i < 1 << kFastBits; i += 1 << l)
+				fFast[i] = static_cast<uint16_t>(s << 4 | l);
+			}
+		}
+}
+
+
+
+/*
+
+	Inflater
+
+*/
+
+Inflater::Inflater(
+	Format		format,
+	Source		source
+	) :
+	fSource(std::move(source)),
+	fFormat(format),
+	fState(kStateStream),
+	fLast(false),
+	fInB(fIn),
+	fInE(fIn),
+	fBits(0),
+	fBitsL(0),
+	fStoredL(0),
+	fLiterals(nullptr),
+	fDistances(nullptr),
+	fCopyL(0),
+	fCopyD(0),
+	fWindow(new uint8_t[2 * kWindow]),
+	fReadP(fWindow.get()),
+	fWriteP(fWindow.get()),
+	fCheck(0),
+	fSize(0)
+{
+}
+
+
+/*	Fill
+	Take input until there are at least the given number of bits; or return false if the
+	input ends first
+*/
+bool Inflater::Fill(
+	unsigned	n
+	)
+{
+while (fBitsL < n) {
+	if (fInB == fInE) {
+		const size_t got = fSource(fIn, sizeof fIn);
+		if (got == 0) return false;
+		fInB = fIn, fInE = fIn + got;
+		}
+
+	fBits |= static_cast<uint64_t>(*fInB++) << fBitsL;
+	fBitsL += 8;
+	}
+
+return true;
+}
+
+
+/*	Bits
+	Take the given number of bits (at most sixteen)
+*/
+unsigned Inflater::Bits(
+	unsigned	n
+	)
+{
+Need(n);
+const unsigned result = static_cast<unsigned>(fBits & ((1u << n) - 1));
+fBits >>= n;
+fBitsL -= n;
+return result;
+}
+
+
+/*	Decode
+	Take one symbol in the given code
+*/
+unsigned Inflater::Decode(
+	const Huffman	&huffman
+	)
+{
+// near the end of the input there may not be this many left, which is fine if the code is shorter
+Fill(15);
+
+// short codes by lookup
+if (const unsigned entry = huffman.fFast[fBits & ((1u << kFastBits) - 1)]; entry && (entry & 0xF) <= fBitsL) {
+	fBits >>= entry & 0xF;
+	fBitsL -= entry & 0xF;
+	return entry >> 4;
+	}
+
+// longer ones a bit at a time
+for (unsigned l = 1, code = 0, first = 0, index = 0; l < 16; l++) {
+	code |= Bits(1);
+	const unsigned count = huffman.fCount[l];
+	if (code - first < count) return huffman.fSymbol[index + code - first];
+	index += count;
+	first = (first + count) << 1;
+	code <<= 1;
+	}
+
+throw "invalid compressed content";
+}
+
+
+/*	Stream
+	Take the header that precedes the compressed data
+*/
+void Inflater::Stream()
+{
+// nothing at all, as for a response without content
+if (!Fill(8)) { fState = kStateDone; return; }
+
+switch (fFormat) {
+	case kFormatZlib: {
+		// servers disagree on whether 'deflate' includes the zlib wrapper, so accept it bare too
+		const unsigned
+			method = Fill(16) ? static_cast<unsigned>(fBits & 0xFF) : 0,
+			flags = static_cast<unsigned>(fBits >> 8 & 0xFF);
+		if ((method & 0x0F) == 8 && (method >> 4) <= 7 && (method << 8 | flags) % 31 == 0 && !(flags & 0x20)) {
+			Bits(16);
+			fCheck = 1;
+			}
+
+		else
+			fFormat = kFormatDeflate;
+		}
+		break;
+
+	case kFormatGzip: {
+		if (Bits(8) != 0x1F || Bits(8) != 0x8B || Bits(8) != 8) throw "invalid gzip header";
+
+		const unsigned flags = Bits(8);
+		if (flags & 0xE0) throw "invalid gzip header";
+		Bits(16), Bits(16), Bits(16);				// modification time, extra flags, operating system
+
+		// extra field
+		if (flags & 0x04)
+			for (unsigned extraL = Bits(16); extraL > 0; extraL--) Bits(8);
+
+		// file name and comment
+		if (flags & 0x08) while (Bits(8));
+		if (flags & 0x10) while (Bits(8));
+
+		// header CRC
+		if (flags & 0x02) Bits(16);
+
+		fCheck = 0xFFFFFFFF;
+		}
+		break;
+
+	case kFormatDeflate:
+		break;
+	}
+
+fState = kStateBlock;
+}
+
+
+/*	Dynamic
+	Take the code lengths of a block compressed with dynamic Huffman codes
+*/
+void Inflater::Dynamic()
+{
+static constexpr uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+const unsigned
+	literalsL = Bits(5) + 257,
+	distancesL = Bits(5) + 1,
+	lengthsL = Bits(4) + 4;
+if (literalsL > 286 || distancesL > 30) throw "invalid compressed content";
+
+// code lengths of the code lengths
+uint8_t lengths[286 + 30] {};
+for (unsigned i = 0; i < lengthsL; i++) lengths[kOrder[i]] = static_cast<uint8_t>(Bits(3));
+
+Huffman lengthCode;
+lengthCode.Build(lengths, 19);
+
+// code lengths of the literal/length and distance codes, run-length encoded across both
+for (unsigned i = 0; i < literalsL + distancesL; ) {
+	unsigned symbol = Decode(lengthCode), repeat;
+	uint8_t length = 0;
+
+	if (symbol < 16) {
+		lengths[i++] = static_cast<uint8_t>(symbol);
+		continue;
+		}
+
+	else if (symbol == 16) {
+		if (i == 0) throw "invalid compressed content";
+		length = lengths[i - 1];
+		repeat = 3 + Bits(2);
+		}
+
+	else if (symbol == 17)
+		repeat = 3 + Bits(3);
+
+	else
+		repeat = 11 + Bits(7);
+
+	if (i + repeat > literalsL + distancesL) throw "invalid compressed content";
+	while (repeat--) lengths[i++] = length;
+	}
+
+// there must be an end of block code
+if (lengths[256] == 0) throw "invalid compressed content";
+
+fDynamicLiterals.Build(lengths, literalsL);
+fDynamicDistances.Build(lengths + literalsL, distancesL);
+fLiterals = &fDynamicLiterals;
+fDistances = &fDynamicDistances;
+}
+
+
+/*	Trailer
+	Take the check that follows the compressed data
+*/
+void Inflater::Trailer()
+{
+// at a byte boundary
+Bits(fBitsL & 7);
+
+switch (fFormat) {
+	case kFormatZlib: {
+		uint32_t adler = 0;
+		for (unsigned i = 0; i < 4; i++) adler = adler << 8 | Bits(8);
+		if (adler != fCheck) throw "compressed content fails its check";
+		}
+		break;
+
+	case kFormatGzip: {
+		uint32_t crc = 0, size = 0;
+		for (unsigned i = 0; i < 4; i++) crc |= static_cast<uint32_t>(Bits(8)) << 8 * i;
+		for (unsigned i = 0; i < 4; i++) size |= static_cast<uint32_t>(Bits(8)) << 8 * i;
+		if (crc != ~fCheck || size != fSize) throw "compressed content fails its check";
+		}
+		break;
+
+	case kFormatDeflate:
+		break;
+	}
+}
+
+
+/*	Inflate
+	Decompress into the window up to the given limit, or the end of the stream
+*/
+void Inflater::Inflate(
+	uint8_t		*const limit
+	)
+{
+static constexpr uint16_t
+	kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 },
+	kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static constexpr uint8_t
+	kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 },
+	kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+uint8_t *out = fWriteP;
+
+while (out < limit && fState != kStateDone)
+	switch (fState) {
+		case kStateStream:
+			Stream();
+			break;
+
+		case kStateBlock:
+			if (fLast) {
+				Account(out);
+				Trailer();
+				fState = kStateDone;
+				break;
+				}
+
+			fLast = Bits(1);
+			switch (Bits(2)) {
+				case 0: {
+					Bits(fBitsL & 7);
+					const unsigned length = Bits(16);
+					if (Bits(16) != (~length & 0xFFFF)) throw "invalid compressed content";
+					fStoredL = length;
+					fState = kStateStored;
+					}
+					break;
+
+				case 1: {
+					static const struct Fixed {
+						Huffman	fLiterals,
+							fDistances;
+
+						Fixed() {
+							uint8_t lengths[288];
+							std::fill(lengths, lengths + 144, 8);
+							std::fill(lengths + 144, lengths + 256, 9);
+							std::fill(lengths + 256, lengths + 280, 7);
+							std::fill(lengths + 280, lengths + 288, 8);
+							fLiterals.Build(lengths, 288);
+							std::fill(lengths, lengths + 30, 5);
+							fDistances.Build(lengths, 30);
+							}
+						} kFixed;
+
+					fLiterals = &kFixed.fLiterals;
+					fDistances = &kFixed.fDistances;
+					fState = kStateHuffman;
+					}
+					break;
+
+				case 2:
+					Dynamic();
+					fState = kStateHuffman;
+					break;
+
+				default:
+					throw "invalid compressed content";
+				}
+			break;
+
+		case kStateStored:
+			if (fStoredL == 0)
+				fState = kStateBlock;
+
+			// what's left in the bit buffer is whole bytes by now
+			else if (fBitsL > 0)
+				*out++ = static_cast<uint8_t>(Bits(8)), fStoredL--;
+
+			else if (fInB == fInE)
+				Need(8);
+
+			else {
+				const size_t n = std::min<size_t>({ fStoredL, static_cast<size_t>(limit - out), static_cast<size_t>(fInE - fInB) });
+				memcpy(out, fInB, n);
+				out += n, fInB += n, fStoredL -= n;
+				}
+			break;
+
+		case kStateHuffman:
+			// resume a match
+			if (fCopyL > 0) {
+				const uint8_t *from = out - fCopyD;
+				const unsigned n = static_cast<unsigned>(std::min<size_t>(fCopyL, limit - out));
+				fCopyL -= n;
+
+				// the match may overlap what it produces
+				for (uint8_t *const copyE = out + n; out < copyE; ) *out++ = *from++;
+				}
+
+			else if (const unsigned symbol = Decode(*fLiterals); symbol < 256)
+				*out++ = static_cast<uint8_t>(symbol);
+
+			else if (symbol == 256)
+				fState = kStateBlock;
+
+			else {
+				if (symbol > 285) throw "invalid compressed content";
+				fCopyL = kLengthBase[symbol - 257] + Bits(kLengthExtra[symbol - 257]);
+
+				const unsigned distance = Decode(*fDistances);
+				if (distance > 29) throw "invalid compressed content";
+				fCopyD = kDistanceBase[distance] + Bits(kDistanceExtra[distance]);
+				if (fCopyD > static_cast<size_t>(out - fWindow.get())) throw "invalid compressed content";
+				}
+			break;
+
+		case kStateDone:
+			break;
+		}
+
+Account(out);
+}
+
+
+/*	Account
+	Include what was just decompressed in the check
+*/
+void Inflater::Account(
+	uint8_t		*const out
+	)
+{
+switch (fFormat) {
+	case kFormatZlib: fCheck = Adler32(fCheck, fWriteP, out); break;
+	case kFormatGzip: fCheck = CRC32(fCheck, fWriteP, out); break;
+	case kFormatDeflate: break;
+	}
+
+fSize += static_cast<uint32_t>(out - fWriteP);
+fWriteP = out;
+}
+
+
+/*	Available
+	Return how much decompressed data can be read without waiting; decompressing more if
+	there is none, so zero only at the end
+*/
+size_t Inflater::Available()
+{
+while (fReadP == fWriteP && fState != kStateDone) {
+	uint8_t *const windowE = fWindow.get() + 2 * kWindow;
+
+	// keep only as much history as a match may refer to
+	if (fWriteP == windowE) {
+		memmove(fWindow.get(), windowE - kWindow, kWindow);
+		fReadP = fWriteP = fWindow.get() + kWindow;
+		}
+
+	Inflate(windowE);
+	}
+
+return fWriteP - fReadP;
+}
+
+
+/*	Read
+	Take decompressed data up to the given length; only zero at the end
+*/
+size_t Inflater::Read(
+	void		*buffer,
+	size_t		length
+	)
+{
+const size_t n = std::min(Available(), length);
+memcpy(buffer, fReadP, n);
+fReadP += n;
+return n;
+}
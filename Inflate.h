@@ -0,0 +1,110 @@
+/*
+	Inflate
+
+	Decompression of HTTP 'gzip' and 'deflate' content codings
+
+	2023/06/20	Originated
+
+	Copyright © 2023 by: Ben Hekster
+
+	Compressed data is pulled from a source function as it's needed, and decompressed a
+	window at a time; so a response body can be decompressed as it arrives, without
+	having all of it first.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+
+
+
+/*	Inflater
+	Decompress a DEFLATE stream [RFC 1951], as wrapped by 'gzip' [RFC 1952] or 'deflate'
+	[RFC 9110 §8.4.1.2] content coding
+*/
+class Inflater {
+public:
+	enum Format {
+		kFormatDeflate,					// bare
+		kFormatZlib,					// in a zlib wrapper [RFC 1950]; or bare, as some servers send it
+		kFormatGzip					// in a gzip wrapper
+		};
+
+	// supplies compressed data as far as it fits; zero at the end
+	using Source = std::function<size_t (void*, size_t)>;
+
+protected:
+	static constexpr size_t
+			kWindow = 0x8000,		// how far back a match can refer
+			kInput = 0x4000;
+	static constexpr unsigned kFastBits = 10;	// codes up to this long are decoded by table lookup
+
+	/*	Huffman
+		Canonical Huffman code
+	*/
+	struct Huffman {
+		uint16_t	fFast[1 << kFastBits],		// symbol << 4 | code length; zero if the code is longer
+				fCount[16],			// number of codes of each length
+				fSymbol[288];			// symbols in order of their codes
+
+		void		Build(const uint8_t lengths[], unsigned n);
+		};
+
+	enum State {
+		kStateStream,					// at the stream header
+		kStateBlock,					// at a block header
+		kStateStored,					// in a stored block
+		kStateHuffman,					// in a compressed block
+		kStateDone
+		};
+
+	const Source	fSource;
+	Format		fFormat;
+	State		fState;
+	bool		fLast;				// current block is the last
+
+	// compressed input
+	uint8_t		fIn[kInput],
+			*fInB,
+			*fInE;
+	uint64_t	fBits;				// bits taken from the input but not yet consumed
+	unsigned	fBitsL;
+
+	// current block
+	size_t		fStoredL;			// remaining in stored block
+	const Huffman	*fLiterals,
+			*fDistances;
+	Huffman		fDynamicLiterals,
+			fDynamicDistances;
+	unsigned	fCopyL,				// remaining in match
+			fCopyD;
+
+	// decompressed output, preceded by as much history as a match can refer to
+	const std::unique_ptr<uint8_t[]> fWindow;
+	uint8_t		*fReadP,
+			*fWriteP;
+	uint32_t	fCheck,				// CRC-32 or Adler-32 of the output so far
+			fSize;
+
+	bool		Fill(unsigned);
+	void		Need(unsigned n) { if (!Fill(n)) throw "compressed content is truncated"; }
+	unsigned	Bits(unsigned);
+	unsigned	Decode(const Huffman&);
+
+	void		Stream();
+	void		Dynamic();
+	void		Trailer();
+	void		Inflate(uint8_t *limit);
+	void		Account(uint8_t *out);
+
+public:
+			Inflater(Format, Source);
+			Inflater(const Inflater&) = delete;
+
+	size_t		Available();
+	size_t		Read(void *buffer, size_t length);
+	};
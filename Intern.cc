@@ -0,0 +1,37 @@
+/*
+	Intern
+
+	Strings kept once and referred to by handle
+
+	2023/10/14	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include "Intern.h"
+
+
+
+/*	()
+	Return the handle for the given string, adding it to the table if it's not there yet
+*/
+template <typename Char>
+Interned<Char> InternTable<Char>::operator()(
+	const std::basic_string_view<Char> string
+	)
+{
+// the empty string doesn't need keeping
+if (string.empty()) return Interned<Char>();
+
+const std::lock_guard lock(fMutex);
+
+auto found = fStrings.find(string);
+if (found == fStrings.end()) found = fStrings.emplace(string).first;
+
+return Interned<Char>(&*found);
+}
+
+
+// explicit instantiation
+template class InternTable<char>;
+template class InternTable<wchar_t>;
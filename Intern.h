@@ -0,0 +1,86 @@
+/*
+	Intern
+
+	Strings kept once and referred to by handle
+
+	2023/10/14	Originated
+
+	Copyright © 2023 by: Ben Hekster
+
+	Time zone identifiers, product identifiers and the names of extension properties repeat
+	the same few dozen values across thousands of calendar items.  Interning them keeps one
+	copy of each, and makes equality a matter of comparing pointers.
+*/
+
+#pragma once
+
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+
+
+
+template <typename Char>
+class InternTable;
+
+
+/*	Interned
+	Handle to a string kept by an InternTable
+
+	Equal strings interned in the same table have the same handle, so equality only compares
+	pointers; handles from different tables must not be compared.  Ordering compares the
+	strings, so that a map keyed by handles keeps the order it would have keyed by strings.
+	A handle is only good for as long as its table exists.
+*/
+template <typename Char>
+class Interned {
+	friend class InternTable<Char>;
+
+public:
+	using string_view = std::basic_string_view<Char>;
+
+protected:
+	const std::pmr::basic_string<Char> *fString;		// or null if empty
+
+	explicit	Interned(const std::pmr::basic_string<Char> *string) : fString(string) {}
+
+public:
+			Interned() : fString(nullptr) {}
+
+	bool		empty() const { return !fString; }
+	void		clear() { fString = nullptr; }
+
+	operator	string_view() const { return fString ? string_view(*fString) : string_view(); }
+
+	friend bool	operator==(const Interned a, const Interned b) { return a.fString == b.fString; }
+	friend bool	operator==(const Interned a, const string_view b) { return string_view(a) == b; }
+	friend bool	operator<(const Interned a, const Interned b) { return a.fString != b.fString && string_view(a) < string_view(b); }
+
+	friend std::basic_ostream<Char> &operator<<(std::basic_ostream<Char> &output, const Interned interned) { return output << string_view(interned); }
+	};
+
+
+/*	InternTable
+	Set of distinct strings, each of which stays put for as long as the table exists
+
+	There's no table shared by the whole process, so nothing collects every name it ever
+	parsed; a table lasts only as long as whoever made it for the calendars that use it.
+	Interning locks the table, so one table can serve parsers on several threads.
+*/
+template <typename Char>
+class InternTable {
+protected:
+	std::mutex	fMutex;
+	std::pmr::set<std::pmr::basic_string<Char>, std::less<>> fStrings;
+
+public:
+	explicit	InternTable(const std::pmr::polymorphic_allocator<> &allocator = {}) : fStrings(allocator) {}
+			InternTable(const InternTable&) = delete;
+
+	InternTable	&operator=(const InternTable&) = delete;
+
+	Interned<Char>	operator()(std::basic_string_view<Char>);
+	};
@@ -0,0 +1,88 @@
+/*
+	Mirror
+
+	Local copy of a calendar collection, kept up to date by collection synchronization
+
+	2023/09/28	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include <filesystem>
+#include <fstream>
+
+#include "Mirror.h"
+
+
+
+/*
+	The file is a signature line and the token line, followed by each item as its href,
+	ETag and data length on lines of their own and then the data itself:
+
+	CalDAV mirror 1
+	http://example.com/ns/sync/1234
+	/calendars/user/calendar/1.ics
+	"5f3e"
+	312
+	BEGIN:VCALENDAR...
+*/
+static constexpr char kSignature[] = "CalDAV mirror 1";
+
+
+
+/*	Load
+	Read the mirror from the given file; or return an empty one if there isn't any yet
+*/
+Mirror Mirror::Load(
+	const wchar_t	path[]
+	)
+{
+Mirror result;
+
+std::ifstream ifs(std::filesystem::path(path), std::ios::binary);
+if (!ifs) return result;
+
+std::string line;
+if (!std::getline(ifs, line) || line != kSignature) throw "not a calendar mirror";
+if (!std::getline(ifs, result.fToken)) throw "calendar mirror is truncated";
+
+for (std::string href; std::getline(ifs, href); ) {
+	Item item;
+	if (!std::getline(ifs, item.fETag) || !std::getline(ifs, line)) throw "calendar mirror is truncated";
+
+	item.fData.resize(std::stoull(line));
+	if (!ifs.read(item.fData.data(), item.fData.size()) || ifs.get() != '\n') throw "calendar mirror is truncated";
+
+	result.fItems.emplace(std::move(href), std::move(item));
+	}
+
+return result;
+}
+
+
+/*	Save
+	Write the mirror to the given file
+*/
+void Mirror::Save(
+	const wchar_t	path[]
+	) const
+{
+const std::filesystem::path
+	final(path),
+	temporary = std::filesystem::path(path) += L".new";
+
+{
+std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+if (!ofs) throw "can't write calendar mirror";
+
+ofs << kSignature << '\n' << fToken << '\n';
+for (const auto &[href, item]: fItems) {
+	ofs << href << '\n' << item.fETag << '\n' << item.fData.size() << '\n';
+	ofs.write(item.fData.data(), item.fData.size()) << '\n';
+	}
+
+if (!ofs.flush()) throw "can't write calendar mirror";
+}
+
+std::filesystem::rename(temporary, final);
+}
@@ -0,0 +1,36 @@
+/*
+	Mirror
+
+	Local copy of a calendar collection, kept up to date by collection synchronization
+
+	2023/09/28	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+
+
+/*	Mirror
+	The items of a calendar collection as of a synchronization token
+
+	Everything is kept as the server sent it: hrefs, ETags and calendar data in UTF-8, so
+	nothing needs converting on the way in or out.  The file is written beside the old one
+	and then renamed over it, so an interrupted save leaves the previous state intact.
+*/
+struct Mirror {
+	struct Item {
+		std::string	fETag,
+				fData;				// iCalendar object
+		};
+
+	std::string	fToken;					// empty if never synchronized
+	std::map<std::string, Item> fItems;			// by href
+
+	static Mirror	Load(const wchar_t path[]);
+	void		Save(const wchar_t path[]) const;
+	};
@@ -0,0 +1,1245 @@
+/*
+	HTTPClient
+
+	HTTP experimentation
+	POSIX
+
+	2023/06/10	Originated
+
+	Copyright © 2018-2023 by: Ben Hekster
+
+	REFERENCES:
+		RFC 9112 HTTP/1.1
+		RFC 7617 The 'Basic' HTTP Authentication Scheme
+		RFC 9110 HTTP Semantics
+*/
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+
+#include "HTTPClient.h"
+#include "String.h"
+#include "Transcode.h"
+
+
+// don't let a peer that closed the connection raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = 0;
+#endif
+
+
+
+/*
+
+	UTF-8
+
+*/
+
+/*	Base64
+	Encode as per RFC 4648 §4
+*/
+static std::string Base64(
+	std::string_view data
+	)
+{
+static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string result;
+result.reserve((data.size() + 2) / 3 * 4);
+
+for (size_t i = 0; i < data.size(); i += 3) {
+	const size_t remaining = data.size() - i;
+	const unsigned long triple =
+		static_cast<unsigned char>(data[i]) << 16 |
+		(remaining > 1 ? static_cast<unsigned char>(data[i + 1]) << 8 : 0) |
+		(remaining > 2 ? static_cast<unsigned char>(data[i + 2]) : 0);
+
+	result.push_back(alphabet[triple >> 18 & 0x3F]);
+	result.push_back(alphabet[triple >> 12 & 0x3F]);
+	result.push_back(remaining > 1 ? alphabet[triple >> 6 & 0x3F] : '=');
+	result.push_back(remaining > 2 ? alphabet[triple & 0x3F] : '=');
+	}
+
+return result;
+}
+
+
+
+/*
+
+	CHTTPClient::Address
+
+*/
+
+/*	Crack
+	Split a URL into its components; return false if it doesn't have a scheme (and so
+	is presumably just a path)
+*/
+bool CHTTPClient::Address::Crack(
+	const wchar_t	url[],
+	const std::function<void (std::wstring_view scheme, std::wstring_view host, unsigned short port, std::wstring_view path)> &Cracked
+	)
+{
+const std::wstring_view u(url);
+
+// find end of scheme
+const size_t schemeE = u.find(L"://");
+if (schemeE == std::wstring_view::npos) return false;
+
+const std::wstring_view scheme = u.substr(0, schemeE);
+
+// authority extends to the path
+const size_t authorityB = schemeE + 3;
+const size_t pathB = std::min(u.find(L'/', authorityB), u.size());
+std::wstring_view authority = u.substr(authorityB, pathB - authorityB);
+
+// discard any user information
+if (const size_t at = authority.rfind(L'@'); at != std::wstring_view::npos)
+	authority.remove_prefix(at + 1);
+
+// separate port
+std::wstring_view host = authority;
+unsigned long port = 0;
+if (const size_t colon = authority.rfind(L':'); colon != std::wstring_view::npos && authority.find(L']', colon) == std::wstring_view::npos) {
+	host = authority.substr(0, colon);
+	for (const wchar_t c: authority.substr(colon + 1)) {
+		if (c < L'0' || c > L'9') throw "invalid port in URL";
+		port = port * 10 + (c - L'0');
+		if (port > 0xFFFF) throw "port out of range in URL";
+		}
+	}
+
+// an IPv6 literal is bracketed only to set it apart from the port [RFC 3986 §3.2.2]
+if (host.size() >= 2 && host.front() == L'[' && host.back() == L']')
+	host = host.substr(1, host.size() - 2);
+
+Cracked(scheme, host, static_cast<unsigned short>(port), pathB < u.size() ? u.substr(pathB) : std::wstring_view(L"/"));
+return true;
+}
+
+
+
+/*
+
+	CHTTPClient::Connection
+
+*/
+
+/*	Connection
+	Establish a connection to the server
+*/
+CHTTPClient::Connection::Connection(
+	const std::string &host,
+	unsigned short	port
+	) :
+	fSocket(-1),
+	fReceive(new char[kReceiveBufferSize]),
+	fReceiveBegin(0),
+	fReceiveEnd(0)
+{
+// resolve the server address
+addrinfo hints = {};
+hints.ai_family = AF_UNSPEC;
+hints.ai_socktype = SOCK_STREAM;
+addrinfo *addresses;
+if (const int error = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses)) throw gai_strerror(error);
+std::unique_ptr<addrinfo, decltype(&freeaddrinfo)> addressesOwner(addresses, &freeaddrinfo);
+
+unsigned long error = ECONNREFUSED;
+
+// try each address in turn
+for (const addrinfo *address = addresses; address; address = address->ai_next) {
+	const int s = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+	if (s < 0) { error = errno; continue; }
+
+	// make the socket non-blocking, so all waiting goes through poll() with a timeout
+	const int flags = fcntl(s, F_GETFL);
+	if (flags < 0 || fcntl(s, F_SETFL, flags | O_NONBLOCK) < 0) { error = errno; close(s); continue; }
+
+	#ifdef SO_NOSIGPIPE
+	const int noSigPipe = 1;
+	(void) setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof noSigPipe);
+	#endif
+
+	// requests are written in few, complete pieces; don't wait for acknowledgements
+	const int noDelay = 1;
+	(void) setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof noDelay);
+
+	fSocket = s;
+
+	// start connecting
+	if (connect(s, address->ai_addr, address->ai_addrlen) == 0)
+		break;
+
+	else if (errno == EINPROGRESS) {
+		// wait for connection to complete
+		try { Await(POLLOUT); }
+		catch (...) { Close(); throw; }
+
+		int result;
+		socklen_t resultL = sizeof result;
+		if (getsockopt(s, SOL_SOCKET, SO_ERROR, &result, &resultL) == 0 && result == 0)
+			break;
+
+		error = result;
+		}
+
+	else
+		error = errno;
+
+	Close();
+	}
+
+if (fSocket < 0) throw error;
+}
+
+
+/*	Connection
+	Move constructor
+*/
+CHTTPClient::Connection::Connection(
+	Connection	&&that
+	) :
+	fSocket(std::exchange(that.fSocket, -1)),
+	fReceive(std::move(that.fReceive)),
+	fReceiveBegin(std::exchange(that.fReceiveBegin, 0)),
+	fReceiveEnd(std::exchange(that.fReceiveEnd, 0))
+{
+}
+
+
+/*	=
+	Move assignment
+*/
+CHTTPClient::Connection &CHTTPClient::Connection::operator=(
+	Connection	&&that
+	)
+{
+if (this != &that) {
+	Close();
+	fSocket = std::exchange(that.fSocket, -1);
+	fReceive = std::move(that.fReceive);
+	fReceiveBegin = std::exchange(that.fReceiveBegin, 0);
+	fReceiveEnd = std::exchange(that.fReceiveEnd, 0);
+	}
+
+return *this;
+}
+
+
+/*	Close
+	Close the connection to the server, if any
+*/
+void CHTTPClient::Connection::Close()
+{
+if (fSocket >= 0) {
+	(void) close(fSocket);
+	fSocket = -1;
+	}
+
+fReceiveBegin = fReceiveEnd = 0;
+}
+
+
+/*	Healthy
+	Return whether an idle connection still looks usable
+*/
+bool CHTTPClient::Connection::Healthy() const
+{
+// nothing left over from the previous response?
+if (fSocket < 0 || Buffered() > 0) return false;
+
+// an idle connection should have nothing to read; if it does, it's the server closing it
+/* (or an error, or unsolicited data; none of which leave it usable) */
+pollfd descriptor = { fSocket, POLLIN, 0 };
+return poll(&descriptor, 1, 0 /* don't wait */) == 0;
+}
+
+
+/*	Await
+	Wait for the socket to become ready for the given events
+*/
+void CHTTPClient::Connection::Await(
+	short		events
+	) const
+{
+pollfd descriptor = { fSocket, events, 0 };
+
+for (;;)
+	switch (poll(&descriptor, 1, kTimeout)) {
+		case 0:
+			throw "timed out waiting for HTTP server";
+
+		case -1:
+			if (errno == EINTR) continue;
+			throw static_cast<unsigned long>(errno);
+
+		default:
+			// report readiness even on error or hangup; the following I/O call will find out
+			return;
+		}
+}
+
+
+/*	Send
+	Write all the given data to the connection
+*/
+void CHTTPClient::Connection::Send(
+	const void	*data,
+	size_t		dataL
+	)
+{
+const char *d = static_cast<const char*>(data);
+
+while (dataL > 0)
+	if (const ssize_t sent = send(fSocket, d, dataL, kSendFlags); sent >= 0)
+		d += sent, dataL -= sent;
+
+	else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		Await(POLLOUT);
+
+	else if (errno != EINTR)
+		throw static_cast<unsigned long>(errno);
+}
+
+
+/*	Receive
+	Wait for more data to arrive in the receive buffer; return how much arrived,
+	or zero if the server closed the connection
+*/
+size_t CHTTPClient::Connection::Receive()
+{
+// consolidate any unconsumed data to the start of the buffer
+if (fReceiveBegin > 0) {
+	(void) memmove(fReceive.get(), fReceive.get() + fReceiveBegin, fReceiveEnd - fReceiveBegin);
+	fReceiveEnd -= fReceiveBegin;
+	fReceiveBegin = 0;
+	}
+
+if (fReceiveEnd == kReceiveBufferSize) throw "HTTP receive buffer overflow";
+
+for (;;)
+	if (const ssize_t received = recv(fSocket, fReceive.get() + fReceiveEnd, kReceiveBufferSize - fReceiveEnd, 0); received >= 0) {
+		fReceiveEnd += received;
+		return received;
+		}
+
+	else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		Await(POLLIN);
+
+	else if (errno != EINTR)
+		throw static_cast<unsigned long>(errno);
+}
+
+
+/*	ReceiveLine
+	Receive a CRLF-terminated line (without the terminator); return false if the server
+	closed the connection before anything was received
+*/
+bool CHTTPClient::Connection::ReceiveLine(
+	std::string	&line
+	)
+{
+for (bool first = true; ; first = false) {
+	const char
+		*const begin = fReceive.get() + fReceiveBegin,
+		*const end = fReceive.get() + fReceiveEnd;
+
+	// have a complete line?
+	if (const char *const lf = std::find(begin, end, '\n'); lf != end) {
+		line.assign(begin, lf > begin && lf[-1] == '\r' ? lf - 1 : lf);
+		fReceiveBegin += lf + 1 - begin;
+		return true;
+		}
+
+	if (!Receive()) {
+		if (first && Buffered() == 0) return false;
+		throw "HTTP server closed connection unexpectedly";
+		}
+	}
+}
+
+
+/*	Consume
+	Copy received data into the given buffer
+*/
+size_t CHTTPClient::Connection::Consume(
+	void		*buffer,
+	size_t		length
+	)
+{
+length = std::min(length, Buffered());
+
+(void) memcpy(buffer, fReceive.get() + fReceiveBegin, length);
+fReceiveBegin += length;
+
+return length;
+}
+
+
+
+/*
+
+	CHTTPClient::Pool
+
+*/
+
+/*	Pool
+	Keep up to 'fMaxIdle' connections per server for up to 'fIdleTimeout'
+*/
+CHTTPClient::Pool::Pool() :
+	Pool(Options())
+{
+}
+
+CHTTPClient::Pool::Pool(
+	const Options	&options
+	) :
+	fOptions(options)
+{
+}
+
+
+/*	Default
+	Return the pool shared by all clients that aren't given one explicitly
+*/
+CHTTPClient::Pool &CHTTPClient::Pool::Default()
+{
+static Pool pool;
+return pool;
+}
+
+
+/*	Evict
+	Close connections that have been idle for too long
+	The caller holds the mutex
+*/
+void CHTTPClient::Pool::Evict(
+	std::chrono::steady_clock::time_point now
+	)
+{
+for (auto i = fIdle.begin(); i != fIdle.end(); ) {
+	// connections are returned to the back, so the oldest are at the front
+	std::deque<Idle> &idle = i->second;
+	while (!idle.empty() && now - idle.front().fSince > fOptions.fIdleTimeout)
+		idle.pop_front();
+
+	if (idle.empty())
+		i = fIdle.erase(i);
+	else
+		++i;
+	}
+}
+
+
+/*	CheckOut
+	Take an idle connection to the given server out of the pool; or return an
+	unconnected one if there isn't any healthy one
+*/
+CHTTPClient::Connection CHTTPClient::Pool::CheckOut(
+	const Key	&key
+	)
+{
+std::lock_guard lock(fMutex);
+
+Evict(std::chrono::steady_clock::now());
+
+if (const auto found = fIdle.find(key); found != fIdle.end())
+	// most recently used first; it's the least likely to have been closed by the server
+	for (std::deque<Idle> &idle = found->second; !idle.empty(); ) {
+		Connection connection = std::move(idle.back().fConnection);
+		idle.pop_back();
+
+		if (connection.Healthy()) return connection;
+		}
+
+return Connection();
+}
+
+
+/*	Return
+	Put a connection that can be kept alive back into the pool
+*/
+void CHTTPClient::Pool::Return(
+	const Key	&key,
+	Connection	&&connection
+	)
+{
+if (!connection.Healthy()) return;
+
+std::lock_guard lock(fMutex);
+
+const auto now = std::chrono::steady_clock::now();
+Evict(now);
+
+if (fOptions.fMaxIdle == 0) return;
+
+std::deque<Idle> &idle = fIdle[key];
+if (idle.size() >= fOptions.fMaxIdle) idle.pop_front();
+idle.push_back({ std::move(connection), now });
+}
+
+
+/*	Kept
+	Return the number of connections kept for reuse
+*/
+size_t CHTTPClient::Pool::Kept()
+{
+std::lock_guard lock(fMutex);
+
+Evict(std::chrono::steady_clock::now());
+
+size_t result = 0;
+for (const auto &[key, idle]: fIdle) result += idle.size();
+return result;
+}
+
+
+
+/*
+
+	CHTTPClient
+
+*/
+
+/*	CHTTPClient
+	Make requests to an HTTP server
+	Connections are only established (or taken from the pool) by requests
+*/
+CHTTPClient::CHTTPClient(
+	const Address	&server,
+	const wchar_t	username[],
+	const wchar_t	password[]
+	) :
+	CHTTPClient(Pool::Default(), server, username, password)
+{
+}
+
+CHTTPClient::CHTTPClient(
+	Pool		&pool,
+	const Address	&server,
+	const wchar_t	username[],
+	const wchar_t	password[]
+	) :
+	fPool(pool),
+	fHost(Narrow(server.fHost)),
+	fPort(server.fPort),
+	fSecure(server.fSecure),
+	fAuthenticationScheme(kAuthenticationNone),
+	fChunked(true),
+	fUsername(username),
+	fPassword(password)
+{
+if (fSecure) throw "TLS is not supported by the POSIX HTTP client";
+}
+
+
+/*	CHTTPClient
+	Make another client to the same server, with the same credentials; for use in parallel
+	It doesn't share the connection, only the pool
+*/
+CHTTPClient::CHTTPClient(
+	const CHTTPClient &that
+	) :
+	fPool(that.fPool),
+	fHost(that.fHost),
+	fPort(that.fPort),
+	fSecure(that.fSecure),
+	fAuthenticationScheme(that.fAuthenticationScheme),
+	fChunked(that.fChunked),
+	fUsername(that.fUsername),
+	fPassword(that.fPassword)
+{
+}
+
+
+/*	CHTTPClient
+	Move constructor
+*/
+CHTTPClient::CHTTPClient(
+	CHTTPClient	&&that
+	) :
+	fPool(that.fPool),
+	fHost(std::move(that.fHost)),
+	fPort(that.fPort),
+	fSecure(that.fSecure),
+	fConnection(std::move(that.fConnection)),
+	fAuthenticationScheme(that.fAuthenticationScheme),
+	fChunked(that.fChunked),
+	fUsername(that.fUsername),
+	fPassword(that.fPassword)
+{
+}
+
+
+/*	~CHTTPClient
+	Give any connection back to the pool
+*/
+CHTTPClient::~CHTTPClient()
+{
+if (fConnection) Release();
+}
+
+
+/*	Connect
+	Make sure there is a connection to the server; return whether it was already
+	established (and so may since have been closed by the server)
+*/
+bool CHTTPClient::Connect()
+{
+if (fConnection) return true;
+
+// reuse an idle connection to the same server?
+if ((fConnection = fPool.CheckOut({ fSecure, fHost, fPort }))) return true;
+
+fConnection = Connection(fHost, fPort);
+return false;
+}
+
+
+/*	Release
+	Return the connection to the pool
+*/
+void CHTTPClient::Release()
+{
+fPool.Return({ fSecure, fHost, fPort }, std::move(fConnection));
+fConnection.Close();
+}
+
+
+/*	Request
+	Issue an HTTP request on the session
+*/
+void CHTTPClient::Request(
+	const wchar_t	path[],
+	const wchar_t	verb[],
+	const std::function<void (const std::function<void (const wchar_t*, const wchar_t*)>&)> &Headers,
+	Rekwest		&&rekwest,
+	const std::function<void (Response&)> &AcceptResponse
+	)
+{
+const std::string method = Narrow(verb);
+const bool head = method == "HEAD";
+std::string target = Narrow(path);
+
+// construct additional headers string
+std::string headers;
+Headers(
+	[&headers](const wchar_t *name, const wchar_t *value) {
+		headers.append(Narrow(name));
+		headers.append(": ");
+		headers.append(Narrow(value));
+		headers.append("\r\n");
+		}
+	);
+
+// last character should not be NUL
+/* (iCloud at least will return 405 Bad Request) */
+if (rekwest.fData && rekwest.fDataL > 0)
+	assert(static_cast<const char*>(rekwest.fData)[rekwest.fDataL - 1] != '\0');
+
+Response response(*this);
+
+// keep retrying with corrective actions
+unsigned redirects = 0;
+bool retry;
+do {
+	retry = false;
+
+	// a kept-alive connection may have been closed by the server in the meantime
+	const bool reused = Connect();
+
+	// find total length of request body
+	/* In some cases, calculating this may force the user to generate the entire request body. */
+	size_t length = rekwest.Length();
+
+	// not known until it's been generated?
+	const bool
+		chunked = length == Rekwest::kLengthUnknown && fChunked,
+		buffered = length == Rekwest::kLengthUnknown && !fChunked;
+	std::string whole;
+	if (buffered) {
+		// the server won't take it in chunks, so generate all of it first after all
+		whole.assign(static_cast<const char*>(rekwest.fData), rekwest.fDataL);
+		for (bool pushed = true; pushed; ) {
+			pushed = false;
+			rekwest.Data([&whole, &pushed](const void *data, size_t dataL) { whole.append(static_cast<const char*>(data), dataL); pushed |= dataL > 0; });
+			}
+		length = whole.size();
+		}
+
+	// compose request line and headers
+	std::string message;
+	message.append(method).append(" ").append(target).append(" HTTP/1.1\r\n");
+	message.append("Host: ").append(fHost);
+	if (fPort != 80) message.append(":").append(std::to_string(fPort));
+	message.append("\r\nUser-Agent: Casaubon User Agent\r\n");
+	message.append("Accept-Encoding: gzip, deflate\r\n");
+
+	// need to authenticate?
+	if (fAuthenticationScheme == kAuthenticationBasic) {
+		std::string credentials = Narrow(fUsername);
+		credentials.append(":").append(Narrow(fPassword));
+		message.append("Authorization: Basic ").append(Base64(credentials)).append("\r\n");
+		}
+
+	if (chunked)
+		message.append("Transfer-Encoding: chunked\r\n");
+
+	else if (length > 0 || rekwest.fData || buffered)
+		message.append("Content-Length: ").append(std::to_string(length)).append("\r\n");
+
+	message.append(headers).append("\r\n");
+
+	try {
+		// send request with any initial body data
+		fConnection.Send(message.data(), message.size());
+		if (chunked)
+			SendChunked(rekwest);
+
+		else if (buffered) {
+			fConnection.Send(whole.data(), whole.size());
+			length = 0;
+			}
+
+		else {
+			if (rekwest.fDataL > 0) fConnection.Send(rekwest.fData, rekwest.fDataL);
+			assert(length >= rekwest.fDataL);
+			length -= rekwest.fDataL;
+			}
+
+		// stream remainder of body
+		while (length > 0 && !chunked)
+			// ask user to push more data
+			rekwest.Data(
+				[this, &length](
+					const void	*data,
+					size_t		dataL
+					) {
+					// write the additional data through the connection
+					fConnection.Send(data, dataL);
+
+					// account
+					assert(length >= dataL);
+					length -= dataL;
+					}
+				);
+
+		// receive response; did a kept-alive connection turn out to have been closed?
+		if (!response.Receive(head)) {
+			if (!reused) throw "HTTP server closed connection without responding";
+			Disconnect();
+			rekwest.Rewind();
+			retry = true;
+			continue;
+			}
+		}
+
+	catch (const unsigned long error) {
+		Disconnect();
+
+		// retry once on a fresh connection if the server had dropped the kept-alive one
+		if (!reused || (error != EPIPE && error != ECONNRESET)) throw;
+		rekwest.Rewind();
+		retry = true;
+		continue;
+		}
+
+	switch (const unsigned status = response.fStatus) {
+		// *** not really sure how to properly handle all these different codes in terms of a function result
+		case 200:	// OK
+		case 201:	// Created
+		case 204:	// No Content
+		case 207:	// Multi-Status
+			break;
+
+		// redirected?  WinHTTP follows these on its own, so we do too; but only on the same server
+		case 301:
+		case 302:
+		case 307:
+		case 308: {
+			const std::string *const location = response.Find("location");
+			response.Finish();
+			if (!location || ++redirects > 8) throw status;
+
+			const std::wstring wideLocation = Widen(*location);
+
+			std::optional<std::string> redirected;
+			if (!Address::Crack(
+				wideLocation.c_str(),
+				[this, &redirected](std::wstring_view scheme, std::wstring_view host, unsigned short port, std::wstring_view path) {
+					if (scheme == L"http" && Narrow(host) == fHost && (port ? port : 80) == fPort)
+						redirected = Narrow(path);
+					}
+				))
+				redirected = *location;
+			if (!redirected) throw status;
+
+			target = std::move(*redirected);
+			retry = true;
+			break;
+			}
+
+		// need authentication?
+		case 401:	// Denied
+			response.Finish();
+			if (fAuthenticationScheme) throw status;	// can't log in even after authenticating
+
+			// the only scheme we know of
+			if (const std::string *const authenticate = response.Find("www-authenticate"); authenticate && strncasecmp(authenticate->c_str(), "Basic", 5) == 0)
+				fAuthenticationScheme = kAuthenticationBasic;
+
+			else
+				throw "unsupported authentication scheme";
+
+			retry = true;
+			break;
+
+		// server doesn't take a chunked request body?
+		case 411:	// Length Required
+		case 501:	// Not Implemented
+			response.Finish();
+			if (!chunked) throw status;
+
+			// send it whole from now on
+			fChunked = false;
+			retry = true;
+			break;
+
+		case 400:	// Bad Request
+		case 503:	// Service Unavailable
+		case 403:	// Forbidden (eg, sync-collection token no longer valid)
+		case 404:	// Not Found
+		case 405:	// Bad Method
+		case 409:	// Conflict
+		case 500:	// Server Error
+			response.Finish();
+			throw status;		// *** probably wrap this in an HTTP exception class
+
+		default:
+			// *** sometimes even an HTTP error will have a (useful) response body (eg, 415)
+			response.Finish();
+			throw status;
+		}
+
+	// must rewind the body data
+	if (retry) rekwest.Rewind();
+	} while (retry);
+
+// call back *** maybe skip it with 204 No Content
+try {
+	AcceptResponse(response);
+	}
+
+// can't tell where in the body the recipient left off
+catch (...) {
+	Disconnect();
+	throw;
+	}
+
+// consume whatever the recipient didn't, so the connection can be reused
+response.Finish();
+}
+
+
+/*	SendChunked
+	Send the request body in chunks as the user generates it [RFC 9112 §7.1]
+*/
+void CHTTPClient::SendChunked(
+	Rekwest		&rekwest
+	)
+{
+bool first = true;
+auto Chunk = [this, &first](const void *data, size_t dataL) {
+	// a chunk of nothing would end the body
+	if (dataL == 0) return;
+
+	// chunk size, after the end of the previous chunk
+	char size[24];
+	fConnection.Send(size, snprintf(size, sizeof size, &"\r\n%zx\r\n"[first ? 2 : 0], dataL));
+	fConnection.Send(data, dataL);
+	first = false;
+	};
+
+Chunk(rekwest.fData, rekwest.fDataL);
+for (bool pushed = true; pushed; ) {
+	pushed = false;
+	rekwest.Data([&Chunk, &pushed](const void *data, size_t dataL) { Chunk(data, dataL); pushed |= dataL > 0; });
+	}
+
+// last chunk, and no trailer
+fConnection.Send(&"\r\n0\r\n\r\n"[first ? 2 : 0], first ? 5 : 7);
+}
+
+
+
+/*
+
+	CHTTPClient::StreamRekwest
+
+*/
+
+/*	Data
+	Have the user write the body, and pass it on converted as it's written
+*/
+void CHTTPClient::StreamRekwest::Data(
+	const std::function<void (const void*, size_t)> &push
+	)
+{
+// it all goes the first time
+if (fSent) return;
+fSent = true;
+
+// a failure to send may well be swallowed by the user's stream; so remember it, and stop sending
+std::exception_ptr failure;
+const std::function<void (const void*, size_t)> sink = [&push, &failure](const void *data, size_t dataL) {
+	if (failure) return;
+	try { push(data, dataL); }
+	catch (...) { failure = std::current_exception(); throw; }
+	};
+
+aostreambuf<wchar_t, EncodingOutputAdapter<wchar_t>> osb(sink);
+fSender(osb);
+osb.pubsync();
+if (!failure) osb.adapter().narrow().drain(sink);
+
+if (failure) std::rethrow_exception(failure);
+}
+
+
+
+/*
+
+	CHTTPClient::Response
+
+*/
+
+/*	Receive
+	Receive the status line and headers; return false if the connection was closed before
+	anything was received
+*/
+bool CHTTPClient::Response::Receive(
+	bool		head
+	)
+{
+fHeaders.clear();
+fInflater.reset();
+
+std::string line;
+do {
+	// status line
+	if (!fClient.fConnection.ReceiveLine(line)) return false;
+
+	unsigned major, minor;
+	if (sscanf(line.c_str(), "HTTP/%u.%u %u", &major, &minor, &fStatus) != 3) throw "invalid HTTP status line";
+	fKeepAlive = major > 1 || (major == 1 && minor >= 1);
+
+	// header fields
+	while (fClient.fConnection.ReceiveLine(line) && !line.empty()) {
+		const size_t colon = line.find(':');
+		if (colon == std::string::npos) throw "invalid HTTP header field";
+
+		std::string name = line.substr(0, colon);
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+		const size_t valueB = line.find_first_not_of(" \t", colon + 1);
+		const size_t valueE = line.find_last_not_of(" \t");
+		fHeaders.emplace_back(std::move(name), valueB != std::string::npos ? line.substr(valueB, valueE + 1 - valueB) : std::string());
+		}
+
+	// skip interim responses
+	} while (fStatus >= 100 && fStatus < 200);
+
+if (const std::string *const connection = Find("connection"))
+	if (strcasecmp(connection->c_str(), "close") == 0)
+		fKeepAlive = false;
+
+// determine how the body is delimited (RFC 9112 §6.3)
+const std::string
+	*const transferEncoding = Find("transfer-encoding"),
+	*const contentLength = Find("content-length");
+if (head || fStatus == 204 || fStatus == 304)
+	fFraming = kFramingNone;
+
+else if (transferEncoding && strcasecmp(transferEncoding->c_str(), "identity") != 0) {
+	if (strcasecmp(transferEncoding->c_str(), "chunked") != 0) throw "unsupported transfer coding";
+	fFraming = kFramingChunked;
+	fRemaining = 0;
+	fChunkTerminated = false;
+	}
+
+else if (contentLength) {
+	fRemaining = std::stoull(*contentLength);
+	fFraming = fRemaining > 0 ? kFramingLength : kFramingNone;
+	}
+
+else {
+	fFraming = kFramingClose;
+	fKeepAlive = false;
+	}
+
+// decompress the body as it's read (RFC 9110 §8.4.1)
+if (const std::string *const contentEncoding = Find("content-encoding"); contentEncoding && fFraming != kFramingNone) {
+	Inflater::Format format;
+	if (strcasecmp(contentEncoding->c_str(), "gzip") == 0 || strcasecmp(contentEncoding->c_str(), "x-gzip") == 0)
+		format = Inflater::kFormatGzip;
+	else if (strcasecmp(contentEncoding->c_str(), "deflate") == 0)
+		format = Inflater::kFormatZlib;
+	else if (strcasecmp(contentEncoding->c_str(), "identity") == 0)
+		return true;
+	else
+		throw "unsupported content coding";
+
+	fInflater = std::make_unique<Inflater>(format, [this](void *buffer, size_t length) { return ReadEncoded(buffer, length); });
+	}
+
+return true;
+}
+
+
+/*	Find
+	Find the value of the response header with the given (lower-case) name
+*/
+const std::string *CHTTPClient::Response::Find(
+	std::string_view name
+	) const
+{
+const auto found = std::find_if(
+	fHeaders.begin(), fHeaders.end(),
+	[name](const std::pair<std::string, std::string> &header) { return header.first == name; }
+	);
+
+return found != fHeaders.end() ? &found->second : nullptr;
+}
+
+
+/*	Finish
+	Consume the remainder of the body; and leave the connection ready for the next request
+	(by whichever client checks it out of the pool next)
+*/
+void CHTTPClient::Response::Finish()
+{
+try {
+	// no need to decompress what nobody will look at
+	char discard[0x1000];
+	while (ReadEncoded(discard, sizeof discard) > 0);
+	}
+
+catch (...) {
+	fClient.Disconnect();
+	throw;
+	}
+
+// give the connection back for reuse if the server will keep it alive
+if (fKeepAlive)
+	fClient.Release();
+else
+	fClient.Disconnect();
+}
+
+
+/*	AvailableEncoded
+	Return the amount of body data, as sent, that can be read without waiting; waits if
+	there is none
+	Returns zero at the end of the body
+*/
+size_t CHTTPClient::Response::AvailableEncoded() const
+{
+switch (fFraming) {
+	case kFramingNone:
+		return 0;
+
+	case kFramingChunked:
+		// at the start of a chunk?
+		if (fRemaining == 0) {
+			std::string line;
+
+			// consume the CRLF that terminates the previous chunk's data
+			if (fChunkTerminated) {
+				if (!fClient.fConnection.ReceiveLine(line) || !line.empty()) throw "invalid HTTP chunk";
+				fChunkTerminated = false;
+				}
+
+			// chunk size, ignoring any extensions
+			if (!fClient.fConnection.ReceiveLine(line)) throw "HTTP server closed connection unexpectedly";
+			fRemaining = strtoull(line.c_str(), nullptr, 16);
+
+			// last chunk?  consume the trailer section
+			if (fRemaining == 0) {
+				while (fClient.fConnection.ReceiveLine(line) && !line.empty());
+				fFraming = kFramingNone;
+				return 0;
+				}
+
+			fChunkTerminated = true;
+			}
+		[[fallthrough]];
+
+	case kFramingLength:
+		if (fClient.fConnection.Buffered() == 0 && fClient.fConnection.Receive() == 0) throw "HTTP server closed connection unexpectedly";
+		return std::min(fClient.fConnection.Buffered(), fRemaining);
+
+	case kFramingClose:
+		if (fClient.fConnection.Buffered() == 0 && fClient.fConnection.Receive() == 0) {
+			fFraming = kFramingNone;
+			return 0;
+			}
+		return fClient.fConnection.Buffered();
+	}
+
+return 0;
+}
+
+
+/*	ReadEncoded
+	Read body data, as sent, into the given buffer; return the amount read, or zero at the
+	end of the body
+*/
+size_t CHTTPClient::Response::ReadEncoded(
+	void		*buffer,
+	size_t		length
+	) const
+{
+length = fClient.fConnection.Consume(buffer, std::min(length, AvailableEncoded()));
+
+// account
+if (fFraming == kFramingLength || fFraming == kFramingChunked) {
+	fRemaining -= length;
+	if (fFraming == kFramingLength && fRemaining == 0) fFraming = kFramingNone;
+	}
+
+return length;
+}
+
+
+/*	Content
+	Get the entire response body
+*/
+std::string CHTTPClient::Response::Content() const
+{
+std::string result;
+if (fFraming == kFramingLength && !fInflater) result.reserve(fRemaining);
+
+while (const size_t available = Available()) {
+	const size_t length = result.size();
+	result.resize(length + available);
+	result.resize(length + Read(result.data() + length, available));
+	}
+
+return result;
+}
+
+
+/*	GetLength
+	Get the length of a response header string
+*/
+unsigned CHTTPClient::Response::GetLength(
+	StandardHeader	header
+	) const {
+	switch (header) {
+		case kHeaderAllow:	return GetLength(L"Allow");
+		}
+
+	throw "unknown standard header";
+	}
+
+unsigned CHTTPClient::Response::GetLength(
+	const wchar_t	header[]
+	) const {
+	std::string name = Narrow(header);
+	std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+	const std::string *const value = Find(name);
+	if (!value) throw "HTTP response header not found";
+
+	return value->size();
+	}
+
+
+/*	Get
+	Get a response header string
+*/
+void CHTTPClient::Response::Get(
+	StandardHeader	header,
+	char		*const buffer,
+	const unsigned	bufferL
+	) const {
+	switch (header) {
+		case kHeaderAllow:	return Get(L"Allow", buffer, bufferL);
+		}
+
+	throw "unknown standard header";
+	}
+
+void CHTTPClient::Response::Get(
+	const wchar_t	header[],
+	char		*const buffer,
+	const unsigned	bufferL
+	) const {
+	std::string name = Narrow(header);
+	std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+	const std::string *const value = Find(name);
+	if (!value) throw "HTTP response header not found";
+	if (value->size() + 1 > bufferL) throw "insufficient buffer for HTTP response header";
+
+	(void) memcpy(buffer, value->c_str(), value->size() + 1);
+	}
+
+
+
+/*
+
+	CHTTPClient::InputAdapter
+
+*/
+
+/*	filter
+	Remove CRs; and unfold continuation lines, if so requested
+*/
+char *CHTTPClient::DecodingInputAdapter<char>::filter(
+	char		*begin,
+	char		*end,
+	const char	*limit
+	)
+{
+return fLines(begin, end, limit);
+}
+
+
+
+/*
+
+	CHTTPClient::OutputAdapter
+
+*/
+
+/*	filter
+	Process data to make it suitable for eviction
+*/
+char *CHTTPClient::EncodingOutputAdapter<char>::filter(
+	char		*begin,
+	char		*end,
+	const char	*limit
+	)
+{
+/* See the Win32 version */
+return LineFilter<char>::CRLF(begin, end, limit);
+}
@@ -0,0 +1,506 @@
+/*
+	HTTPClient
+
+	HTTP experimentation
+	POSIX
+
+	2023/06/10	Originated
+
+	Copyright © 2018-2023 by: Ben Hekster
+
+	Same interface as the Win32 transport, but implemented directly on non-blocking
+	BSD sockets; so that the DAV/WebDAV/CalDAV layers can be run (and profiled) on
+	hosts that don't have WinHTTP.
+
+	Only plain HTTP is spoken; there is no TLS.
+
+	Rather than each client owning its connection, clients check connections out of a
+	Pool for the duration of a request and return them afterwards if they can be kept alive.
+*/
+
+#pragma once
+
+#include <alloca.h>
+#include <signal.h>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../AdaptableStreamBuffer.h"
+#include "../Inflate.h"
+#include "../Transcode.h"
+
+
+/*	DebugBreak
+	The portable code uses this to mark unexpected conditions; on Win32 it comes in through <windows.h>
+	Only debug builds stop, as release builds (such as the daemon) must carry on past them
+*/
+#ifdef NDEBUG
+inline void DebugBreak() {}
+#else
+inline void DebugBreak() { (void) raise(SIGTRAP); }
+#endif
+
+
+
+/*	CHTTPClient
+	HTTP client session
+*/
+struct CHTTPClient {
+public:
+	/*	Address
+		Internet address to make request to
+	*/
+	struct Address {
+		friend CHTTPClient;
+
+		bool		fSecure;
+		const wchar_t	*fHost;
+		unsigned short	fPort;
+
+				Address(bool secure, const wchar_t host[], unsigned short port);
+
+		static bool	Crack(
+					const wchar_t	url[],
+					const std::function<void (std::wstring_view scheme, std::wstring_view host, unsigned short port, std::wstring_view path)>&
+					);
+		};
+
+
+	/*	Header
+		Header to add to request
+	*/
+	struct Header {
+		const wchar_t	*const fName,
+				*const fValue;
+		};
+
+
+	/*	Request
+		Represent body to HTTP request
+
+		See the Win32 version for the rationale
+	*/
+	struct Rekwest {
+		friend CHTTPClient;
+
+	protected:
+		// data immediately available
+		const void	*fData;
+		size_t		fDataL;
+
+		/* Specifically not 'const' since computing the length may trigger generation of body data.
+		   If it's kLengthUnknown, Data() is called until it pushes nothing more. */
+		virtual size_t	Length() { return fDataL; }
+		virtual void	Data(const std::function<void (const void*, size_t)>&) {};
+		virtual void	Rewind() {};
+
+	public:
+		// body is sent in chunks as it's generated [RFC 9112 §7.1]
+		static constexpr size_t kLengthUnknown = static_cast<size_t>(-1);
+
+				Rekwest(const void *data, size_t dataL) : fData(data), fDataL(dataL) {}
+				Rekwest() : fData(nullptr), fDataL(0) {}
+		virtual		~Rekwest() = default;
+		};
+
+
+	/*	GatherRekwest
+		Request body that's in segments, such as a costreambuf; sent one after the other,
+		without ever putting them together
+	*/
+	template <class Segmented>
+	struct GatherRekwest : Rekwest {
+	protected:
+		const Segmented	&fSegments;
+
+		size_t		Length() override { return fSegments.size(); }
+		void		Data(const std::function<void (const void*, size_t)> &push) override {
+					// all but the first, which went as the immediately available data
+					bool first = true;
+					fSegments.segments([&](const char *data, size_t dataL) { if (!first && dataL > 0) push(data, dataL); first = false; });
+					}
+
+	public:
+		explicit	GatherRekwest(const Segmented &segments) : fSegments(segments) {
+					// there's always a first segment, so even an empty body has a 'Content-Length'
+					segments.segments([this](const char *data, size_t dataL) { if (!fData) fData = data, fDataL = dataL; });
+					}
+		};
+
+
+	/*	StreamRekwest
+		Request body that's written by the given function, converted and sent as it's written
+		The function is called again if the request has to be repeated, and must then write
+		the same body again
+	*/
+	struct StreamRekwest : Rekwest {
+	protected:
+		const std::function<void (std::wstreambuf&)> &fSender;
+		bool		fSent;
+
+		size_t		Length() override { return kLengthUnknown; }
+		void		Data(const std::function<void (const void*, size_t)>&) override;
+		void		Rewind() override { fSent = false; }
+
+	public:
+		explicit	StreamRekwest(const std::function<void (std::wstreambuf&)> &sender) : fSender(sender), fSent(false) {}
+		};
+
+
+	/*	Response
+		Response to HTTP request
+
+		Reading the body changes the state of the connection, not of the response as the
+		caller sees it; hence the 'mutable' framing state.  A body with a 'gzip' or 'deflate'
+		content coding is decompressed as it's read, so callers only ever see the content.
+	*/
+	struct Response {
+		friend CHTTPClient;
+		friend struct InputAdapter;
+
+		enum StandardHeader {
+			kHeaderAllow
+			};
+
+		static constexpr wchar_t kHeaderDAV[] = L"DAV";
+
+	protected:
+		enum Framing {
+			kFramingNone,				// no (more) body
+			kFramingLength,				// Content-Length bytes
+			kFramingChunked,			// chunked transfer coding
+			kFramingClose				// until the server closes the connection
+			};
+
+		CHTTPClient	&fClient;
+		unsigned	fStatus;
+		std::vector<std::pair<std::string, std::string>> fHeaders;	// names in lower case
+		bool		fKeepAlive;
+		mutable Framing	fFraming;
+		mutable size_t	fRemaining;		// in body (length) or current chunk (chunked)
+		mutable bool	fChunkTerminated;	// CRLF following chunk data still to be read
+		std::unique_ptr<Inflater> fInflater;	// decompresses the body, if it has a content coding
+
+
+		explicit	Response(CHTTPClient&);
+
+		bool		Receive(bool head);
+		const std::string *Find(std::string_view name) const;
+		void		Finish();
+
+		size_t		AvailableEncoded() const;
+		size_t		ReadEncoded(void *buffer, size_t length) const;
+		size_t		Available() const { return fInflater ? fInflater->Available() : AvailableEncoded(); }
+		size_t		Read(void *buffer, size_t length) const { return fInflater ? fInflater->Read(buffer, length) : ReadEncoded(buffer, length); }
+
+	public:
+		std::string	Content() const;
+		size_t		Receive(void *buffer, size_t length) const { return Read(buffer, length); }
+		unsigned	GetLength(StandardHeader) const,
+				GetLength(const wchar_t header[]) const;
+		void		Get(StandardHeader header, char *buffer, unsigned bufferL) const,
+				Get(const wchar_t header[], char *buffer, unsigned bufferL) const;
+		};
+
+
+	/*	InputAdapter
+		Stream buffer adapter to be used with aistream/aostream
+	*/
+	struct InputAdapter;
+
+
+	/*	InputAdapter
+		Stream buffer adapters to be used with aistream/aostream
+
+		These perform CR/LF conversion and wide character conversion; 'wchar_t' is assumed
+		to hold UTF-32 (or UTF-16 where it's only two bytes)
+	*/
+	template <typename Char>
+	struct DecodingInputAdapter;
+
+
+	/*	OutputAdapter
+		Stream buffer adapter to abstract over HTTP peculiarities
+	*/
+	template <typename Char>
+	struct EncodingOutputAdapter;
+
+
+	/*	Connection
+		Connected socket, together with whatever has been received on it but not yet consumed
+	*/
+	struct Connection {
+	protected:
+		static constexpr size_t kReceiveBufferSize = 0x4000;
+		static constexpr int kTimeout = 30000;	// milliseconds
+
+		int		fSocket;
+		std::unique_ptr<char[]> fReceive;
+		size_t		fReceiveBegin,
+				fReceiveEnd;
+
+	public:
+				Connection() : fSocket(-1), fReceiveBegin(0), fReceiveEnd(0) {}
+				Connection(const std::string &host, unsigned short port);
+				Connection(Connection&&);
+				~Connection() { Close(); }
+
+		Connection	&operator=(Connection&&);
+		explicit operator bool() const { return fSocket >= 0; }
+
+		void		Close();
+		bool		Healthy() const;
+
+		void		Await(short events) const;
+		void		Send(const void*, size_t);
+		size_t		Receive();
+		bool		ReceiveLine(std::string&);
+		size_t		Buffered() const { return fReceiveEnd - fReceiveBegin; }
+		size_t		Consume(void*, size_t);
+		};
+
+
+	/*	Pool
+		Idle keep-alive connections, shared between clients to the same server
+	*/
+	struct Pool;
+
+protected:
+	enum AuthenticationScheme {
+		kAuthenticationNone,
+		kAuthenticationBasic
+		};
+
+	Pool		&fPool;
+	std::string	fHost;
+	unsigned short	fPort;
+	bool		fSecure;
+	Connection	fConnection;
+	AuthenticationScheme fAuthenticationScheme;
+	bool		fChunked;			// server takes request bodies in chunks, as far as we know
+	const wchar_t	*fUsername,
+			*fPassword;
+
+	bool		Connect();
+	void		Disconnect() { fConnection.Close(); }
+	void		Release();
+	void		SendChunked(Rekwest&);
+
+public:
+			CHTTPClient(const Address&, const wchar_t username[], const wchar_t password[]);
+			CHTTPClient(Pool&, const Address&, const wchar_t username[], const wchar_t password[]);
+	explicit	CHTTPClient(const CHTTPClient&);
+			CHTTPClient(CHTTPClient&&);
+			~CHTTPClient();
+
+	void		Request(
+				const wchar_t	path[],
+				const wchar_t	verb[],
+				const std::function<void (const std::function<void (const wchar_t*, const wchar_t*)>&)> &Headers,
+				Rekwest&&,
+				const std::function<void (Response&)>&
+				);
+	};
+
+
+
+/*
+
+	CHTTPClient::Pool
+
+	The limits are fixed when the pool is constructed; clients that want others are given a
+	Pool of their own rather than the Default one.
+
+*/
+
+struct CHTTPClient::Pool {
+public:
+	struct Options {
+		unsigned	fMaxIdle = 4;			// most idle connections kept per server
+		std::chrono::seconds fIdleTimeout { 30 };	// how long a connection is kept idle
+		};
+	
+	/*	Key
+		Connections are interchangeable when they go to the same scheme, host and port
+	*/
+	struct Key {
+		bool		fSecure;
+		std::string	fHost;
+		unsigned short	fPort;
+
+		auto		operator<=>(const Key&) const = default;
+		};
+
+protected:
+	struct Idle {
+		Connection	fConnection;
+		std::chrono::steady_clock::time_point fSince;
+		};
+
+	const Options	fOptions;
+	std::mutex	fMutex;
+	std::map<Key, std::deque<Idle>> fIdle;
+
+	void		Evict(std::chrono::steady_clock::time_point now);
+
+public:
+			Pool();
+	explicit	Pool(const Options&);
+			Pool(const Pool&) = delete;
+
+	Connection	CheckOut(const Key&);
+	void		Return(const Key&, Connection&&);
+	size_t		Kept();
+
+	static Pool	&Default();
+	};
+
+
+
+/*
+
+	CHTTPClient::InputAdapter
+
+*/
+
+struct CHTTPClient::InputAdapter {
+protected:
+	CHTTPClient::Response &fResponse;
+
+public:
+			InputAdapter(CHTTPClient::Response &response) :
+				fResponse(response)
+				{}
+
+	size_t		available() { return fResponse.Available(); }
+	size_t		house(char *buffer, size_t bufferL) { return fResponse.Read(buffer, bufferL); }
+	};
+
+
+
+/*
+
+	CHTTPClient::DecodingInputAdapter<char>
+
+*/
+
+template<>
+struct CHTTPClient::DecodingInputAdapter<char> : public CHTTPClient::InputAdapter {
+protected:
+	LineFilter<char> fLines;
+
+public:
+	// fraction of buffer space that may be needed to properly filter some amount of input:
+	static constexpr unsigned
+			kOverflowNumerator = 1,
+			kOverflowDenominator = 1;
+
+
+			DecodingInputAdapter(CHTTPClient::Response &response) :
+				CHTTPClient::InputAdapter(response)
+				{}
+
+	// also unfold continuation lines [RFC5545 §3.1]
+	void		unfold() { fLines.unfold(); }
+
+	char		*filter(char *begin, char *end, const char *limit);
+	};
+
+
+
+/*
+
+	CHTTPClient::DecodingInputAdapter<wchar_t>
+
+*/
+
+template<>
+struct CHTTPClient::DecodingInputAdapter<wchar_t> : public UTF8DecodingAdapter<ristreambuf<char, DecodingInputAdapter<char>>> {
+public:
+			DecodingInputAdapter(CHTTPClient::Response &response) :
+				UTF8DecodingAdapter(response)
+				{}
+	};
+
+
+
+/*
+
+	CHTTPClient::EncodingOutputAdapter<char>
+
+*/
+
+template<>
+struct CHTTPClient::EncodingOutputAdapter<char> {
+public:
+	// fraction of buffer space that may be needed to properly filter some amount of output
+	/* Twice as much, for a CR before every LF */
+	static constexpr unsigned
+			kOverflowNumerator = 2,
+			kOverflowDenominator = 1;
+
+
+			EncodingOutputAdapter()	{}
+
+	size_t		evict(const char*, size_t) { return 0; }
+	char		*filter(char *begin, char *end, const char *limit);
+	};
+
+
+
+/*
+
+	CHTTPClient::EncodingOutputAdapter<wchar_t>
+
+*/
+
+template<>
+struct CHTTPClient::EncodingOutputAdapter<wchar_t> : public UTF8EncodingAdapter<costreambuf<char, EncodingOutputAdapter<char>>> {
+public:
+			EncodingOutputAdapter() {}
+	explicit	EncodingOutputAdapter(const std::function<void (const void*, size_t)> &sink) : UTF8EncodingAdapter(sink) {}
+	};
+
+
+
+/*	Address
+	Represent the Internet address of a server
+	If 'port' is zero, the well-known default is assumed
+*/
+inline CHTTPClient::Address::Address(
+	bool		secure,
+	const wchar_t	host[],
+	unsigned short	port
+	) :
+	fSecure(secure),
+	fHost(host),
+	fPort(
+		port != 0 ? port :
+		secure ? 443 : 80
+		)
+	{}
+
+
+/*	Response
+	Represent the response to an HTTP request
+*/
+inline CHTTPClient::Response::Response(
+	CHTTPClient	&client
+	) :
+	fClient(client),
+	fStatus(0),
+	fKeepAlive(false),
+	fFraming(kFramingNone),
+	fRemaining(0),
+	fChunkTerminated(false)
+	{}
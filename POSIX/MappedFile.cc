@@ -0,0 +1,75 @@
+/*
+	MappedFile
+	
+	Read-only view of a whole file
+	POSIX
+	
+	2023/10/11	Originated
+	
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <filesystem>
+
+#include "MappedFile.h"
+
+
+
+/*	MappedFile
+	Map the named file
+	The mapping outlives the descriptor, so that isn't kept.
+*/
+MappedFile::MappedFile(
+	const wchar_t	path[]
+	) :
+	fContents(nullptr),
+	fContentsL(0)
+{
+const int file = open(std::filesystem::path(path).c_str(), O_RDONLY | O_CLOEXEC);
+if (file < 0) throw static_cast<unsigned long>(errno);
+
+struct stat status;
+if (fstat(file, &status) != 0) {
+	const int error = errno;
+	close(file);
+	throw static_cast<unsigned long>(error);
+	}
+if (static_cast<unsigned long long>(status.st_size) > SIZE_MAX) {
+	close(file);
+	throw "file too large to map";
+	}
+
+// can't map an empty file
+if (status.st_size > 0) {
+	void *const contents = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	if (contents == MAP_FAILED) {
+		const int error = errno;
+		close(file);
+		throw static_cast<unsigned long>(error);
+		}
+	
+	// it'll be read from start to end
+	madvise(contents, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+	
+	fContents = static_cast<const char*>(contents);
+	fContentsL = static_cast<size_t>(status.st_size);
+	}
+
+close(file);
+}
+
+
+/*	~MappedFile
+	Unmap the file
+*/
+MappedFile::~MappedFile()
+{
+if (fContents) munmap(const_cast<char*>(fContents), fContentsL);
+}
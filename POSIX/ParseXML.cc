@@ -0,0 +1,51 @@
+/*
+	ParseXML
+	
+	Event-Driven XML Parser
+	POSIX
+	
+	2023/06/14	Originated
+	
+	Copyright © 2018-2023 by: Ben Hekster
+*/
+
+#include "ParseXML.h"
+
+
+
+/*	()
+	Parse
+*/
+template <class Events>
+void XMLParser<Events>::operator()(
+	const Data	data
+	)
+{
+XMLTokenizer<Events> tokenizer(fCallback);
+tokenizer(data.data(), data.size());
+tokenizer.End();
+}
+
+
+/*	()
+	Parse as the data is received, rather than after all of it has been
+*/
+template <class Events>
+void XMLParser<Events>::operator()(
+	const Receiver	&Receive
+	)
+{
+XMLTokenizer<Events> tokenizer(fCallback);
+
+char buffer[0x4000];
+while (const size_t received = Receive(buffer, sizeof buffer))
+	tokenizer(buffer, received);
+
+tokenizer.End();
+}
+
+
+// explicit instantiation
+#include "../ParseXMLStates.h"
+template struct XMLParser<StateParser>;
+template struct XMLParser<StateMachine>;
@@ -0,0 +1,56 @@
+/*
+	ParseXML
+	
+	Event-Driven XML Parser
+	POSIX
+	
+	2023/06/14	Originated
+	
+	Copyright © 2018-2023 by: Ben Hekster
+*/
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "../XMLTokenizer.h"
+
+
+/*	XMLParser
+	Same interface as the Win32 parser, on top of the portable tokenizer
+*/
+template <class Events>
+struct XMLParser {
+public:
+	using Data = std::string_view;
+	using Receiver = std::function<size_t (void *buffer, size_t bufferL)>;	// returns zero at the end
+	using Literal = const char*;
+	using String = std::string_view;				// UTF-8, only valid for the duration of the event
+	using Attributes = const std::map<std::string, std::string>&;
+
+
+	/*	StringRep
+		Concrete access to string
+	*/
+	struct StringRep {
+	protected:
+		const std::string_view fString;
+
+	public:
+				StringRep(const std::string_view string) : fString(string) {}
+
+		bool		operator==(const char s[]) { return fString == s; }
+		};
+
+protected:
+	Events		&fCallback;
+
+public:
+	explicit	XMLParser(Events &callback) : fCallback(callback) {}
+
+	void		operator()(const Data),
+			operator()(const Receiver&);
+	};
@@ -25,11 +25,41 @@ StateParser::StateParser(
 	fDocument(document),
 	fState(nullptr),
 	fInner(0),
-	fResponse(&response)
+	fResponse(&response),
+	fDepth(0)
 {
 }
 
 
+/*	Index::()
+	Return the transition to take for the element
+*/
+size_t StateParser::State::Index::operator()(
+	const Transition forward[],
+	const std::string_view name
+	) const
+{
+// hashed?
+if (fMultiplier) {
+	const unsigned char transition = fSlots[Slot(name)];
+	return transition != fOther && XMLParser<StateParser>::StringRep(name) == forward[transition].fElement ? transition : fOther;
+	}
+
+// for each possible transition out
+size_t transition = 0;
+for (; forward[transition].fState; transition++)
+	if (
+		// matches anything?
+		forward[transition].fElement[0] == '\0' ||
+		
+		// matches?
+		XMLParser<StateParser>::StringRep(name) == forward[transition].fElement
+		) break;
+
+return transition;
+}
+
+
 /*	StartDocument
 	Started parsing an XML document
 */
@@ -69,15 +99,7 @@ Response *forwardResponse = nullptr;
 // still recognizing states?
 if (fInner == 0)
 	if (const State::Transition *forward = fState->fForward) {
-		// for each possible transition out *** std::find
-		for (; forward->fState; forward++)
-			if (
-				// matches anything?
-				forward->fElement[0] == '\0' ||
-				
-				// matches?
-				XMLParser<StateParser>::StringRep(name) == forward->fElement
-				) break;
+		forward += fState->fIndex(forward, name);
 		
 		// next state, or nullptr for unrecognized element
 		forwardState = forward->fState;
@@ -88,8 +110,13 @@ if (fInner == 0)
 
 // recognized transition?
 if (forwardState) {
-	fStack.push(fState);
-	fResponsesStack.push(fResponse);
+	const Frame frame { fState, fResponse };
+	if (fDepth < kFrames)
+		fFrames[fDepth] = frame;
+	else
+		fDeeper.push_back(frame);
+	fDepth++;
+	
 	fState = forwardState;
 	fResponse = forwardResponse;
 	
@@ -117,8 +144,17 @@ if (fInner == 0) {
 	if (void (Response::*End)() = fState->FEnd) (fResponse->*End)();
 	
 	// transition back to parent state
-	fState = fStack.top(); fStack.pop();
-	fResponse = fResponsesStack.top(); fResponsesStack.pop();
+	assert(fDepth > 0);
+	Frame frame;
+	if (--fDepth < kFrames)
+		frame = fFrames[fDepth];
+	else {
+		frame = fDeeper.back();
+		fDeeper.pop_back();
+		}
+	
+	fState = frame.fState;
+	fResponse = frame.fResponse;
 	}
 
 else
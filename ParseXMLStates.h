@@ -12,11 +12,18 @@
 
 #pragma once
 
-#include <stack>
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <variant>
 
 #include "ParseXML.h"
+#include "String.h"
 
 
 
@@ -56,14 +63,66 @@ public:
 			unsigned	fResponseOffset;
 			};
 		
+		
+		/*	Index
+			Perfect hash of the element names of the transitions, worked out at compile time
+			
+			The hash only looks at the length and three characters of the name, so finding the
+			transition takes one multiplication and one comparison however many there are.
+			Falls back to trying each transition in turn if no perfect hash can be found.
+		*/
+		struct Index {
+			static constexpr unsigned kSlotsBits = 6;
+			
+			uint32_t	fMultiplier;			// zero if not hashed
+			unsigned char	fShift,
+					fOther,				// transition for any other element (wildcard or end)
+					fSlots[1 << kSlotsBits];	// transition for each hash
+			
+			static constexpr uint32_t Key(std::string_view name) {
+				return name.empty() ? 0 :
+					static_cast<uint32_t>(name.size()) ^
+					static_cast<uint32_t>(static_cast<unsigned char>(name.front())) << 8 ^
+					static_cast<uint32_t>(static_cast<unsigned char>(name[name.size() / 2])) << 16 ^
+					static_cast<uint32_t>(static_cast<unsigned char>(name.back())) << 24;
+				}
+			
+			constexpr unsigned Slot(std::string_view name) const { return Key(name) * fMultiplier >> fShift; }
+			
+			constexpr	Index(const Transition[]);
+			
+			size_t		operator()(const Transition[], std::string_view name) const;
+			};
+		
 		const Transition *fForward;
 		
 		// callbacks
 		void		(Response::*FStart)(const XMLParser<StateParser>::String),
 				(Response::*FEnd)(),
 				(Response::*FCharacters)(const XMLParser<StateParser>::String);
+		
+		Index		fIndex;
+		
+		
+		constexpr	State(
+					const Transition *forward = nullptr,
+					void (Response::*start)(const XMLParser<StateParser>::String) = nullptr,
+					void (Response::*end)() = nullptr,
+					void (Response::*characters)(const XMLParser<StateParser>::String) = nullptr
+					) :
+					fForward(forward),
+					FStart(start),
+					FEnd(end),
+					FCharacters(characters),
+					fIndex(forward)
+					{}
 		};
 	
+	/* Enough frames for the states that WebDAV::Basic builds, which checks that its state graph fits */
+	static constexpr unsigned kFrames = 16;
+	
+	static constexpr unsigned Depth(const State&, unsigned limit = kFrames + 1);
+	
 	void		StartDocument();
 	void		EndDocument();
 	void		StartElement(const XMLParser<StateParser>::String namespaceURI, const XMLParser<StateParser>::String name, XMLParser<StateParser>::Attributes attributes);
@@ -71,14 +130,269 @@ public:
 	void		Characters(const XMLParser<StateParser>::String);
 
 protected:
+	// state to return to at the end of an element
+	struct Frame {
+		const State	*fState;
+		Response	*fResponse;
+		};
+	
 	const State	&fDocument;
 	const State	*fState;
-	std::stack<const State*> fStack;
-	std::stack<Response*> fResponsesStack;
 	unsigned	fInner;
 	Response	*fResponse;
+	
+	unsigned	fDepth;				// number of frames
+	Frame		fFrames[kFrames];
+	std::vector<Frame> fDeeper;			// frames beyond those, for unexpectedly deep documents
 
 public:
 	explicit	StateParser(const State &document, Response&);
 			StateParser(const StateParser&) = delete;
 	};
+
+
+
+
+/*	StateMachine
+	Parse events, as taken by a state graph that has been compiled into code
+	
+	Each compiled graph is its own type; the tokenizer only needs to be built for this one,
+	at the cost of a virtual call per event.
+*/
+struct StateMachine {
+	virtual void	StartDocument() = 0;
+	virtual void	EndDocument() = 0;
+	virtual void	StartElement(const XMLParser<StateParser>::String namespaceURI, const XMLParser<StateParser>::String name, XMLParser<StateParser>::Attributes attributes) = 0;
+	virtual void	EndElement(const XMLParser<StateParser>::String namespaceURI, const XMLParser<StateParser>::String name) = 0;
+	virtual void	Characters(const XMLParser<StateParser>::String) = 0;
+	};
+
+
+/*	CompiledStateParser
+	Parse by the same states as StateParser; but with the state graph turned into code
+	
+	Every state in the graph becomes a node with its own number, parent, and offset of its
+	response from the document's (a state reachable along several paths becomes as many
+	nodes).  Handling an event is then a switch on the current node, with everything else
+	known at compile time: there's no stack, and the callbacks are called directly.
+	
+	Can't be used for recursive state graphs.
+*/
+template <const StateParser::State &document>
+struct CompiledStateParser final : public StateMachine {
+protected:
+	using State = StateParser::State;
+	using Response = StateParser::Response;
+	using String = XMLParser<StateParser>::String;
+	
+	static_assert(StateParser::Depth(document) <= StateParser::kFrames, "can't compile recursive states");
+	
+	struct Node {
+		const State	*fState;
+		unsigned	fParent,
+				fForward,			// node of the first transition
+				fForwardN,			// number of transitions
+				fOffset;			// of the response
+		};
+	
+	/*	Count
+		Number of nodes in the graph from the given state
+	*/
+	static constexpr unsigned Count(const State &state) {
+		unsigned count = 1;
+		if (state.fForward)
+			for (const State::Transition *forward = state.fForward; forward->fState; forward++)
+				count += Count(*forward->fState);
+		return count;
+		}
+	
+	static constexpr unsigned kNodesN = Count(document);
+	
+	// the graph, breadth first so that the nodes of the transitions out of a state are consecutive
+	static constexpr std::array<Node, kNodesN> gNodes = []() {
+			std::array<Node, kNodesN> result {};
+			result[0] = Node { &document, 0, 0, 0, 0 };
+			
+			for (unsigned node = 0, next = 1; node < next; node++) {
+				result[node].fForward = next;
+				if (const State::Transition *forward = result[node].fState->fForward)
+					for (; forward->fState; forward++)
+						result[next++] = Node { forward->fState, node, 0, 0, result[node].fOffset + forward->fResponseOffset };
+				result[node].fForwardN = next - result[node].fForward;
+				}
+			
+			return result;
+			}();
+	
+	Response	&fDocument;
+	unsigned	fNode,					// current state
+			fInner;					// depth inside unrecognized elements
+	
+	
+	template <unsigned N>
+	Response	&At() const { return *reinterpret_cast<Response*>(reinterpret_cast<char*>(&fDocument) + gNodes[N].fOffset); }
+	
+	
+	/*	Dispatch
+		Call the handler template for the current node
+	*/
+	template <typename Handler>
+	void		Dispatch(const Handler &H) {
+				[&]<unsigned... N>(std::integer_sequence<unsigned, N...>) {
+					(void) ((fNode == N && (H.template operator()<N>(), true)) || ...);
+					}(std::make_integer_sequence<unsigned, kNodesN>());
+				}
+	
+	
+	/*	Start
+		Take the transition out of node N for the element, if there is one
+	*/
+	template <unsigned N>
+	void		Start(const String name) {
+				constexpr const State &state = *gNodes[N].fState;
+				
+				if constexpr (state.fForward == nullptr)
+					fInner++;
+				
+				else {
+					const size_t transition = state.fIndex(state.fForward, name);
+					
+					// to which node?
+					if (!state.fForward[transition].fState)
+						fInner++;
+					
+					else
+						[&]<unsigned... T>(std::integer_sequence<unsigned, T...>) {
+							(void) ((transition == T && (Enter<gNodes[N].fForward + T>(name), true)) || ...);
+							}(std::make_integer_sequence<unsigned, gNodes[N].fForwardN>());
+					}
+				}
+	
+	template <unsigned N>
+	void		Enter(const String name) {
+				fNode = N;
+				if constexpr (constexpr auto F = gNodes[N].fState->FStart; F != nullptr) (At<N>().*F)(name);
+				}
+	
+	template <unsigned N>
+	void		End() {
+				if constexpr (constexpr auto F = gNodes[N].fState->FEnd; F != nullptr) (At<N>().*F)();
+				fNode = gNodes[N].fParent;
+				}
+	
+	template <unsigned N>
+	void		Text(const String text) {
+				if constexpr (constexpr auto F = gNodes[N].fState->FCharacters; F != nullptr) (At<N>().*F)(text);
+				}
+
+public:
+	explicit	CompiledStateParser(Response &response) : fDocument(response), fNode(0), fInner(0) {}
+			CompiledStateParser(const CompiledStateParser&) = delete;
+	
+	void		StartDocument() override { fNode = 0; fInner = 0; }
+	void		EndDocument() override { assert(fNode == 0 && fInner == 0); }
+	
+	void		StartElement(const String, const String name, XMLParser<StateParser>::Attributes) override {
+				if (fInner) fInner++;
+				else Dispatch([&]<unsigned N>() { Start<N>(name); });
+				}
+	
+	void		EndElement(const String, const String) override {
+				if (fInner) fInner--;
+				else Dispatch([&]<unsigned N>() { End<N>(); });
+				}
+	
+	void		Characters(const String text) override {
+				if (!fInner) Dispatch([&]<unsigned N>() { Text<N>(text); });
+				}
+	};
+
+
+/*	Index
+	Find a multiplier that hashes the element names of the transitions into distinct slots
+*/
+constexpr StateParser::State::Index::Index(
+	const Transition forward[]
+	) :
+	fMultiplier(0),
+	fShift(0),
+	fOther(0),
+	fSlots {}
+{
+if (!forward) return;
+
+// transitions up to the first that matches anything
+unsigned transitionsN = 0;
+while (forward[transitionsN].fState && forward[transitionsN].fElement[0] != '\0') transitionsN++;
+fOther = static_cast<unsigned char>(transitionsN);
+
+// not worth hashing?  or too many to?
+if (transitionsN < 2 || 2 * transitionsN > (1u << kSlotsBits)) return;
+
+// start with a table twice as large as necessary, and make it larger if that doesn't work out
+unsigned bits = 1;
+while ((1u << bits) < 2 * transitionsN) bits++;
+
+for (; bits <= kSlotsBits; bits++)
+	for (uint32_t multiplier = 0x9E3779B1; multiplier != 0x9E3779B1 + 2 * 64; multiplier += 2) {
+		fMultiplier = multiplier;
+		fShift = static_cast<unsigned char>(32 - bits);
+		for (unsigned char &slot: fSlots) slot = fOther;
+		
+		bool perfect = true;
+		for (unsigned i = 0; perfect && i < transitionsN; i++) {
+			unsigned char &slot = fSlots[Slot(forward[i].fElement)];
+			
+			// an element that occurs more than once goes to the first transition
+			if (slot != fOther)
+				perfect = std::string_view(forward[slot].fElement) == forward[i].fElement;
+			
+			else
+				slot = static_cast<unsigned char>(i);
+			}
+		
+		if (perfect) return;
+		}
+
+// no luck
+fMultiplier = 0;
+}
+
+
+/*	Depth
+	Return the largest number of frames the parser may need for the states reachable from
+	the given one, up to the limit (which recursive states will reach)
+*/
+constexpr unsigned StateParser::Depth(
+	const State	&state,
+	const unsigned	limit
+	)
+{
+unsigned depth = 0;
+
+if (limit > 0 && state.fForward)
+	for (const State::Transition *forward = state.fForward; forward->fState && depth <= limit; forward++)
+		depth = std::max(depth, 1 + Depth(*forward->fState, limit - 1));
+
+return depth;
+}
+
+
+/*	Deliver
+	Pass parsed text on to a callback
+	
+	The text is UTF-8, straight from the response; it's only converted to wide characters if
+	the callback can't take it as it is.
+*/
+template <typename Callable>
+inline void Deliver(
+	Callable	&F,
+	const std::string_view text
+	)
+{
+if constexpr (std::is_invocable_v<Callable&, std::string_view>)
+	F(text);
+
+else
+	F(Widen(text).c_str());
+}
\ No newline at end of file
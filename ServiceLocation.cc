@@ -5,7 +5,7 @@
 	
 	2019/04/18	Originated
 	
-	Copyright  2019 by: Ben Hekster
+	Copyright © 2019 by: Ben Hekster
 
 	RFC 2782	A DNS RR for Specifying the Location of Services (DNS SRV)
 	RFC 5785	Defining Well-Known Uniform Resource Identifiers (URIs)
@@ -34,7 +34,7 @@ void LocateService(
 FormatString(
 	L"_{}._{}.{}",
 	[&Instance, &Metadata](const wchar_t record[]) {
-		// locate service host address from SRV record [6.2]
+		// locate service host address from SRV record [§6.2]
 		CDNSClient().QuerySRV(
 			record,
 			[&Instance](const CDNSClient::SRV &srv) {
@@ -42,7 +42,7 @@ FormatString(
 				}
 			);
 		
-		// locate service context path from TXT record  [6.3]
+		// locate service context path from TXT record  [§6.3]
 		CDNSClient().QueryTXT(
 			record,
 			[&Metadata](const CDNSClient::TXT &txt) {
@@ -138,7 +138,7 @@ LocateService(
 		assert(result.has_value());
 		DAVServiceLocation &location = *result;
 		
-		// context path? [6.3]
+		// context path? [§6.3]
 		if (key == L"path")
 			location.fPath = value;
 		}
@@ -150,7 +150,7 @@ if (result) {
 	
 	// but didn't get context path through TXT?
 	/* RFC 6763 appears to dictate that TXT must be present if SRV is.  However, RFC 6764
-	   explicitly requires (4) the use of a 'well-known' URI when the TXT is absent.
+	   explicitly requires (§4) the use of a 'well-known' URI when the TXT is absent.
 	   This is in fact the mechanism that works for iCloud. */
 	if (result->fPath.empty())
 		result->fPath = gWellKnownContextPaths[service];
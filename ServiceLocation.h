@@ -10,7 +10,7 @@
 	
 	2019/04/18	Originated
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
 #pragma once
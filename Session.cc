@@ -6,15 +6,18 @@
 	2019/05/02	Originated
 	2023/05/21	Factored out session management
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
 #include <assert.h>
 
 #include <fstream>
+#include <sstream>
 #include <utility>
 
 #include "AdaptableStreamBuffer.h"
+#include "MappedFile.h"
+#include "Mirror.h"
 #include "Session.h"
 #include "String.h"
 #include "Synchronization.h"
@@ -22,46 +25,71 @@
 
 
 
-/*	wfopen_s
-	Like CRT _wfopen_s but returns result as function return; throws exception on failure
-	*** move this somewhere in Native
+/*	CalendarText
+	Return the text of a calendar file in native wide characters
+	
+	The file is UTF-16LE if it starts with that byte order mark, or if its second byte is NUL
+	(as the file's first character is bound to be ASCII); which on Windows can then be parsed
+	right where it's mapped, and elsewhere is widened into 'decoded'.  Otherwise, it's UTF-8
+	and decoded in one go into 'decoded'.
 */
-static FILE *wfopen_s(
-	const wchar_t	*const name,
-	const wchar_t	*const mode
+static std::wstring_view CalendarText(
+	std::string_view contents,
+	std::wstring	&decoded
 	)
 {
-FILE *result;
-
-// try to open file
-if (_wfopen_s(&result, name, mode) != 0) {
-	const static char prefix[] = "can't open file";
-	
-	// try to get system error message
-	char message[80 /* doesn't seem to be a way to determine this; this number used in documentation */];
-	static_assert(sizeof prefix - 1 < 94); // as per documentation
-	if (_strerror_s(message, sizeof message, prefix) == 0) {
-		// trim trailing '\n'
-		if (
-			const size_t messageL = strlen(message);
-			messageL > 0
-			)
-			/* Documentation claims the message will be NL-terminated; but I don't observe that in practice */
-			if (
-				char &last = message[messageL - 1];
-				last == '\n'
-				)
-				last = '\0';
+const bool
+	utf16BOM = contents.starts_with("\xFF\xFE"),
+	utf16 = utf16BOM || (contents.size() >= 2 && contents[1] == '\0');
+if (utf16) {
+	if (utf16BOM) contents.remove_prefix(2);
+	
+	if constexpr (sizeof(wchar_t) == 2)
+		return std::wstring_view(reinterpret_cast<const wchar_t*>(contents.data()), contents.size() / 2);
+	
+	else {
+		decoded.clear();
+		decoded.reserve(contents.size() / 2);
+		for (size_t i = 0; i + 1 < contents.size(); i += 2) {
+			const wchar_t unit = static_cast<unsigned char>(contents[i]) | static_cast<unsigned char>(contents[i + 1]) << 8;
+			
+			// low surrogate following a high one?
+			if (unit >= 0xDC00 && unit < 0xE000 && !decoded.empty() && decoded.back() >= 0xD800 && decoded.back() < 0xDC00)
+				decoded.back() = 0x10000 + ((decoded.back() - 0xD800) << 10) + (unit - 0xDC00);
+			
+			else
+				decoded.push_back(unit);
+			}
 		
-		throw std::runtime_error(message);
+		return decoded;
 		}
+	}
+
+if (contents.starts_with("\xEF\xBB\xBF")) contents.remove_prefix(3);
+decoded = Widen(contents);
+return decoded;
+}
+
+
+/*	CalendarUTF8
+	Return the text of a calendar file in UTF-8
 	
-	else
-		// just throw static message
-		throw prefix;
+	A UTF-8 file is parsed right where it's mapped, less any byte order mark; only a UTF-16
+	one has to be converted, by way of native wide characters into 'narrowed'.
+*/
+static std::string_view CalendarUTF8(
+	std::string_view contents,
+	std::string	&narrowed
+	)
+{
+if (contents.starts_with("\xFF\xFE") || (contents.size() >= 2 && contents[1] == '\0')) {
+	std::wstring decoded;
+	narrowed = Narrow(CalendarText(contents, decoded));
+	return narrowed;
 	}
 
-return result;
+if (contents.starts_with("\xEF\xBB\xBF")) contents.remove_prefix(3);
+return contents;
 }
 
 
@@ -108,46 +136,22 @@ void Session::Split(
 	const std::function<void (const CHTTPClient::Address&, const wchar_t path[])> &DifferentHost
 	)
 {
-// crack open the URL
-URL_COMPONENTS components;
-components.dwStructSize = sizeof components;
-components.lpszScheme = nullptr;		// return scheme inside URL string
-components.dwSchemeLength = ~0;
-components.lpszHostName = nullptr;		// return host name inside URL string
-components.dwHostNameLength = ~0;
-components.lpszUserName = nullptr;		// don't need user name (not expecting to use a different one)
-components.dwUserNameLength = 0;
-components.lpszPassword = nullptr;		// don't need password (not expecting to use a different one)
-components.dwPasswordLength = 0;
-components.lpszUrlPath = nullptr;		// return path inside URL string
-components.dwUrlPathLength = ~0;
-components.lpszExtraInfo = nullptr;		// don't think I need 'extra' information (query or anchor part of URL)
-components.dwExtraInfoLength = 0;
-BOOL success = WinHttpCrackUrl(url, 0 /* NUL-terminated */, 0 /* flags */, &components);
-
 std::wstring_view scheme, hostname, path;
 unsigned short port = 0;
 
-// able to crack the URL?
-if (success) {
-	if (components.lpszScheme) scheme = std::wstring_view(components.lpszScheme, components.dwSchemeLength);
-	if (components.lpszHostName) hostname = std::wstring_view(components.lpszHostName, components.dwHostNameLength);
-	if (components.lpszUrlPath) path = std::wstring_view(components.lpszUrlPath, components.dwUrlPathLength);
-	if (components.nPort) port = components.nPort;
-	}
-
-else
-	switch (const DWORD error = GetLastError()) {
-		// no scheme in URL?
-		case ERROR_WINHTTP_UNRECOGNIZED_SCHEME:
-			// then assume same host, and the string is just the path
-			// *** might not be true, perhaps the URL is a host and path
-			path = url;
-			break;
-		
-		default:
-			throw error;
+// crack open the URL
+if (!CHTTPClient::Address::Crack(
+	url,
+	[&](std::wstring_view urlScheme, std::wstring_view urlHostname, unsigned short urlPort, std::wstring_view urlPath) {
+		scheme = urlScheme;
+		hostname = urlHostname;
+		port = urlPort;
+		path = urlPath;
 		}
+	))
+	// no scheme in URL; then assume same host, and the string is just the path
+	// *** might not be true, perhaps the URL is a host and path
+	path = url;
 
 // no different hostname found?
 if (hostname.empty())
@@ -168,22 +172,92 @@ else
 
 /*	MakeFromServiceLocation
 	Create a CalDAV service session at the given (possibly service-located) server address
+	
+	If 'discovered' is given, what's learned along the way is recorded in it, so the session
+	can later be recreated by MakeFromDiscovery.
+	
+	All clients the session makes, to whichever server, keep their connections in 'pool'.
 */
 Session Session::MakeFromServiceLocation(
+	CHTTPClient::Pool &pool,
 	CHTTPClient::Address &address,
 	const wchar_t	contextPath[],
 	const wchar_t	username[],
-	const wchar_t	password[]
+	const wchar_t	password[],
+	DiscoveryCache::Entry *const discovered
 	)
 {
+if (discovered) {
+	discovered->fHost = address.fHost;
+	discovered->fPort = address.fPort;
+	discovered->fContextPath = contextPath;
+	}
+
 return MakeServiceFromContext(
-	CHTTPClient(address, username, password),
+	pool,
+	CHTTPClient(pool, address, username, password),
 	contextPath,
-	username, password
+	username, password,
+	discovered
 	);
 }
 
 
+/*	MakeFromDiscovery
+	Recreate a CalDAV service session from what was previously discovered, without asking the server
+	
+	The home set is found relative to the principal's server, just as it was when it was
+	discovered.
+*/
+Session Session::MakeFromDiscovery(
+	CHTTPClient::Pool &pool,
+	const DiscoveryCache::Entry &discovered,
+	const wchar_t	username[],
+	const wchar_t	password[]
+	)
+{
+std::optional<Session> result;
+
+// the server the principal is on
+std::wstring principalHost = discovered.fHost;
+unsigned short principalPort = discovered.fPort;
+bool principalSecure = true;
+Split(
+	discovered.fPrincipalURL.c_str(),
+	[](const wchar_t[]) {},
+	[&](const CHTTPClient::Address &principalHostAddress, const wchar_t[]) {
+		principalHost = principalHostAddress.fHost;
+		principalPort = principalHostAddress.fPort;
+		principalSecure = principalHostAddress.fSecure;
+		}
+	);
+
+Split(
+	discovered.fHomeSetURL.c_str(),
+	
+	// on same server as the principal?
+	[&](const wchar_t homeSetPath[]) {
+		result.emplace(
+			CHTTPClient(pool, CHTTPClient::Address(principalSecure, principalHost.c_str(), principalPort), username, password),
+			homeSetPath,
+			discovered
+			);
+		},
+	
+	// on different server?
+	[&](const CHTTPClient::Address &homeSetHostAddress, const wchar_t homeSetPath[]) {
+		result.emplace(
+			CHTTPClient(pool, homeSetHostAddress, username, password),
+			homeSetPath,
+			discovered
+			);
+		}
+	); assert(result);
+
+return std::move(*result);
+}
+
+
 /*	MakeServiceFromContext
 	Makes the per-user 'principal' CalDAV service
 	
@@ -195,31 +269,39 @@ return MakeServiceFromContext(
 	
 	Note that the principal CalDAV service may or may not exist on a completely different server.
 	In the case that it's the same server, we take care to reuse the HTTP session
-	already established for the 'context' service.
+	already established for the 'context' service.  Even when the URL names a server
+	explicitly, a client to it shares connections with the others through the same pool.
 */
 Session Session::MakeServiceFromContext(
+	CHTTPClient::Pool &pool,
 	CHTTPClient	&&contextService,
 	const wchar_t	contextPath[],
 	const wchar_t	username[],
-	const wchar_t	password[]
+	const wchar_t	password[],
+	DiscoveryCache::Entry *const discovered
 	)
 {
 std::optional<Session> result;
 
+std::wstring principalURL = FindPrincipalPath(contextService, contextPath);
+if (discovered) discovered->fPrincipalURL = principalURL;
+
 Split(
 	/* Sometimes, the returned principal path is a relative path;
 	   with iCloud, it is a full URL pointing to a completely different server.
 	   Update: maybe I'm mistaken?  Now this is just a path, and only the
 	   calendar home set URL is on a different server? */
-	FindPrincipalPath(contextService, contextPath).c_str(),
+	principalURL.c_str(),
 	
 	// on same server?
 	[&](const wchar_t principalPath[]) {
 		result.emplace(
 			MakeServiceFromPrincipal(
+				pool,
 				std::move(contextService),
 				principalPath,
-				username, password
+				username, password,
+				discovered
 				)
 			);
 		},
@@ -229,9 +311,11 @@ Split(
 		// create a client for the new server containing the principal path
 		result.emplace(
 			MakeServiceFromPrincipal(
-				CHTTPClient(principalHostAddress, username, password),
+				pool,
+				CHTTPClient(pool, principalHostAddress, username, password),
 				principalPath,
-				username, password
+				username, password,
+				discovered
 				)
 			);
 		}
@@ -242,23 +326,29 @@ return std::move(*result);
 
 
 Session Session::MakeServiceFromPrincipal(
+	CHTTPClient::Pool &pool,
 	CHTTPClient	&&principalServer,
 	const wchar_t	principalPath[],
 	const wchar_t	username[],
-	const wchar_t	password[]
+	const wchar_t	password[],
+	DiscoveryCache::Entry *const discovered
 	)
 {
 std::optional<Session> result;
 
+/* In iCloud, the principal path is just a path on the same server; but the calendar home set path is on a different server */
+std::wstring homeSetURL = CalDAV::GetCalendarHomeSet(principalServer, principalPath);
+if (discovered) discovered->fHomeSetURL = homeSetURL;
+
 Split(
-	/* In iCloud, the principal path is just a path on the same server; but the calendar home set path is on a different server */
-	CalDAV::GetCalendarHomeSet(principalServer, principalPath).c_str(),
+	homeSetURL.c_str(),
 	
 	// on same server?
 	[&](const wchar_t homeSetPath[]) {
 		result.emplace(
 			std::move(principalServer),
-			homeSetPath
+			homeSetPath,
+			discovered
 			);
 		},
 	
@@ -266,8 +356,9 @@ Split(
 	[&](const CHTTPClient::Address &homeSetHostAddress, const wchar_t homeSetPath[]) {
 		// create a client for the new server
 		result.emplace(
-			CHTTPClient(homeSetHostAddress, username, password),
-			homeSetPath
+			CHTTPClient(pool, homeSetHostAddress, username, password),
+			homeSetPath,
+			discovered
 			);
 		}
 	); assert(result);
@@ -281,7 +372,8 @@ return std::move(*result);
 */
 Session::Session(
 	CHTTPClient	&&homeSetServer,
-	const wchar_t	homeSetPath[]
+	const wchar_t	homeSetPath[],
+	DiscoveryCache::Entry *const discovered
 	) :
 	fClient(std::move(homeSetServer)),
 	fHomeSetPath(SlashTerminate(homeSetPath))
@@ -293,9 +385,14 @@ Session::Session(
 DAV::GetServerOptions(
 	fClient,
 	homeSetPath,
-	[this](const char allow[], const char dav[]) {
+	[this, discovered](const char allow[], const char dav[]) {
 		fHomeSetAllow = DAV::Allow(allow);
 		fHomeSetCapabilities = DAV::Capabilities(dav);
+		
+		if (discovered) {
+			discovered->fAllow = allow;
+			discovered->fDAV = dav;
+			}
 		}
 	);
 
@@ -308,12 +405,34 @@ WebDAV::Find::Properties(
 	WebDAV::Response(),
 	
 	VersioningDAV::SupportedReportSet(
-		[this](const wchar_t reportName[]) { fHomeSetSupportedReports.Add(reportName); }
+		[this, discovered](const std::string_view reportName) {
+			fHomeSetSupportedReports.Add(reportName);
+			if (discovered) discovered->fReports.emplace_back(reportName);
+			}
 		)
 	);
 }
 
 
+/*	Session
+	Construct CalDAV client from an already existing HTTP connection to the server, and what
+	was previously discovered about the home set
+*/
+Session::Session(
+	CHTTPClient	&&homeSetServer,
+	const wchar_t	homeSetPath[],
+	const DiscoveryCache::Entry &discovered
+	) :
+	fClient(std::move(homeSetServer)),
+	fHomeSetPath(SlashTerminate(homeSetPath)),
+	fHomeSetAllow(discovered.fAllow.c_str()),
+	fHomeSetCapabilities(discovered.fDAV.c_str())
+{
+for (const std::string &reportName: discovered.fReports)
+	fHomeSetSupportedReports.Add(reportName);
+}
+
+
 /*	Session
 	Move constructor
 */
@@ -329,6 +448,30 @@ Session::Session(
 }
 
 
+/*	HomeSetFound
+	Whether the home set is still where it was discovered; which tells a request that wasn't
+	found because of what was discovered from one that asked for something that isn't there
+*/
+bool Session::HomeSetFound()
+{
+try {
+	WebDAV::Find::Properties(
+		fClient,
+		fHomeSetPath.c_str(),
+		DAV::Depth::zero,
+		WebDAV::Response(),
+		WebDAV::Find::ResourceType([]() {})
+		);
+	}
+
+catch (const unsigned status) {
+	return status != 404;
+	}
+
+return true;
+}
+
+
 /*	ListItems
 	Return a vector of paths to each of the given named calendar's items
 */
@@ -370,26 +513,29 @@ return itemPaths;
 	then getting the calendar data of each individually through HTTP GET
 	
 	There is probably no reason to prefer this over the CalDAV calendar-multiget REPORT
-	used by ExportCalendarMultiply()
+	used by ExportCalendarMultiply(), except for servers that don't support it; the items
+	are fetched over several connections at once to make up for the round trip per item.
 */
 void Session::ExportCalendarIndividually(
 	const wchar_t	name[],
-	const std::function<void (std::wistream&)> &Recipient
+	const std::function<void (std::wistream&)> &Recipient,
+	const Fetch::Options &options
 	)
 {
-// for each of the calendar's items
-for (const std::wstring &itemPath: ListItems(name))
-	// get the item 
-	CalDAV::GetItem(fClient, itemPath.c_str(), Recipient);
+// get each of the calendar's items
+Fetch(fClient, options)(ListItems(name), Recipient);
 }
 
 
 /*	ExportCalendarMultiply
 	Export a calendar collection by first obtaining a list of its immediate children,
 	then getting the calendar data of each in bulk through HTTP REPORT
+	
+	Large calendars are requested in batches, since some servers reject very large requests.
 */
 void Session::ExportCalendarMultiply(
-	const wchar_t	name[]
+	const wchar_t	name[],
+	const CalDAV::MultiGet::Batching &batching
 	)
 {
 // can use the home set path, given that the item paths are already exact
@@ -397,10 +543,11 @@ void Session::ExportCalendarMultiply(
    then the DAV:href elements MUST refer to calendar object resources
    within that collection, and they MAY refer to calendar object
    resources at any depth within the collection. */
-CalDAV::MultiGet::Properties(
+CalDAV::MultiGet::BatchedProperties(
 	fClient,
 	fHomeSetPath.c_str(), DAV::Depth::zero,
 	ListItems(name),
+	batching,
 	WebDAV::Response<> {},
 	CalDAV::CalendarData(
 		[](const wchar_t content[]) {
@@ -411,6 +558,123 @@ CalDAV::MultiGet::Properties(
 }
 
 
+/*	ExportCalendarMirrored
+	Export a calendar collection from a local mirror, after bringing the mirror up to date
+	
+	The mirror keeps the synchronization token it was last brought up to date with; so only
+	what changed since then is reported [RFC 6578], and only the changed items are fetched
+	through calendar-multiget.  Without a token, or when the server no longer accepts it, all
+	members are reported; then the ones the mirror already has the current ETag of are kept,
+	and the ones not reported at all are dropped.
+*/
+void Session::ExportCalendarMirrored(
+	const wchar_t	name[],
+	const wchar_t	mirrorPath[],
+	const CalDAV::MultiGet::Batching &batching
+	)
+{
+if (!fHomeSetSupportedReports.fSyncCollection) throw "sync-collection not permitted by supported-reports";
+
+Mirror mirror = Mirror::Load(mirrorPath);
+std::string token;
+std::vector<std::wstring> changed;
+
+// concatenate home set path with specified calendar path
+FormatString(
+	L"{}{}/",
+	[&](const wchar_t path[]) {
+		for (bool retry = true; retry; ) {
+			retry = false;
+			
+			// without a token, whatever isn't reported is gone
+			const bool initial = mirror.fToken.empty();
+			std::map<std::string, Mirror::Item> previous;
+			if (initial) previous.swap(mirror.fItems);
+			std::map<std::string, Mirror::Item> &known = initial ? previous : mirror.fItems;
+			
+			// state of the <response> being parsed
+			std::string href, etag;
+			bool removed = false;
+			
+			try {
+				SynchronizationDAV::Perform(
+					fClient,
+					path,
+					initial ? nullptr : Widen(mirror.fToken).c_str(),
+					[&token](const std::string_view t) { token = t; },
+					
+					WebDAV::Response(
+						WebDAV::HREF([&](const std::string_view h) { href = h; etag.clear(); removed = false; }),
+						WebDAV::Status([&removed](const std::string_view status) { removed = status.find(" 404") != std::string_view::npos; }),
+						WebDAV::End(
+							[&]() {
+								if (removed)
+									mirror.fItems.erase(href);
+								
+								// already have this version?
+								else if (const auto had = known.find(href); had != known.end() && !etag.empty() && had->second.fETag == etag) {
+									if (initial) mirror.fItems.insert(previous.extract(had));
+									}
+								
+								else
+									changed.push_back(Widen(href));
+								}
+							)
+						),
+					
+					WebDAV::Find::ETag([&etag](const std::string_view e) { etag = e; })
+					);
+				}
+			
+			// token no longer valid?  start over without it [RFC 6578 §3.2]
+			catch (const unsigned status) {
+				if (initial || (status != 403 && status != 409)) throw;
+				
+				mirror.fToken.clear();
+				changed.clear();
+				retry = true;
+				}
+			}
+		},
+	fHomeSetPath,
+	name
+	);
+
+// get the changed items
+size_t fetched = 0;
+if (!changed.empty()) {
+	std::string href;
+	Mirror::Item item;
+	
+	CalDAV::MultiGet::BatchedProperties(
+		fClient,
+		fHomeSetPath.c_str(), DAV::Depth::zero,
+		changed,
+		batching,
+		WebDAV::Response(
+			WebDAV::HREF([&](const std::string_view h) { href = h; item = Mirror::Item(); }),
+			WebDAV::End(
+				[&]() {
+					if (item.fData.empty()) return;
+					mirror.fItems.insert_or_assign(href, std::move(item));
+					fetched++;
+					}
+				)
+			),
+		WebDAV::Find::ETag([&item](const std::string_view etag) { item.fETag = etag; }),
+		CalDAV::CalendarData([&item](const std::string_view data) { item.fData = data; })
+		);
+	}
+
+// keep the old token unless all changes are in, so whatever's missing is reported again next time
+if (fetched == changed.size()) mirror.fToken = std::move(token);
+mirror.Save(mirrorPath);
+
+for (const auto &[href, item]: mirror.fItems)
+	std::wcout << Widen(item.fData) << L'\n';
+}
+
+
 /*	SynchronizeCalendar
 	*** RFC says might be supported by arbitrary collection
 */
@@ -456,21 +720,22 @@ FormatString(
 
 
 /*	ReadCalendarItemFromCalDAV
-	Read the calendar item at the given path on the server
+	Read the calendar item at the given path on the server, interning its names in the given table
 */
-DynamicCalendar<wchar_t> Session::ReadCalendarItemFromCalDAV(
-	const wchar_t	path[]
+DynamicCalendar<char> Session::ReadCalendarItemFromCalDAV(
+	const wchar_t	path[],
+	InternTable<char> &intern
 	)
 {
-DynamicCalendar<wchar_t> result;
+DynamicCalendar<char> result;
 
 // get the corresponding calendar item
-CalDAV::GetItem(
+CalDAV::GetItemContent(
 	fClient,
 	path,
-	[&result](std::wistream &is) {
-		// parse it
-		DynamicCalendar<wchar_t>::Parser(result, is)();
+	[&result, &intern](const std::string_view content) {
+		// parse it as received, in UTF-8
+		DynamicCalendar<char>::Parser(result, content, intern)();
 		}
 	);
 
@@ -483,18 +748,15 @@ return result;
 */
 void Session::WriteCalendarItemToCalDAV(
 	const wchar_t	path[],
-	const DynamicCalendar<wchar_t> &calendarItem
+	const DynamicCalendar<char> &calendarItem
 	)
 {
+// our calendar interface can only write to an actual output stream
+std::ostringstream os;
+os << calendarItem;
+
 // set the corresponding calendar item
-CalDAV::SetItem(
-	fClient,
-	path,
-	[&calendarItem](std::wstreambuf &osb) {
-		// our calendar interface can only write to an actual output stream
-		std::wostream(&osb, true) << calendarItem;
-		}
-	);
+CalDAV::SetItemContent(fClient, path, os.view());
 }
 
 
@@ -739,17 +1001,18 @@ void Session::WriteItem(
 	const wchar_t	filePath[]
 	)
 {
-FILE *const file = wfopen_s(filePath, L"r,ccs=utf-16le");
-std::wifstream ifs(file);
-if (!ifs) throw "can't open file";
+// map the file rather than reading it
+const MappedFile file(filePath);
+std::wstring decoded;
+const std::wstring_view text = CalendarText(file.Contents(), decoded);
 	
 // get the corresponding calendar item
 CalDAV::SetItem(
 	fClient,
 	path,
-	[&ifs](std::wstreambuf &osb) {
-		// just write file stream directly to output stream buffer
-		ifs >> &osb;
+	[text](std::wstreambuf &osb) {
+		// all of it every time, in case the request has to be repeated
+		osb.sputn(text.data(), text.size());
 		}
 	);
 }
@@ -771,7 +1034,7 @@ WebDAV::Find::All(
 		/* Here we get the benefit of accessing the response as a standard input stream,
 			with CR/LF mapping and conversion to UTF-16.  We're not going through the
 			CalDAV layer, and so its line folding is also not happening here. */
-		aistreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(response);
+		ristreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(response);
 			
 		// print to standard output
 		std::wcout << &isb;
@@ -802,7 +1065,7 @@ void Session::ReadItemPropertyNames(
 	</propstat>
 	
 	In particular, I'm not sure now whether the "propname" element encloses the (empty)
-	response structure (which is not what RFC 4918 9.1.4 suggests) or whether
+	response structure (which is not what RFC 4918 §9.1.4 suggests) or whether
 	it's an actual property name (which goes counter to the usual PROPFIND convention
 	of looking for the "propname" response element corresponding to the request; and
 	counter to the "404" being returned).  My guess is that the former interpretation
@@ -826,15 +1089,16 @@ void Session::WriteCalendarItem(
 	const wchar_t	filePath[]
 	)
 {
-DynamicCalendar<wchar_t> calendarItem;
+// names are interned for this item only, rather than for the life of the process
+InternTable<char> intern;
+DynamicCalendar<char> calendarItem;
 	
-// open file for UTF-16
-FILE *const file = wfopen_s(filePath, L"r,ccs=utf-16le");
-std::wifstream ifs(file);				// Windows extension *** I assume this also closes the FILE
-if (!ifs) throw "couldn't open file stream";
+// map the file rather than reading it
+const MappedFile file(filePath);
+std::string narrowed;
 	
 // parse into calendar object
-DynamicCalendar<wchar_t>::Parser(calendarItem, ifs)();
+DynamicCalendar<char>::Parser(calendarItem, CalendarUTF8(file.Contents(), narrowed), intern)();
 	
 WriteCalendarItemToCalDAV(path, calendarItem);
 }
@@ -6,7 +6,7 @@
 	2019/05/02	Originated
 	2023/05/21	Factored out session management
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
 #pragma once
@@ -14,7 +14,9 @@
 #include <string>
 
 #include "DAV.h"
+#include "DiscoveryCache.h"
 #include "Dynamic.h"
+#include "Fetch.h"
 #include "Versioning.h"
 #include "WebDAV.h"
 #include "CalDAV.h"
@@ -35,17 +37,21 @@ protected:
 				);
 	
 	static Session	MakeServiceFromContext(
+				CHTTPClient::Pool&,
 				CHTTPClient	&&contextServer,
 				const wchar_t	contextPath[],
 				const wchar_t	username[],
-				const wchar_t	password[]
+				const wchar_t	password[],
+				DiscoveryCache::Entry *discovered
 				);
 	
 	static Session	MakeServiceFromPrincipal(
+				CHTTPClient::Pool&,
 				CHTTPClient	&&principalServer,
 				const wchar_t	principalPath[],
 				const wchar_t	username[],
-				const wchar_t	password[]
+				const wchar_t	password[],
+				DiscoveryCache::Entry *discovered
 				);
 	
 	
@@ -59,32 +65,45 @@ protected:
 
 public:
 	static Session	MakeFromServiceLocation(
+				CHTTPClient::Pool&,
 				CHTTPClient::Address&,
 				const wchar_t	contextPath[],
 				const wchar_t	username[],
+				const wchar_t	password[],
+				DiscoveryCache::Entry *discovered = nullptr
+				);
+	
+	static Session	MakeFromDiscovery(
+				CHTTPClient::Pool&,
+				const DiscoveryCache::Entry&,
+				const wchar_t	username[],
 				const wchar_t	password[]
 				);
 	
 	
-			Session(CHTTPClient&&, const wchar_t homeSetPath[]);
+			Session(CHTTPClient&&, const wchar_t homeSetPath[], DiscoveryCache::Entry *discovered = nullptr);
+			Session(CHTTPClient&&, const wchar_t homeSetPath[], const DiscoveryCache::Entry&);
 			Session(Session&&) noexcept;
 	
 	CHTTPClient	&Client() { return fClient; }
 	
 	DAV::Allow	HomeSetAllow() const { return fHomeSetAllow; }
 	DAV::Capabilities HomeSetCapabilities() const { return fHomeSetCapabilities; }
+	bool		HomeSetFound();
 	
 	std::vector<std::wstring> ListItems(const wchar_t name[]);
-	void		ExportCalendarIndividually(const wchar_t name[], const std::function<void (std::wistream&)> &Recipient);
-	void		ExportCalendarMultiply(const wchar_t name[]);
+	void		ExportCalendarIndividually(const wchar_t name[], const std::function<void (std::wistream&)> &Recipient, const Fetch::Options& = Fetch::Options());
+	void		ExportCalendarMultiply(const wchar_t name[], const CalDAV::MultiGet::Batching& = CalDAV::MultiGet::Batching());
+	void		ExportCalendarMirrored(const wchar_t name[], const wchar_t mirrorPath[], const CalDAV::MultiGet::Batching& = CalDAV::MultiGet::Batching());
 	
-	DynamicCalendar<wchar_t> ReadCalendarItemFromCalDAV(
-				const wchar_t	path[]
+	DynamicCalendar<char> ReadCalendarItemFromCalDAV(
+				const wchar_t	path[],
+				InternTable<char> &intern
 				);
 	
 	void		WriteCalendarItemToCalDAV(
 				const wchar_t	path[],
-				const DynamicCalendar<wchar_t> &calendarItem
+				const DynamicCalendar<char> &calendarItem
 				);
 	
 	void		CreateCalendar(const wchar_t calendarPath[], const wchar_t calendarName[]);
@@ -5,10 +5,14 @@
 	
 	2019/04/15	Originated
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
 #include <string>
+#include <string_view>
+
+#include "String.h"
+#include "Transcode.h"
 
 
 
@@ -28,3 +32,36 @@ if (result.empty() || result.back() != L'/')
 
 return result;
 }
+
+
+/*	Widen
+	Return the UTF-8 string in native wide characters
+	The string is presumed to be valid UTF-8 (as delivered by the XML parser)
+*/
+std::wstring Widen(
+	const std::string_view string
+	)
+{
+// no more wide characters than bytes
+std::wstring result(string.size(), L'\0');
+size_t stringL = string.size();
+result.resize(DecodeUTF8(string.data(), stringL, result.data(), result.size()));
+
+return result;
+}
+
+
+/*	Narrow
+	Return the UTF-8 encoding of a wide string
+*/
+std::string Narrow(
+	const std::wstring_view string
+	)
+{
+// no more than a full sequence for each wide character
+std::string result(string.size() * kUTF8PerWide, '\0');
+size_t stringL = string.size();
+result.resize(EncodeUTF8(string.data(), stringL, result.data()));
+
+return result;
+}
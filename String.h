@@ -5,7 +5,7 @@
 	
 	2019/04/15	Originated
 	
-	Copyright  2019-2023 by: Ben Hekster
+	Copyright © 2019-2023 by: Ben Hekster
 */
 
 #pragma once
@@ -18,6 +18,8 @@
 
 #include <format>
 #include <functional>
+#include <string>
+#include <string_view>
 
 
 
@@ -47,3 +49,5 @@ F(string);
 
 
 std::wstring SlashTerminate(const wchar_t[]);
+std::wstring Widen(std::string_view);
+std::string Narrow(std::wstring_view);
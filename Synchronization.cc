@@ -5,7 +5,7 @@
 	
 	2023/09/26	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 	
 	RFC 6578	Collection Synchronization for Web Distributed Authoring and Versioning (WebDAV)
 */
@@ -5,7 +5,7 @@
 	
 	2023/09/26	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 	
 	RFC 6578	Collection Synchronization for Web Distributed Authoring and Versioning (WebDAV)
 */
@@ -64,6 +64,7 @@ protected:
 			gEndTag = L"</D:sync-collection>";
 	
 	
+	void		*dummy;				// property transitions are relative to this
 	PT		fProperties;
 
 public:
@@ -110,10 +111,11 @@ struct SynchronizationDAV::Token : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Content(const wchar_t token[]) { FContent(token); }
+	void		Content(const XMLParser<StateParser>::String token) { Deliver(FContent, token); }
 
 public:
-	static constexpr wchar_t tag[] = L"sync-token";
+	static constexpr char tag[] = "sync-token";
+	static constexpr std::wstring_view gXML = L"";		// already in the query
 	
 	static constexpr StateParser::State gState {
 			{},
@@ -162,10 +164,8 @@ FormatString(
 			DAV::Depth::zero,
 			body,
 			[&response](CHTTPClient::Response &httpResponse) {
-				// parse XML response
-				StateParser events(decltype(response)::gStateDocument, response);
-				XMLParser parser(events);
-				parser(httpResponse.Content());
+				// parse XML response as it arrives
+				response.Parse([&httpResponse](void *buffer, size_t bufferL) { return httpResponse.Receive(buffer, bufferL); });
 				}
 			);
 		},
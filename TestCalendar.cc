@@ -4,6 +4,8 @@
 
 #include <malloc.h>
 #include <fstream>
+#include <memory_resource>
+#include <sstream>
 
 #include "CppUnitTest.h"
 #include "Dynamic.h"
@@ -28,8 +30,9 @@ public:
 		std::wifstream ifs("D4DC6FDA-667C-461B-8681-2025FA436BAE.ics");
 		Assert::IsTrue(ifs.is_open());
 		
+		InternTable<wchar_t> intern;
 		DynamicCalendar<> calendarItem;
-		DynamicCalendar<>::Parser(calendarItem, ifs).operator()();
+		DynamicCalendar<>::Parser(calendarItem, ifs, intern).operator()();
 		
 		DynamicCalendar<>::ToDo &todo = std::get<DynamicCalendar<>::ToDo>(calendarItem.fComponents[0]);
 		Assert::IsTrue(todo.fUID == L"D4DC6FDA-667C-461B-8681-2025FA436BAE");
@@ -41,8 +44,9 @@ public:
 		std::wifstream ifs("84F34FBF-E678-4D49-AA9D-AAB54221332C.ics");
 		Assert::IsTrue(ifs.is_open());
 		
+		InternTable<wchar_t> intern;
 		DynamicCalendar<wchar_t> calendarItem;
-		DynamicCalendar<wchar_t>::Parser(calendarItem, ifs).operator()();
+		DynamicCalendar<wchar_t>::Parser(calendarItem, ifs, intern).operator()();
 		
 		DynamicCalendar<wchar_t>::Event &event = std::get<DynamicCalendar<>::Event>(calendarItem.fComponents[0]);
 		Assert::IsTrue(event.fUID == L"84F34FBF-E678-4D49-AA9D-AAB54221332C");
@@ -60,8 +64,9 @@ public:
 		std::wifstream ifs("7b84cd2d-8cd9-4ed4-82bc-89fe145a001e.ics");
 		Assert::IsTrue(ifs.is_open());
 		
+		InternTable<wchar_t> intern;
 		DynamicCalendar<> calendarItem;
-		DynamicCalendar<>::Parser(calendarItem, ifs).operator()();
+		DynamicCalendar<>::Parser(calendarItem, ifs, intern).operator()();
 		
 		DynamicCalendar<>::Event &event = std::get<DynamicCalendar<>::Event>(calendarItem.fComponents[0]);
 		Assert::IsTrue(event.fUID == L"7b84cd2d-8cd9-4ed4-82bc-89fe145a001e");
@@ -75,8 +80,9 @@ public:
 		Assert::IsTrue(ifsbuf.narrowbuf().is_open());
 		std::wistream ifs(&ifsbuf);
 		
+		InternTable<wchar_t> intern;
 		DynamicCalendar calendarItem;
-		DynamicCalendar<>::Parser(calendarItem, ifs).operator()();
+		DynamicCalendar<>::Parser(calendarItem, ifs, intern).operator()();
 		
 		Assert::IsTrue(calendarItem.fScale == DynamicCalendar<>::Scale::kGregorian);
 		
@@ -94,8 +100,9 @@ public:
 		Assert::IsTrue(ifsbuf.narrowbuf().is_open());
 		std::wistream ifs(&ifsbuf);
 		
+		InternTable<wchar_t> intern;
 		DynamicCalendar calendarItem;
-		DynamicCalendar<>::Parser(calendarItem, ifs).operator()();
+		DynamicCalendar<>::Parser(calendarItem, ifs, intern).operator()();
 		
 		Assert::IsTrue(calendarItem.fScale == DynamicCalendar<>::Scale::kGregorian);
 		
@@ -111,8 +118,9 @@ public:
 		Assert::IsTrue(ifsbuf.narrowbuf().is_open());
 		std::wistream ifs(&ifsbuf);
 		
+		InternTable<wchar_t> intern;
 		DynamicCalendar calendarItem;
-		DynamicCalendar<>::Parser(calendarItem, ifs).operator()();
+		DynamicCalendar<>::Parser(calendarItem, ifs, intern).operator()();
 		
 		Assert::IsTrue(calendarItem.fScale == DynamicCalendar<>::Scale::kGregorian);
 		
@@ -144,6 +152,194 @@ public:
 		Assert::IsTrue(division.fOffsetTo->fMinute == 0);
 		Assert::IsTrue(division.fOffsetTo->fSecond == 0);
 		}
+	
+	
+	TEST_METHOD(ParseFoldedBuffer) {
+		static constexpr wchar_t buffer[] =
+			L"BEGIN:VCALENDAR\r\n"
+			L"VERSION:2.0\r\n"
+			L"PRODID:-//Test//EN\r\n"
+			L"BEGIN:VEVENT\r\n"
+			L"UID:abc\r\n"
+			L"SUMMARY:Ste\r\n"
+			L" lla \r\n"
+			L"\tMaris\r\n"
+			L"CLASS:PRIVATE\r\n"
+			L"BEGIN:VALARM\r\n"
+			L"ACTION:DISPLAY\r\n"
+			L"TRIGGER;VALUE=DURATION:-PT15M\r\n"
+			L"END:VALARM\r\n"
+			L"END:VEVENT\r\n"
+			L"END:VCALENDAR\r\n";
+		
+		InternTable<wchar_t> intern;
+		DynamicCalendar calendarItem;
+		DynamicCalendar<>::Parser(calendarItem, std::wstring_view(buffer), intern).operator()();
+		
+		DynamicCalendar<>::Event &event = std::get<DynamicCalendar<>::Event>(calendarItem.fComponents[0]);
+		Assert::IsTrue(event.fUID == L"abc");
+		Assert::IsTrue(event.fSummary == L"Stella Maris");
+		Assert::IsTrue(event.fClassification == DynamicCalendar<>::Classification::kPrivate);
+		Assert::IsTrue(event.fAlarms.size() == 1);
+		}
+	
+	
+	TEST_METHOD(ParseUTF8) {
+		static constexpr char buffer[] =
+			"BEGIN:VCALENDAR\r\n"
+			"PRODID:-//Test//EN\r\n"
+			"VERSION:2.0\r\n"
+			"BEGIN:VTODO\r\n"
+			"UID:abc\r\n"
+			"STATUS:NEEDS-ACTION\r\n"
+			"SUMMARY:Caf\xC3\xA9 au lait\r\n"
+			"END:VTODO\r\n"
+			"END:VCALENDAR\r\n";
+		
+		InternTable<char> intern;
+		DynamicCalendar<char> calendarItem;
+		DynamicCalendar<char>::Parser(calendarItem, std::string_view(buffer), intern).operator()();
+		
+		DynamicCalendar<char>::ToDo &todo = std::get<DynamicCalendar<char>::ToDo>(calendarItem.fComponents[0]);
+		Assert::IsTrue(todo.fSummary == "Caf\xC3\xA9 au lait");
+		Assert::IsTrue(todo.fStatus == DynamicCalendar<char>::StatusToDo::kNeedsAction);
+		
+		// written the same way as a wide calendar would be
+		std::ostringstream output;
+		output << calendarItem;
+		Assert::IsTrue(output.str().find("SUMMARY:Caf\xC3\xA9 au lait\n") != std::string::npos);
+		Assert::IsTrue(output.str().find("STATUS:NEEDS-ACTION\n") != std::string::npos);
+		}
+	
+	
+	TEST_METHOD(ParseIntoArena) {
+		static constexpr wchar_t buffer[] =
+			L"BEGIN:VCALENDAR\r\n"
+			L"PRODID:-//Test//EN\r\n"
+			L"VERSION:2.0\r\n"
+			L"BEGIN:VEVENT\r\n"
+			L"UID:abc\r\n"
+			L"SUMMARY:Something long enough not to fit in a small string\r\n"
+			L"X-EXTRA:value\r\n"
+			L"BEGIN:VALARM\r\n"
+			L"ACTION:DISPLAY\r\n"
+			L"TRIGGER:-PT15M\r\n"
+			L"END:VALARM\r\n"
+			L"END:VEVENT\r\n"
+			L"END:VCALENDAR\r\n";
+		
+		std::pmr::monotonic_buffer_resource arena;
+		InternTable<wchar_t> intern(&arena);
+		DynamicCalendar calendarItem(&arena);
+		
+		// nothing may come from the default resource while parsing
+		std::pmr::memory_resource *const heap = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+		try {
+			DynamicCalendar<>::Parser(calendarItem, std::wstring_view(buffer), intern).operator()();
+			}
+		catch (...) {
+			std::pmr::set_default_resource(heap);
+			throw;
+			}
+		std::pmr::set_default_resource(heap);
+		
+		// everything in the item came from the arena
+		DynamicCalendar<>::Event &event = std::get<DynamicCalendar<>::Event>(calendarItem.fComponents[0]);
+		Assert::IsTrue(event.fSummary == L"Something long enough not to fit in a small string");
+		Assert::IsTrue(event.fSummary.get_allocator().resource() == &arena);
+		Assert::IsTrue(event.fExtra.get_allocator().resource() == &arena);
+		Assert::IsTrue(event.fExtra.begin()->second.get_allocator().resource() == &arena);
+		Assert::IsTrue(event.fAlarms.get_allocator().resource() == &arena);
+		Assert::IsTrue(event.fAlarms[0].fUID.get_allocator().resource() == &arena);
+		}
+	
+	
+	TEST_METHOD(InternIdentifiers) {
+		static constexpr wchar_t buffer[] =
+			L"BEGIN:VCALENDAR\r\n"
+			L"PRODID:-//Test//EN\r\n"
+			L"VERSION:2.0\r\n"
+			L"BEGIN:VEVENT\r\n"
+			L"UID:abc\r\n"
+			L"DTSTART;TZID=America/Los_Angeles:20231014T090000\r\n"
+			L"X-EXTRA:value\r\n"
+			L"END:VEVENT\r\n"
+			L"END:VCALENDAR\r\n";
+		
+		InternTable<wchar_t> intern;
+		DynamicCalendar<> first, second;
+		DynamicCalendar<>::Parser(first, std::wstring_view(buffer), intern).operator()();
+		DynamicCalendar<>::Parser(second, std::wstring_view(buffer), intern).operator()();
+		
+		// the same strings came out as the same handles
+		const DynamicCalendar<>::Event
+			&firstEvent = std::get<DynamicCalendar<>::Event>(first.fComponents[0]),
+			&secondEvent = std::get<DynamicCalendar<>::Event>(second.fComponents[0]);
+		Assert::IsTrue(firstEvent.fStartTimeZoneID == L"America/Los_Angeles");
+		Assert::IsTrue(firstEvent.fStartTimeZoneID == secondEvent.fStartTimeZoneID);
+		Assert::IsTrue(first.fProductID == second.fProductID);
+		Assert::IsTrue(firstEvent.fExtra.begin()->first == secondEvent.fExtra.begin()->first);
+		Assert::IsTrue(firstEvent.fExtra.begin()->first == intern(L"X-EXTRA"));
+		}
+	};
+
+
+TEST_CLASS(TestCalendarValues) {
+protected:
+	using Parser = DynamicCalendar<>::Parser;
+
+public:
+	TEST_METHOD(Date) {
+		const DynamicCalendar<>::Date date = Parser::ParseDate(L"20230104");
+		Assert::IsTrue(date.fYear == 2023);
+		Assert::IsTrue(date.fMonth0 == 0);
+		Assert::IsTrue(date.fDay0 == 3);
+		
+		Assert::ExpectException<const char*>([]() { Parser::ParseDate(L"20231304"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDate(L"20230100"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDate(L"2023-104"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDate(L"2023010"); });
+		}
+	
+	TEST_METHOD(DateTime) {
+		const DynamicCalendar<>::DateTime dateTime = Parser::ParseDateTime(L"19980119T070059Z");
+		Assert::IsTrue(dateTime.fDate.fYear == 1998);
+		Assert::IsTrue(dateTime.fTime.fHour == 7);
+		Assert::IsTrue(dateTime.fTime.fMinute == 0);
+		Assert::IsTrue(dateTime.fTime.fSecond == 59);
+		Assert::IsTrue(dateTime.fTime.fZone == DynamicCalendar<>::Time::Zone::kUTC);
+		
+		Assert::ExpectException<const char*>([]() { Parser::ParseDateTime(L"19980119T240000"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDateTime(L"19980119T23 000"); });
+		}
+	
+	TEST_METHOD(UTCOffset) {
+		const DynamicCalendar<>::UTCOffset offset = Parser::ParseUTCOffset(L"-075258");
+		Assert::IsTrue(offset.fHour == -7);
+		Assert::IsTrue(offset.fMinute == 52);
+		Assert::IsTrue(offset.fSecond == 58);
+		
+		Assert::ExpectException<const char*>([]() { Parser::ParseUTCOffset(L"+0760"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseUTCOffset(L"+07000"); });
+		}
+	
+	TEST_METHOD(Duration) {
+		const DynamicCalendar<>::Duration duration = Parser::ParseDuration(L"P15DT5H0M20S");
+		Assert::IsTrue(duration.fDay == 15);
+		Assert::IsTrue(duration.fHours == 5);
+		Assert::IsTrue(duration.fMinutes == 0);
+		Assert::IsTrue(duration.fSeconds == 20);
+		
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"PT99999H"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"PTH"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"P5X"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"P15"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"P1DT"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"PT"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"P"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L"-"); });
+		Assert::ExpectException<const char*>([]() { Parser::ParseDuration(L""); });
+		}
 	};
 
 
@@ -110,8 +110,9 @@ std::set<std::wstring> output; {
 	std::wistream ifs(&ifsbuf);
 	
 	// parse into our calendar object
+	InternTable<wchar_t> intern;
 	DynamicCalendar<> calendarItem;
-	DynamicCalendar<>::Parser(calendarItem, ifs).operator()();
+	DynamicCalendar<>::Parser(calendarItem, ifs, intern).operator()();
 	
 	// emit the calendar object into a stream of lines
 	std::wstringstream emitted;
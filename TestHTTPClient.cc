@@ -0,0 +1,52 @@
+#include <chrono>
+#include <thread>
+
+#include "CppUnitTest.h"
+
+#include "HTTPClient.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+
+
+TEST_CLASS(TestHTTPClient) {
+public:
+	/*	PoolEviction
+		A server's connections are kept for the configured time after its last client
+		is gone, and no longer
+	*/
+	TEST_METHOD(PoolEviction) {
+		CHTTPClient::Pool pool({ .fIdleTimeout = 1s });
+
+		// no request is made, so no connection to the server is needed
+		{
+			CHTTPClient client(pool, CHTTPClient::Address(true, L"caldav.example.com", 0), L"", L"");
+			Assert::AreEqual<size_t>(0, pool.Kept());
+			}
+		Assert::AreEqual<size_t>(1, pool.Kept());
+
+		std::this_thread::sleep_for(600ms);
+		Assert::AreEqual<size_t>(1, pool.Kept());
+
+		std::this_thread::sleep_for(600ms);
+		Assert::AreEqual<size_t>(0, pool.Kept());
+		}
+
+
+	/*	PoolReuse
+		A client to a server that still has idle connections uses them rather than new ones
+	*/
+	TEST_METHOD(PoolReuse) {
+		CHTTPClient::Pool pool({ .fIdleTimeout = 1s });
+
+		{ CHTTPClient client(pool, CHTTPClient::Address(true, L"caldav.example.com", 0), L"", L""); }
+		std::this_thread::sleep_for(600ms);
+
+		// being used again restarts the timeout
+		{ CHTTPClient client(pool, CHTTPClient::Address(true, L"caldav.example.com", 0), L"", L""); }
+		std::this_thread::sleep_for(600ms);
+		Assert::AreEqual<size_t>(1, pool.Kept());
+		}
+	};
@@ -0,0 +1,521 @@
+#include <WINDEF.H>
+#include <WINBASE.H>
+#include <COMBASEAPI.H>
+#include <XMLLITE.H>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+
+#include "CppUnitTest.h"
+#include "ParseXMLStates.h"
+#include "String.h"
+#include "WebDAV.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+
+/*	XMLLiteParser
+	The same as XMLParser, on top of XmlLite
+	
+	This is what XMLParser used to be.  It's only here to measure the tokenizer against; it has
+	everything in UTF-16, which has to be converted back to UTF-8 for the events, and pulls its
+	input through a COM stream.
+*/
+template <class Events>
+struct XMLLiteParser {
+public:
+	using Data = HGLOBAL;
+	using Receiver = std::function<size_t (void *buffer, size_t bufferL)>;	// returns zero at the end
+
+protected:
+	Events		&fCallback;
+	IXmlReader	*fReader;
+
+	void		StartElement(),
+			EndElement(),
+			Characters();
+	void		Parse(IUnknown *input);
+	
+public:
+	explicit	XMLLiteParser(Events&);
+			~XMLLiteParser();
+
+	void		operator()(const Data),
+			operator()(const Receiver&);
+	};
+
+
+/* From social.msdn.m.c: XMLLite isn't a COM library, it only looks like one.
+   For one, you can't regsvr it.  Maybe because it *uses* COM internally? */
+
+
+
+/*	ReceiverStream
+	Present data as it is received as a stream that XmlLite can pull from
+	
+	Lives on the stack for the duration of the parse, so it isn't actually reference counted.
+*/
+struct ReceiverStream : public ISequentialStream {
+protected:
+	const std::function<size_t (void*, size_t)> &FReceive;
+
+public:
+	std::exception_ptr fError;		// thrown while receiving
+	
+	
+			ReceiverStream(const std::function<size_t (void*, size_t)> &Receive) : FReceive(Receive) {}
+	
+	// IUnknown
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void **object) override {
+		if (iid != __uuidof(IUnknown) && iid != __uuidof(ISequentialStream)) {
+			*object = nullptr;
+			return E_NOINTERFACE;
+			}
+		
+		*object = static_cast<ISequentialStream*>(this);
+		return S_OK;
+		}
+	ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG STDMETHODCALLTYPE Release() override { return 1; }
+	
+	// ISequentialStream
+	HRESULT STDMETHODCALLTYPE Read(void *buffer, ULONG bufferL, ULONG *readL) override;
+	HRESULT STDMETHODCALLTYPE Write(const void*, ULONG, ULONG*) override { return STG_E_ACCESSDENIED; }
+	};
+
+
+/*	Read
+	Return whatever can be received next, without waiting for the buffer to fill
+*/
+HRESULT ReceiverStream::Read(
+	void		*buffer,
+	ULONG		bufferL,
+	ULONG		*readL
+	)
+{
+size_t length;
+
+/* There's no way to pass an exception through XmlLite; so report it as a failure to read,
+   and leave it to the caller to rethrow. */
+try {
+	length = FReceive(buffer, bufferL);
+	}
+
+catch (...) {
+	fError = std::current_exception();
+	return STG_E_READFAULT;
+	}
+
+if (readL) *readL = static_cast<ULONG>(length);
+
+// nothing more means the end of the data
+return length ? S_OK : S_FALSE;
+}
+
+
+/*	XMLLiteParser
+	How to communicate the character set?
+*/
+template <class Events>
+XMLLiteParser<Events>::XMLLiteParser(
+	Events		&callback
+	) :
+	fReader(nullptr),
+	fCallback(callback)
+{
+// create XML parser
+if (CreateXmlReader(__uuidof(IXmlReader), &reinterpret_cast<void*&>(fReader), nullptr) != S_OK) throw GetLastError();
+}
+
+
+/*	~XMLLiteParser
+
+*/
+template <class Events>
+XMLLiteParser<Events>::~XMLLiteParser()
+{
+fReader->Release();
+}
+
+
+/*	StartElement
+
+*/
+template <class Events>
+void XMLLiteParser<Events>::StartElement()
+{
+const wchar_t *nameW; UINT nameL;
+if (fReader->GetLocalName(&nameW, &nameL) != S_OK) throw GetLastError();
+const std::string name = Narrow(std::wstring_view(nameW, nameL));
+
+const wchar_t *namespaysW; UINT namespaysL;
+if (fReader->GetNamespaceUri(&namespaysW, &namespaysL) != S_OK) throw GetLastError();
+const std::string namespays = Narrow(std::wstring_view(namespaysW, namespaysL));
+
+// *** attributes
+
+fCallback.StartElement(namespays, name, {});
+
+// empty element? (self-closing tag)
+if (fReader->IsEmptyElement())
+	// reader doesn't generate an 'EndElement' event
+	fCallback.EndElement(namespays, name);
+}
+
+
+/*	EndElement
+	Interpret 'end element' event
+*/
+template <class Events>
+void XMLLiteParser<Events>::EndElement()
+{
+const wchar_t *nameW; UINT nameL;
+if (fReader->GetLocalName(&nameW, &nameL) != S_OK) throw GetLastError();
+const std::string name = Narrow(std::wstring_view(nameW, nameL));
+
+const wchar_t *namespaysW; UINT namespaysL;
+if (fReader->GetNamespaceUri(&namespaysW, &namespaysL) != S_OK) throw GetLastError();
+const std::string namespays = Narrow(std::wstring_view(namespaysW, namespaysL));
+
+fCallback.EndElement(namespays, name);
+}
+
+
+/*	Characters
+
+*/
+template <class Events>
+void XMLLiteParser<Events>::Characters()
+{
+const wchar_t *value; UINT valueL;
+if (fReader->GetValue(&value, &valueL) != S_OK) throw GetLastError();
+
+fCallback.Characters(Narrow(std::wstring_view(value, valueL)));
+}
+
+
+/*	Parse
+	Parse the document from the given input, which must be an IStream or ISequentialStream
+*/
+template <class Events>
+void XMLLiteParser<Events>::Parse(
+	IUnknown	*input
+	)
+{
+// associate stream with parser
+if (fReader->SetInput(input) != S_OK) throw "can't set XML parser input";
+
+// parse until end
+for (XmlNodeType nodeType; fReader->Read(&nodeType) == S_OK;) {
+	switch (nodeType) {
+		case XmlNodeType_None: break;
+		case XmlNodeType_Element: StartElement(); break;
+		case XmlNodeType_Attribute: break;
+		case XmlNodeType_Text: Characters(); break;
+		case XmlNodeType_CDATA: Characters(); break;
+		case XmlNodeType_ProcessingInstruction: break;
+		case XmlNodeType_Comment: break;
+		case XmlNodeType_DocumentType: break;
+		case XmlNodeType_Whitespace: break;
+		case XmlNodeType_EndElement: EndElement(); break;
+		case XmlNodeType_XmlDeclaration: fCallback.StartDocument(); break;
+		}
+	}
+
+// release the input
+fReader->SetInput(nullptr);
+}
+
+
+/*	()
+	Parse
+*/
+template <class Events>
+void XMLLiteParser<Events>::operator()(
+	HGLOBAL		data
+	)
+{
+// create stream representation of body
+IStream *stream;
+if (CreateStreamOnHGlobal(data, false /* delete handle on release */, &stream) != S_OK) throw GetLastError();
+
+Parse(stream);
+
+stream->Release();
+
+// infer end of XML document
+fCallback.EndDocument();
+}
+
+
+/*	()
+	Parse as the data is received, rather than after all of it has been
+*/
+template <class Events>
+void XMLLiteParser<Events>::operator()(
+	const Receiver	&Receive
+	)
+{
+ReceiverStream stream(Receive);
+Parse(&stream);
+
+// stopped short because the data couldn't be received?
+if (stream.fError) std::rethrow_exception(stream.fError);
+
+// infer end of XML document
+fCallback.EndDocument();
+}
+
+
+
+/*	Recorder
+	Record every element and its content, at any depth
+*/
+struct Recorder : StateParser::Response {
+	std::string	fLog;
+	bool		fDelimited = false;		// show where each piece of text begins and ends
+
+	void		Start(const XMLParser<StateParser>::String name) { fLog.append("<").append(name).append(">"); }
+	void		End() { fLog.append("</>"); }
+	void		Characters(const XMLParser<StateParser>::String content) {
+				if (fDelimited) fLog.append("[").append(content).append("]");
+				else fLog.append(content);
+				}
+
+	static const StateParser::State gState;
+	static constexpr StateParser::State::Transition gTransitions[2] = {
+			{ "", &gState },
+			{}
+			};
+	};
+
+const StateParser::State Recorder::gState {
+	Recorder::gTransitions,
+	static_cast<void (StateParser::Response::*)(const XMLParser<StateParser>::String)>(&Recorder::Start),
+	static_cast<void (StateParser::Response::*)()>(&Recorder::End),
+	static_cast<void (StateParser::Response::*)(const XMLParser<StateParser>::String)>(&Recorder::Characters)
+	};
+
+
+
+TEST_CLASS(TestParseXML) {
+protected:
+	/*	Global
+		Put a response into a global memory handle, as CHTTPClient::Response::Content() would
+	*/
+	static HGLOBAL Global(const std::string &document) {
+		const HGLOBAL result = GlobalAlloc(GMEM_MOVEABLE, document.size());
+		memcpy(GlobalLock(result), document.data(), document.size());
+		GlobalUnlock(result);
+		return result;
+		}
+
+
+	/*	Load
+		Read a recorded response
+	*/
+	static HGLOBAL Load(const char name[]) {
+		std::ifstream ifs(name, std::ios::binary);
+		Assert::IsTrue(ifs.is_open());
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		return Global(ss.str());
+		}
+
+
+	/*	Record
+		Parse the document with the given parser, and return what it saw
+	*/
+	template <template <class> class Parser>
+	static std::string Record(HGLOBAL document) {
+		Recorder recorder;
+		StateParser events(Recorder::gState, recorder);
+		Parser<StateParser> parser(events);
+		parser(document);
+		return recorder.fLog;
+		}
+
+
+	/*	Time
+		Return the average time it takes the given parser to parse the document
+	*/
+	template <template <class> class Parser>
+	static std::chrono::microseconds Time(HGLOBAL document) {
+		constexpr unsigned kIterations = 100;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < kIterations; i++) Record<Parser>(document);
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start) / kIterations;
+		}
+
+
+	/*	Compare
+		Check that both parsers see the same, and report how long they take
+	*/
+	static void Compare(const char name[]) {
+		const HGLOBAL document = Load(name);
+
+		Assert::IsTrue(Record<XMLParser>(document) == Record<XMLLiteParser>(document));
+
+		const std::chrono::microseconds
+			tokenizer = Time<XMLParser>(document),
+			xmlLite = Time<XMLLiteParser>(document);
+		Logger::WriteMessage(std::format("{}: {} bytes, tokenizer {} us, XmlLite {} us\n", name, GlobalSize(document), tokenizer.count(), xmlLite.count()).c_str());
+
+		GlobalFree(document);
+		}
+
+
+	/*	Find
+		Parse a PROPFIND response for a few properties, either way; and return what was found
+	*/
+	template <bool compiled>
+	static std::string Find(HGLOBAL document) {
+		std::string log;
+
+		WebDAV::Basic response {
+			WebDAV::Find::Query(
+				WebDAV::Response(
+					WebDAV::HREF([&log](const std::string_view href) { log.append(href).append(":"); }),
+					WebDAV::End([&log]() { log.append("\n"); })
+					),
+				WebDAV::Find::ETag([&log](const std::string_view etag) { log.append(" ").append(etag); }),
+				WebDAV::Find::DisplayName([&log](const std::string_view name) { log.append(" ").append(name); }),
+				WebDAV::Find::ContentType([&log](const std::string_view type) { log.append(" ").append(type); })
+				)
+			};
+
+		if constexpr (compiled)
+			response.Execute(document);
+		else
+			response.Interpret(document);
+
+		return log;
+		}
+
+public:
+	TestParseXML() {
+		// set current directory to where the test data is
+		// *** somehow pick this up from environment or such
+		if (!SetCurrentDirectory(L"L:\\\\Ben\\Documents\\Projects\\Time Management\\")) throw GetLastError();
+		}
+
+
+	/*	Multistatus responses to calendar-multiget, as recorded from the respective servers */
+	TEST_METHOD(CompareICloud) { Compare("icloud-multiget.xml"); }
+	TEST_METHOD(CompareSabreDAV) { Compare("sabredav-multiget.xml"); }
+
+
+	/*	Resumable
+		Parsing a byte at a time must see the same as parsing all at once
+	*/
+	TEST_METHOD(Resumable) {
+		const HGLOBAL document = Load("icloud-multiget.xml");
+		const std::string whole = Record<XMLParser>(document);
+
+		const char *const data = static_cast<const char*>(GlobalLock(document));
+		const size_t dataL = GlobalSize(document);
+		size_t at = 0;
+
+		Recorder recorder;
+		StateParser events(Recorder::gState, recorder);
+		XMLParser<StateParser> parser(events);
+		parser(
+			XMLParser<StateParser>::Receiver(
+				[&](void *buffer, size_t bufferL) -> size_t {
+					if (at == dataL) return 0;
+					*static_cast<char*>(buffer) = data[at++];
+					return 1;
+					}
+				)
+			);
+
+		GlobalUnlock(document);
+		GlobalFree(document);
+
+		Assert::IsTrue(recorder.fLog == whole);
+		}
+
+
+	/*	Chunked
+		However the document is split up as it arrives, the events must be the same as when
+		it's parsed whole; in particular, comments and processing instructions don't split up text
+	*/
+	TEST_METHOD(Chunked) {
+		const std::string document =
+			R"(<?xml version="1.0"?><D:multistatus xmlns:D="DAV:"><D:a>>  <?pi x?>&#233;<!-- c --><D:b/>text<?pi x?>)" "\r\n"
+			R"(<?pi x?></D:a><D:a> <![CDATA[ y ]]>)" "\r\n" R"( z &amp;<!---->)" "\r" R"(</D:a></D:multistatus>)";
+
+		// parse the document as it's received, no more than so many bytes at a time
+		const auto Events = [&document](size_t pieceL) {
+			Recorder recorder;
+			recorder.fDelimited = true;
+			StateParser events(Recorder::gState, recorder);
+			XMLParser<StateParser> parser(events);
+
+			size_t at = 0;
+			parser(
+				XMLParser<StateParser>::Receiver(
+					[&](void *buffer, size_t bufferL) -> size_t {
+						const size_t length = std::min({ pieceL, bufferL, document.size() - at });
+						memcpy(buffer, document.data() + at, length);
+						at += length;
+						return length;
+						}
+					)
+				);
+
+			return recorder.fLog;
+			};
+
+		const std::string whole = Events(document.size());
+		Assert::IsTrue(whole == "<multistatus><a>[>  \xC3\xA9]<b></>[text\n]</><a>[ y ][\n z &\n]</></>");
+
+		for (size_t pieceL = 1; pieceL <= 7; pieceL++)
+			Assert::IsTrue(Events(pieceL) == whole);
+		}
+
+
+	/*	Compiled
+		The compiled states must find the same as the state tables; and report how long both take
+		on a PROPFIND response for a large collection
+	*/
+	TEST_METHOD(Compiled) {
+		std::string multistatus = R"(<?xml version="1.0" encoding="utf-8"?><D:multistatus xmlns:D="DAV:">)";
+		for (unsigned i = 0; i < 10000; i++)
+			multistatus += std::format(
+				R"(<D:response><D:href>/calendars/user/calendar/{0}.ics</D:href><D:propstat><D:prop>)"
+				R"(<D:getetag>"{0}"</D:getetag><D:displayname>Item {0}</D:displayname><D:getcontenttype>text/calendar</D:getcontenttype>)"
+				R"(<D:getlastmodified/></D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat>)"
+				R"(<D:propstat><D:prop><D:resourcetype/></D:prop><D:status>HTTP/1.1 404 Not Found</D:status></D:propstat></D:response>)",
+				i
+				);
+		multistatus += "</D:multistatus>";
+		const HGLOBAL document = Global(multistatus);
+
+		const std::string found = Find<false>(document);
+		Assert::IsTrue(found.starts_with("/calendars/user/calendar/0.ics: \"0\" Item 0 text/calendar\n"));
+		Assert::IsTrue(Find<true>(document) == found);
+
+		constexpr unsigned kIterations = 20;
+		auto Time = [document](std::string (*F)(HGLOBAL)) {
+			const auto start = std::chrono::steady_clock::now();
+			for (unsigned i = 0; i < kIterations; i++) F(document);
+			return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start) / kIterations;
+			};
+		const std::chrono::microseconds
+			tables = Time(Find<false>),
+			compiled = Time(Find<true>);
+		Logger::WriteMessage(std::format("10000 responses: tables {} us, compiled {} us\n", tables.count(), compiled.count()).c_str());
+
+		GlobalFree(document);
+		}
+	};
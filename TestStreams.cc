@@ -1,10 +1,16 @@
+#include <chrono>
+#include <format>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 #include "CppUnitTest.h"
 
+#include "AdaptableStreamBuffer.h"
 #include "HTTPClient.h"
 #include "HTTPStreamBuf.h"
+#include "Inflate.h"
+#include "Transcode.h"
 
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -12,6 +18,70 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 
 TEST_CLASS(TestStreams) {
+protected:
+	/*	Memory
+		Adapter that delivers a string in pieces the size of a network packet
+	*/
+	struct Memory {
+		static constexpr unsigned
+				kOverflowNumerator = 1,
+				kOverflowDenominator = 1;
+		
+		const std::string &fData;
+		size_t		fAt;
+		
+				Memory(const std::string &data) : fData(data), fAt(0) {}
+		
+		size_t		available() { return std::min<size_t>(fData.size() - fAt, 1460); }
+		size_t		house(char *buffer, size_t bufferL) {
+					const size_t housedL = std::min(available(), bufferL);
+					memcpy(buffer, fData.data() + fAt, housedL);
+					fAt += housedL;
+					return housedL;
+					}
+		char		*filter(char *begin, char *end, const char *limit) { return end; }
+		};
+	
+	
+	/*	Unfolding
+		Memory adapter that also removes CRs and unfolds continuation lines, like the HTTP response's
+	*/
+	struct Unfolding : Memory {
+		LineFilter<char> fLines { true };
+		
+				Unfolding(const std::string &data) : Memory(data) {}
+		
+		char		*filter(char *begin, char *end, const char *limit) { return fLines(begin, end, limit); }
+		};
+	
+	
+	/*	Drain
+		Consume everything from the stream buffer the way a line-oriented consumer would:
+		flood it, and take only complete lines
+	*/
+	template <class StreamBuf>
+	static std::string Drain(const std::string &data) {
+		StreamBuf sb(data);
+		std::string result;
+		for (size_t leftL = 0; ; ) {
+			sb.pubsync();
+			if (sb.size() == 0) break;
+			
+			// leave a partial line for next time, unless that's all there is or no more would come
+			const std::string_view present(sb.data(), sb.size());
+			const size_t lineE = present.rfind('\n');
+			const size_t takenL =
+				lineE != std::string_view::npos ? lineE + 1 :
+				present.size() == leftL ? present.size() :
+				0;
+			result.append(sb.data(), takenL);
+			sb.claimed(takenL);
+			leftL = present.size() - takenL;
+			}
+		return result;
+		}
+	
+	
 public:
 	TestStreams() {
 		// set current directory to where the test data is
@@ -111,4 +181,153 @@ public:
 				}
 			);
 		}
+	
+	
+	/*	Transcode
+		Convert UTF-8 to wide characters and back, when it arrives a byte at a time
+	*/
+	TEST_METHOD(Transcode) {
+		// ASCII long enough for the vector path, and a character of each length
+		const std::string narrow = "DESCRIPTION:Quarterly review with the team in Z\xC3\xBCrich \xE2\x82\xAC \xF0\x9F\x93\x85";
+		
+		std::wstring wide;
+		std::string pending;
+		for (const char c: narrow) {
+			pending.push_back(c);
+			
+			wchar_t buffer[4];
+			size_t pendingL = pending.size();
+			wide.append(buffer, DecodeUTF8(pending.data(), pendingL, buffer, std::size(buffer)));
+			pending.erase(0, pendingL);
+			}
+		Assert::IsTrue(pending.empty());
+		Assert::IsTrue(wide.size() == narrow.size() - 1 - 2 - (sizeof(wchar_t) == 2 ? 2 : 3));
+		
+		std::string result(wide.size() * kUTF8PerWide, '\0');
+		size_t wideL = wide.size();
+		result.resize(EncodeUTF8(wide.data(), wideL, result.data()));
+		Assert::IsTrue(wideL == wide.size());
+		Assert::IsTrue(result == narrow);
+		
+		// ill-formed: overlong, surrogate, beyond U+10FFFF
+		for (const char *const invalid: { "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80" })
+			Assert::ExpectException<const char*>([invalid]() {
+				wchar_t buffer[4];
+				size_t invalidL = strlen(invalid);
+				DecodeUTF8(invalid, invalidL, buffer, std::size(buffer));
+				});
+		}
+	
+	
+	/*	Ring
+		The ring buffer must deliver the same as the plain one; and report how long both take
+		on a long response
+	*/
+	TEST_METHOD(Ring) {
+		std::string data;
+		for (unsigned i = 0; i < 400000; i++)
+			data += std::format("DESCRIPTION:Meeting about the quarterly numbers {}\n", i);
+		
+		Assert::IsTrue(Drain<aistreambuf<char, Memory>>(data) == data);
+		Assert::IsTrue(Drain<ristreambuf<char, Memory>>(data) == data);
+		
+		constexpr unsigned kIterations = 10;
+		auto Time = [&data](std::string (*F)(const std::string&)) {
+			const auto start = std::chrono::steady_clock::now();
+			for (unsigned i = 0; i < kIterations; i++) F(data);
+			return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start) / kIterations;
+			};
+		const std::chrono::microseconds
+			plain = Time(Drain<aistreambuf<char, Memory>>),
+			ring = Time(Drain<ristreambuf<char, Memory>>);
+		Logger::WriteMessage(std::format("{} bytes: aistreambuf {} us, ristreambuf {} us\n", data.size(), plain.count(), ring.count()).c_str());
+		}
+	
+	
+	/*	RingCapacity
+		A line end, or a fold, that falls on the capacity of the buffer must come out the same
+		as anywhere else
+	*/
+	TEST_METHOD(RingCapacity) {
+		constexpr size_t kCapacity = 0x1000;
+		
+		for (size_t n = kCapacity - 8; n <= kCapacity; n++) {
+			const std::string line(n, 'a');
+			Assert::IsTrue(Drain<ristreambuf<char, Unfolding, kCapacity>>(line + "\nbbbb") == line + "\nbbbb");
+			Assert::IsTrue(Drain<ristreambuf<char, Unfolding, kCapacity>>(line + "\r\n bbbb\r\nc\r\n") == line + "bbbb\nc\n");
+			}
+		}
+	
+	
+	/*	Chain
+		A request body written into the block chain must come out the same, with CR/LF,
+		in as many segments as it takes
+	*/
+	TEST_METHOD(Chain) {
+		std::wstring body;
+		for (unsigned i = 0; i < 20000; i++)
+			body += std::format(L"DESCRIPTION:Meeting in Z\u00FCrich {}\n\n", i);
+		
+		aostreambuf<wchar_t, CHTTPClient::EncodingOutputAdapter<wchar_t>> osb;
+		std::wostream(&osb) << body;
+		osb.pubsync();
+		
+		std::string expectation;
+		for (unsigned i = 0; i < 20000; i++)
+			expectation += std::format("DESCRIPTION:Meeting in Z\xC3\xBCrich {}\r\n\r\n", i);
+		
+		const auto &narrow = osb.adapter().narrow();
+		size_t segments = 0;
+		narrow.segments([&segments](const char*, size_t) { segments++; });
+		Assert::IsTrue(segments > 1);
+		Assert::IsTrue(narrow.size() == expectation.size());
+		Assert::IsTrue(narrow.str() == expectation);
+		}
+	
+	
+	/*	Inflate
+		Decompress a zlib stream (with dynamic codes) and a gzip one (with fixed codes), when
+		they arrive a byte at a time; and notice when they're damaged
+	*/
+	TEST_METHOD(Inflate) {
+		const std::string zlib(
+			"\x78\xDA\x85\xD2\x3D\x0A\xC2\x40\x14\x00\xE1\x3E\xB0\x77\xF0\x04\x92\xB7\x9B\xBF\x4D\xA5\x21\x8B\xA4\x48\x0A\x35\x01\x4B\x09\x8B"
+			"\x08\x46\x2D\x2C\x3C\xBE\x9D\x85\xC2\x9B\x03\xCC\x54\x5F\x13\x76\xDD\x50\x4F\x61\x0A\xC3\xD1\x24\x63\xD7\xD6\xE9\x26\xBE\xCF\xCB"
+			"\xF3\x16\xD7\xF3\x63\x31\xC9\x61\xEC\xFB\xED\xFE\x54\xF7\x31\xBE\xAE\xF7\xCB\x2A\x35\x49\x18\xDA\x6F\xD1\xFC\xF5\xA2\xF7\x25\xF5"
+			"\x56\xEF\x25\xA3\x81\xD3\x07\x56\x68\x90\xC1\xA0\xA2\x41\xAE\x0F\x5C\x4E\x83\x42\x1F\x64\x96\x06\x25\x0C\x3C\x0D\x2A\x7D\x90\x17"
+			"\x34\xF0\xFA\xA0\x70\xE8\x08\x20\x96\x2C\x91\x28\xA2\x45\x01\x8C\x15\x62\x14\xD0\xE8\x51\xA3\x00\x47\x8F\x1C\x05\x3C\x22\x47\x01"
+			"\x8F\x82\x1E\x05\x40\x0A\x82\x14\x10\x69\x51\xA4\x00\x49\xF7\x43\xF2\x03\x95\x0B\x70\xD0",
+			182
+			);
+		const std::string gzip(
+			"\x1F\x8B\x08\x00\x00\x00\x00\x00\x02\x03\xF3\x48\xCD\xC9\xC9\xD7\x51\xF0\x40\xA2\x14\xB9\x00\xFF\x86\x8A\xEF\x15\x00\x00\x00",
+			31
+			);
+		
+		auto Decompress = [](Inflater::Format format, const std::string &compressed) {
+			size_t at = 0;
+			Inflater inflater(format, [&compressed, &at](void *buffer, size_t) -> size_t {
+				if (at == compressed.size()) return 0;
+				*static_cast<char*>(buffer) = compressed[at++];
+				return 1;
+				});
+			
+			std::string result;
+			char buffer[0x100];
+			while (const size_t length = inflater.Read(buffer, sizeof buffer)) result.append(buffer, length);
+			return result;
+			};
+		
+		std::string expectation;
+		for (unsigned i = 0; i < 20; i++)
+			expectation += std::format("BEGIN:VEVENT\r\nUID:{}@example.com\r\nSUMMARY:Meeting {}\r\nEND:VEVENT\r\n", i, i * 7 % 100);
+		Assert::IsTrue(Decompress(Inflater::kFormatZlib, zlib) == expectation);
+		Assert::IsTrue(Decompress(Inflater::kFormatGzip, gzip) == "Hello, Hello, Hello!\n");
+		
+		// damaged check; cut short
+		std::string damaged = gzip;
+		damaged[damaged.size() - 5] ^= 1;
+		Assert::ExpectException<const char*>([&]() { Decompress(Inflater::kFormatGzip, damaged); });
+		Assert::ExpectException<const char*>([&]() { Decompress(Inflater::kFormatZlib, zlib.substr(0, 100)); });
+		}
 	};
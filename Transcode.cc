@@ -0,0 +1,333 @@
+/*
+	Transcode
+
+	Conversion between UTF-8 and native wide characters
+
+	2023/06/15	Originated
+
+	Copyright © 2023 by: Ben Hekster
+
+	REFERENCES:
+		RFC 3629 UTF-8, a transformation format of ISO 10646
+		RFC 2781 UTF-16, an encoding of ISO 10646
+*/
+
+#include <bit>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSCODE_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSCODE_SSE2
+#endif
+
+#include "Transcode.h"
+
+
+
+/*
+
+	ASCII runs
+
+*/
+
+/*	WidenASCII
+	Widen the run of ASCII at the start of the input, as far as there is input and
+	output space; advance both past it
+*/
+static inline void WidenASCII(
+	const unsigned char *&n,
+	const unsigned char *const nE,
+	wchar_t		*&w,
+	wchar_t		*const wE
+	)
+{
+#if defined(TRANSCODE_AVX2)
+while (nE - n >= 32 && wE - w >= 32) {
+	const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(n));
+
+	// stop short of the first byte that isn't ASCII
+	if (const unsigned high = static_cast<unsigned>(_mm256_movemask_epi8(v))) {
+		const unsigned ascii = std::countr_zero(high);
+		for (unsigned i = 0; i < ascii; i++) *w++ = *n++;
+		return;
+		}
+
+	if constexpr (sizeof(wchar_t) == 2) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(w), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(w + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+		}
+
+	else
+		for (unsigned i = 0; i < 32; i += 8)
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i*>(w + i),
+				_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(n + i)))
+				);
+
+	n += 32, w += 32;
+	}
+#endif
+
+#if defined(TRANSCODE_SSE2)
+const __m128i zero = _mm_setzero_si128();
+while (nE - n >= 16 && wE - w >= 16) {
+	const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(n));
+
+	if (const unsigned high = static_cast<unsigned>(_mm_movemask_epi8(v))) {
+		const unsigned ascii = std::countr_zero(high);
+		for (unsigned i = 0; i < ascii; i++) *w++ = *n++;
+		return;
+		}
+
+	const __m128i
+		lo = _mm_unpacklo_epi8(v, zero),
+		hi = _mm_unpackhi_epi8(v, zero);
+	if constexpr (sizeof(wchar_t) == 2) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w + 8), hi);
+		}
+
+	else {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w), _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w + 4), _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w + 8), _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(w + 12), _mm_unpackhi_epi16(hi, zero));
+		}
+
+	n += 16, w += 16;
+	}
+#endif
+
+// the rest a character at a time
+while (n < nE && w < wE && *n < 0x80) *w++ = *n++;
+}
+
+
+/*	NarrowASCII
+	Narrow the run of ASCII at the start of the input; advance both past it
+	The output must have room for all of the input
+*/
+static inline void NarrowASCII(
+	const wchar_t	*&w,
+	const wchar_t	*const wE,
+	unsigned char	*&n
+	)
+{
+#if defined(TRANSCODE_AVX2)
+while (wE - w >= 32) {
+	const __m256i *const p = reinterpret_cast<const __m256i*>(w);
+	__m256i packed;
+
+	if constexpr (sizeof(wchar_t) == 2) {
+		const __m256i
+			a = _mm256_loadu_si256(p),
+			b = _mm256_loadu_si256(p + 1);
+		if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_set1_epi16(static_cast<short>(0xFF80)))) break;
+
+		// packing works within 128-bit lanes, so put the quarters back in order
+		packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+		}
+
+	else {
+		const __m256i
+			a = _mm256_loadu_si256(p),
+			b = _mm256_loadu_si256(p + 1),
+			c = _mm256_loadu_si256(p + 2),
+			d = _mm256_loadu_si256(p + 3);
+		if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)), _mm256_set1_epi32(static_cast<int>(0xFFFFFF80)))) break;
+
+		packed = _mm256_permutevar8x32_epi32(
+			_mm256_packus_epi16(_mm256_packus_epi32(a, b), _mm256_packus_epi32(c, d)),
+			_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)
+			);
+		}
+
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(n), packed);
+	w += 32, n += 32;
+	}
+#endif
+
+#if defined(TRANSCODE_SSE2)
+const __m128i zero = _mm_setzero_si128();
+while (wE - w >= 16) {
+	const __m128i *const p = reinterpret_cast<const __m128i*>(w);
+	__m128i packed;
+
+	if constexpr (sizeof(wchar_t) == 2) {
+		const __m128i
+			a = _mm_loadu_si128(p),
+			b = _mm_loadu_si128(p + 1),
+			high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF) break;
+
+		packed = _mm_packus_epi16(a, b);
+		}
+
+	else {
+		const __m128i
+			a = _mm_loadu_si128(p),
+			b = _mm_loadu_si128(p + 1),
+			c = _mm_loadu_si128(p + 2),
+			d = _mm_loadu_si128(p + 3),
+			high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF) break;
+
+		// all below 0x80, so signed saturation doesn't come into it
+		packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(n), packed);
+	w += 16, n += 16;
+	}
+#endif
+
+while (w < wE && static_cast<std::make_unsigned_t<wchar_t>>(*w) < 0x80) *n++ = static_cast<unsigned char>(*w++);
+}
+
+
+
+/*
+
+	UTF-8
+
+*/
+
+/*	DecodeUTF8
+	Decode the complete UTF-8 sequences in the given buffer, as far as they fit in the
+	wide buffer; return the number of wide characters produced and set 'narrowL' to the
+	number of bytes consumed
+	An incomplete sequence at the end is left unconsumed.  Throws on ill-formed UTF-8:
+	overlong forms, surrogates and code points beyond U+10FFFF included.
+*/
+size_t DecodeUTF8(
+	const char	narrow[],
+	size_t		&narrowL,
+	wchar_t		wide[],
+	size_t		wideL
+	)
+{
+const unsigned char
+	*n = reinterpret_cast<const unsigned char*>(narrow),
+	*const nE = n + narrowL;
+wchar_t
+	*w = wide,
+	*const wE = wide + wideL;
+
+for (;;) {
+	WidenASCII(n, nE, w, wE);
+	if (n == nE || w == wE) break;
+
+	// multi-byte sequence; the lead byte determines its length and the valid range of the next byte
+	const unsigned char lead = *n;
+	unsigned length;
+	unsigned char low = 0x80, high = 0xBF;
+	if (lead < 0xC2) throw "invalid UTF-8 lead byte";
+	else if (lead < 0xE0) length = 2;
+	else if (lead < 0xF0) {
+		length = 3;
+		if (lead == 0xE0) low = 0xA0;		// overlong
+		else if (lead == 0xED) high = 0x9F;	// surrogate
+		}
+	else if (lead < 0xF5) {
+		length = 4;
+		if (lead == 0xF0) low = 0x90;		// overlong
+		else if (lead == 0xF4) high = 0x8F;	// beyond U+10FFFF
+		}
+	else throw "invalid UTF-8 lead byte";
+
+	// incomplete sequence at the end?  leave it for next time
+	if (static_cast<size_t>(nE - n) < length) {
+		// but not if what there is of it is already wrong
+		if (n + 1 < nE && (n[1] < low || n[1] > high)) throw "invalid UTF-8 continuation byte";
+		break;
+		}
+
+	// room for it?
+	if (sizeof(wchar_t) == 2 && length == 4 && wE - w < 2) break;
+
+	if (n[1] < low || n[1] > high) throw "invalid UTF-8 continuation byte";
+	char32_t c = lead & (0x7F >> length);
+	for (unsigned i = 1; i < length; i++) {
+		if ((n[i] & 0xC0) != 0x80) throw "invalid UTF-8 continuation byte";
+		c = c << 6 | (n[i] & 0x3F);
+		}
+	n += length;
+
+	// split into UTF-16 surrogate pair
+	if (sizeof(wchar_t) == 2 && c >= 0x10000) {
+		*w++ = static_cast<wchar_t>(0xD800 + ((c - 0x10000) >> 10));
+		*w++ = static_cast<wchar_t>(0xDC00 + ((c - 0x10000) & 0x3FF));
+		}
+
+	else
+		*w++ = static_cast<wchar_t>(c);
+	}
+
+narrowL = n - reinterpret_cast<const unsigned char*>(narrow);
+return w - wide;
+}
+
+
+/*	EncodeUTF8
+	Encode wide characters as UTF-8 into the given buffer, which must have room for
+	kUTF8PerWide bytes per character; return the number of bytes produced and set 'wideL'
+	to the number of wide characters consumed
+	A UTF-16 high surrogate at the end is left unconsumed, since its partner may be yet to
+	come.  Throws on unpaired surrogates and on code points beyond U+10FFFF.
+*/
+size_t EncodeUTF8(
+	const wchar_t	wide[],
+	size_t		&wideL,
+	char		narrow[]
+	)
+{
+const wchar_t
+	*w = wide,
+	*const wE = wide + wideL;
+unsigned char *n = reinterpret_cast<unsigned char*>(narrow);
+
+for (;;) {
+	NarrowASCII(w, wE, n);
+	if (w == wE) break;
+
+	char32_t c = static_cast<std::make_unsigned_t<wchar_t>>(*w);
+
+	if (c >= 0xD800 && c < 0xE000) {
+		// combine UTF-16 surrogate pair
+		if (sizeof(wchar_t) != 2 || c >= 0xDC00) throw "invalid UTF-16 surrogate";
+		if (w + 1 == wE) break;
+		if (w[1] < 0xDC00 || w[1] >= 0xE000) throw "invalid UTF-16 surrogate";
+		c = 0x10000 + ((c - 0xD800) << 10) + (static_cast<char32_t>(w[1]) - 0xDC00);
+		w++;
+		}
+	w++;
+
+	if (c < 0x800) {
+		*n++ = static_cast<unsigned char>(0xC0 | c >> 6);
+		*n++ = static_cast<unsigned char>(0x80 | (c & 0x3F));
+		}
+
+	else if (c < 0x10000) {
+		*n++ = static_cast<unsigned char>(0xE0 | c >> 12);
+		*n++ = static_cast<unsigned char>(0x80 | (c >> 6 & 0x3F));
+		*n++ = static_cast<unsigned char>(0x80 | (c & 0x3F));
+		}
+
+	else if (c < 0x110000) {
+		*n++ = static_cast<unsigned char>(0xF0 | c >> 18);
+		*n++ = static_cast<unsigned char>(0x80 | (c >> 12 & 0x3F));
+		*n++ = static_cast<unsigned char>(0x80 | (c >> 6 & 0x3F));
+		*n++ = static_cast<unsigned char>(0x80 | (c & 0x3F));
+		}
+
+	else throw "invalid character";
+	}
+
+wideL = w - wide;
+return n - reinterpret_cast<unsigned char*>(narrow);
+}
@@ -0,0 +1,166 @@
+/*
+	Transcode
+
+	Conversion between UTF-8 and native wide characters
+
+	2023/06/15	Originated
+
+	Copyright © 2023 by: Ben Hekster
+
+	Native wide characters are UTF-16 on Windows, and UTF-32 elsewhere.  Both directions
+	validate as they convert, in a single pass over the data.  Runs of ASCII, which is
+	nearly all there is in an iCalendar body, are converted a vector at a time where the
+	processor allows.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <functional>
+
+
+
+/*	kUTF8PerWide
+	Most UTF-8 bytes any one wide character may take
+	(A UTF-16 surrogate pair takes four, but that's two wide characters)
+*/
+constexpr size_t kUTF8PerWide = sizeof(wchar_t) == 2 ? 3 : 4;
+
+
+size_t		DecodeUTF8(const char narrow[], size_t &narrowL, wchar_t wide[], size_t wideL);
+size_t		EncodeUTF8(const wchar_t wide[], size_t &wideL, char narrow[]);
+
+
+
+/*	UTF8DecodingAdapter
+	Stream buffer adapter that presents the UTF-8 in a narrow-character input stream buffer
+	(which does the actual input, and any filtering) as wide characters
+*/
+template <class NarrowBuffer>
+struct UTF8DecodingAdapter {
+protected:
+	NarrowBuffer	fNarrow;
+
+public:
+	// fraction of buffer space that may be needed to properly filter some amount of input (1/1)
+	static constexpr unsigned
+			kOverflowNumerator = 1,
+			kOverflowDenominator = 1;
+
+
+	template <class Source>
+	explicit	UTF8DecodingAdapter(Source &source) : fNarrow(source) {}
+
+	size_t		available();
+	size_t		house(wchar_t*, size_t);
+	wchar_t		*filter(wchar_t*, wchar_t *end, const wchar_t*) { return end; }
+	};
+
+
+/*	UTF8EncodingAdapter
+	Stream buffer adapter that converts wide characters into UTF-8 in a narrow-character output
+	stream buffer (which does any filtering); and passes that on as it's made, if given a sink
+*/
+template <class NarrowBuffer>
+struct UTF8EncodingAdapter {
+protected:
+	// most wide characters to convert into the narrow buffer at a time
+	static constexpr size_t kEvictPiece = 0x100;
+
+	// how much narrow data to pass on at a time, when streaming
+	static constexpr size_t kStreamChunk = 0x8000;
+
+	NarrowBuffer	fNarrow;
+
+	// where the narrow data goes as it's made, if it's streamed rather than kept
+	const std::function<void (const void*, size_t)> *const fSink;
+
+public:
+			UTF8EncodingAdapter() : fSink(nullptr) {}
+	explicit	UTF8EncodingAdapter(const std::function<void (const void*, size_t)> &sink) : fSink(&sink) {}
+
+	NarrowBuffer	&narrow() { return fNarrow; }
+
+	size_t		evict(const wchar_t*, size_t);
+	wchar_t		*filter(wchar_t*, wchar_t *end, const wchar_t*) { return end; }
+	};
+
+
+
+/*	available
+	Return how many characters are available to be read from the associated character sequence
+	No more than there are bytes, since no UTF-8 byte decodes to more than one wide character
+	(those that decode to a UTF-16 surrogate pair take four); so no need to look at them yet
+*/
+template <class NarrowBuffer>
+size_t UTF8DecodingAdapter<NarrowBuffer>::available()
+{
+// flood narrow character input stream buffer
+fNarrow.pubsync();
+
+// but room for a whole surrogate pair, even if only the start of its sequence has arrived so far
+return fNarrow.size() ? std::max<size_t>(fNarrow.size(), 2) : 0;
+}
+
+
+/*	house
+	Make input characters available at the given buffer; return the number of
+	characters produced
+*/
+template <class NarrowBuffer>
+size_t UTF8DecodingAdapter<NarrowBuffer>::house(
+	wchar_t		*buffer,
+	size_t		bufferL
+	)
+{
+// convert from UTF-8
+/* An incomplete sequence at the end remains in the narrow buffer until the rest of it arrives */
+size_t narrowL = fNarrow.size();
+size_t wideL = DecodeUTF8(fNarrow.data(), narrowL, buffer, bufferL);
+
+// nothing but an incomplete sequence, though there's room for any character?  wait for the rest of it
+while (wideL == 0 && narrowL == 0 && bufferL >= 2 && fNarrow.size() > 0) {
+	const size_t incompleteL = fNarrow.size();
+	fNarrow.pubsync();
+	if (fNarrow.size() == incompleteL) throw "incomplete UTF-8 sequence";
+
+	narrowL = fNarrow.size();
+	wideL = DecodeUTF8(fNarrow.data(), narrowL, buffer, bufferL);
+	}
+
+// narrow-character data was consumed
+fNarrow.claimed(narrowL);
+
+return wideL;
+}
+
+
+/*	evict
+	Transform buffered wide-character data into the narrow-character buffer
+*/
+template <class NarrowBuffer>
+size_t UTF8EncodingAdapter<NarrowBuffer>::evict(
+	const wchar_t	*data,
+	size_t		dataL
+	)
+{
+// a piece at a time, so the narrow buffer isn't asked for more than a fraction of a block
+size_t evictedL = 0;
+while (evictedL < dataL) {
+	// convert to UTF-8 into space for the worst case
+	size_t pieceL = std::min<size_t>(dataL - evictedL, kEvictPiece);
+	char *const narrow = fNarrow.reserve(pieceL * kUTF8PerWide);
+	fNarrow.used(EncodeUTF8(data + evictedL, pieceL, narrow));
+
+	// a high surrogate at the end stays behind until its partner is written
+	if (pieceL == 0) break;
+	evictedL += pieceL;
+	}
+
+// pass it on as soon as there's enough of it, if streaming
+if (fSink && fNarrow.size() >= kStreamChunk) fNarrow.drain(*fSink);
+
+return evictedL;
+}
@@ -5,7 +5,7 @@
 	
 	2023/05/20	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 */
 
 #include <malloc.h>
@@ -46,7 +46,7 @@ FormatString(
 				
 				#else
 				// present the response as a C++ stream buffer
-				aistreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(httpResponse);
+				ristreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(httpResponse);
 				
 				// print to standard output
 				std::wcout << &isb;
@@ -63,32 +63,32 @@ FormatString(
 	Add the given supported report to the set
 */
 void VersioningDAV::SupportedReports::Add(
-	const wchar_t	report[]
+	const std::string_view report
 	)
 {
 // expected supported reports
 static const struct ReportFlag {
-	const wchar_t	*name;
+	const char	*name;
 	bool		(SupportedReports::*flag);
 	} reports[] = {
-	{ L"acl-principal-prop-set", &SupportedReports::fACLPrincipalPropSet },
-	{ L"principal-match", &SupportedReports::fPrincipalMatch },
-	{ L"principal-property-search", &SupportedReports::fPrincipalPropertySearch },
-	{ L"expand-property", &SupportedReports::fExpandProperty },
-	{ L"calendarserver-principal-search", &SupportedReports::fCalendarServerPrincipalSearch },
-	{ L"calendar-query", &SupportedReports::fCalendarQuery },
-	{ L"calendar-multiget", &SupportedReports::fCalendarMultiGet },
-	{ L"free-busy-query", &SupportedReports::fFreeBusyQuery },
-	{ L"addressbook-query", &SupportedReports::fAddressbookQuery },
-	{ L"addressbook-multiget", &SupportedReports::fAddressbookMultiGet },
-	{ L"sync-collection", &SupportedReports::fSyncCollection }
+	{ "acl-principal-prop-set", &SupportedReports::fACLPrincipalPropSet },
+	{ "principal-match", &SupportedReports::fPrincipalMatch },
+	{ "principal-property-search", &SupportedReports::fPrincipalPropertySearch },
+	{ "expand-property", &SupportedReports::fExpandProperty },
+	{ "calendarserver-principal-search", &SupportedReports::fCalendarServerPrincipalSearch },
+	{ "calendar-query", &SupportedReports::fCalendarQuery },
+	{ "calendar-multiget", &SupportedReports::fCalendarMultiGet },
+	{ "free-busy-query", &SupportedReports::fFreeBusyQuery },
+	{ "addressbook-query", &SupportedReports::fAddressbookQuery },
+	{ "addressbook-multiget", &SupportedReports::fAddressbookMultiGet },
+	{ "sync-collection", &SupportedReports::fSyncCollection }
 	};
 
 // find it
 if (
 	const ReportFlag *const reportFlag = std::find_if(
 		std::begin(reports), std::end(reports),
-		[report](const ReportFlag &rf) { return std::wcscmp(report, rf.name) == 0; }
+		[report](const ReportFlag &rf) { return report == rf.name; }
 		);
 	reportFlag != std::end(reports)
 	)
@@ -5,7 +5,7 @@
 	
 	2023/05/20	Originated
 	
-	Copyright  2023 by: Ben Hekster
+	Copyright © 2023 by: Ben Hekster
 	
 	RFC 3253	Versioning Extensions to WebDAV (Web Distributed Authoring and Versioning)
 	
@@ -53,7 +53,7 @@ namespace VersioningDAV {
 				fAddressbookMultiGet {},
 				fSyncCollection {};
 		
-		void		Add(const wchar_t[]);
+		void		Add(std::string_view);
 		};
 	};
 
@@ -62,17 +62,17 @@ namespace VersioningDAV {
 	Identify reports supported by the resource
 	Example of a property with multiple level internal structure; and the internal structure
 	consists of unpredictable XML elements
-	RFC 3253 3.1.5
+	RFC 3253 §3.1.5
 */
 template <typename Callable>
 struct VersioningDAV::SupportedReportSet : public StateParser::Response {
 protected:
 	Callable	FTag;
 	
-	void		Begin(const wchar_t content[]) { FTag(content); }
+	void		Begin(const XMLParser<StateParser>::String content) { Deliver(FTag, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"supported-report-set";
+	static constexpr char tag[] = "supported-report-set";
 	static constexpr std::wstring_view gXML = L"<D:supported-report-set/>";
 	
 	
@@ -90,7 +90,7 @@ public:
 			};
 	
 	static constexpr StateParser::State::Transition gTransitionsFromReport[2] = {
-			{ L"", &gStateAnything },
+			{ "", &gStateAnything },
 			{}
 			};
 	
@@ -99,7 +99,7 @@ public:
 			};
 	
 	static constexpr StateParser::State::Transition gTransitionsFromSupportedReport[2] = {
-			{ L"report", &gStateReport },
+			{ "report", &gStateReport },
 			{}
 			};
 	
@@ -108,7 +108,7 @@ public:
 			};
 	
 	static constexpr StateParser::State::Transition gTransitionsFromState[2] = {
-			{ L"supported-report", &gStateSupportedReport },
+			{ "supported-report", &gStateSupportedReport },
 			{}
 			};
 	
@@ -6,7 +6,7 @@
 	2018/09/09	Originated
 	2023/03/15	Factored from base class DAV
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 */
 
 #include <ctype.h>
@@ -27,8 +27,8 @@
 /*	Find::All
 	Get 'all properties' of the corresponding resource
 	
-	See [RFC 4918 9.1, 14.2, and Appendix F] for some background on what this actually does,
-	replacing an older definition in [RFC 2518 12.14.1]
+	See [RFC 4918 §9.1, §14.2, and Appendix F] for some background on what this actually does,
+	replacing an older definition in [RFC 2518 §12.14.1]
 	
 	The interface returns the HTTP response because there doesn't seem to be anything
 	reasonable that is more specific.  In general, we can't really XML parse it since we
@@ -51,7 +51,7 @@ DAV::PropertyFind(
 
 
 /*	MakeCollection
-	Make WebDAV collection 9.3
+	Make WebDAV collection §9.3
 	*** actually this has calendar stuff in it too
 */
 void WebDAV::MakeCollection(
@@ -70,7 +70,7 @@ FormatString(
 		aostreambuf<wchar_t, CHTTPClient::EncodingOutputAdapter<wchar_t>> osb;
 		std::wostream(&osb) << body;
 		osb.pubsync();
-		const std::string_view narrow(osb.adapter().narrow().data(), osb.adapter().narrow().size());
+		const std::string narrow = osb.adapter().narrow().str();
 		
 		// make DAV request
 		DAV::MakeCollection(
@@ -78,7 +78,7 @@ FormatString(
 			// response
 			[](CHTTPClient::Response &response) {
 				// present the response as a C++ stream
-				aistreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(response);
+				ristreambuf<wchar_t, CHTTPClient::DecodingInputAdapter<wchar_t>> isb(response);
 		
 				std::wcout << &isb;
 				}
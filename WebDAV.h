@@ -8,7 +8,7 @@
 	2018/09/09	Originated
 	2023/03/15	Factored from base class DAV
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 	
 	RFC 4918	HTTP Extensions for Web Distributed Authoring and Versioning (WebDAV)
 	
@@ -49,6 +49,9 @@ namespace WebDAV {
 	template <typename Callable>
 	struct HREF;
 	
+	template <typename Callable>
+	struct Status;
+	
 	template <typename Callable>
 	struct Begin;
 	
@@ -59,7 +62,7 @@ namespace WebDAV {
 	struct Response;
 	
 	
-	// PROPFIND 9.1
+	// PROPFIND §9.1
 	namespace Find {
 		void		All(CHTTPClient&, const wchar_t path[], Depth, const std::function<void (CHTTPClient::Response&)>&);
 		
@@ -101,7 +104,7 @@ namespace WebDAV {
 		}
 	
 	
-	// PROPPATCH 9.2
+	// PROPPATCH §9.2
 	namespace Patch {
 		template <class A, class SR, typename... Ts>
 		void		Properties(
@@ -122,7 +125,7 @@ namespace WebDAV {
 		struct DisplayName;
 		}
 	
-	// MKCOL 9.3
+	// MKCOL §9.3
 	void		MakeCollection(CHTTPClient&, const wchar_t path[], const wchar_t name[]);
 	};
 
@@ -257,7 +260,19 @@ template <typename Callable>
 struct WebDAV::HREF {
 	Callable	c;
 	
-	void		RespondHREF(const wchar_t href[]) { c(href); }
+	void		RespondHREF(const XMLParser<StateParser>::String href) { Deliver(c, href); }
+	};
+
+
+/*	Status
+	Status of the response as a whole, rather than of its properties; as when a member has
+	been removed from a synchronized collection [RFC 6578 §3.5]
+*/
+template <typename Callable>
+struct WebDAV::Status {
+	Callable	c;
+	
+	void		RespondStatus(const XMLParser<StateParser>::String status) { Deliver(c, status); }
 	};
 
 
@@ -301,20 +316,28 @@ struct WebDAV::Response<> {
 		</propstat>
 	</response>
 	
+	or, without properties:
+	
+	<response>
+		<href>/calendars/__uids__/B1206638-BF02-404E-A9D4-B9BC3107C01C/calendar/1.ics</href>
+		<status>HTTP/1.1 404 Not Found</status>
+	</response>
+	
 	The structures under <prop> are provided by the 'PT' template argument
 	(which is expected to be a PropertyTransitions).
 	
-	Handlers for the begin and end tags of <response> and for the content of <href> are provided
-	by the 'A' template argument (which is expected to be a Response).
+	Handlers for the begin and end tags of <response> and for the content of <href> and of the
+	response <status> are provided by the 'A' template argument (which is expected to be a Response).
 */
 template <class A, class PT>
 struct WebDAV::Multistatus : StateParser::Response {
 	A		fAdapter;
 	
-	/* These three functions can only compile if the adapter actually provides the respective
+	/* These functions can only compile if the adapter actually provides the respective
 	   operations; however they will only actually be instantiated if the corresponding State
 	   pointer-to-member refers to them when the 'constexpr-if' evaluation says they exist. */
 	void		RespondHREF(const XMLParser<StateParser>::String href) { fAdapter.RespondHREF(href); }
+	void		RespondStatus(const XMLParser<StateParser>::String status) { fAdapter.RespondStatus(status); }
 	void		RespondBegin(const XMLParser<StateParser>::String href) { fAdapter.RespondBegin(); }
 	void		RespondEnd() { fAdapter.RespondEnd(); }
 	
@@ -330,7 +353,7 @@ struct WebDAV::Multistatus : StateParser::Response {
 					   the pointer to member, and always invoke a virtual function to decide whether
 					   to respond to 'href'.  Now we can determine at compile time whether a response
 					   is necessary. */
-					if constexpr (requires(A &a) { a.RespondHREF(L""); })
+					if constexpr (requires(A &a) { a.RespondHREF(XMLParser<StateParser>::String()); })
 						return static_cast<void (StateParser::Response::*)(const XMLParser<StateParser>::String)>(&Multistatus::RespondHREF);
 					
 					else
@@ -338,6 +361,21 @@ struct WebDAV::Multistatus : StateParser::Response {
 					}()
 				};
 	
+	static constexpr StateParser::State
+			gStateResponseStatus = {
+				nullptr,
+				nullptr,
+				nullptr,
+				[]() {
+					// does adapter define a handler for the status of the response as a whole?
+					if constexpr (requires(A &a) { a.RespondStatus(XMLParser<StateParser>::String()); })
+						return static_cast<void (StateParser::Response::*)(const XMLParser<StateParser>::String)>(&Multistatus::RespondStatus);
+					
+					else
+						return nullptr;
+					}()
+				};
+	
 	static constexpr StateParser::State
 			gStateProperty = {
 				PT::gTransitions.data(),
@@ -354,8 +392,8 @@ struct WebDAV::Multistatus : StateParser::Response {
 	
 	static constexpr StateParser::State::Transition
 			gTransitionsFromPropertyStatus[] = {
-				{ L"prop", &gStateProperty, sizeof(StateParser::Response) + sizeof(A) },
-				{ L"status", &gStateStatus },
+				{ "prop", &gStateProperty, sizeof(StateParser::Response) + sizeof(A) },
+				{ "status", &gStateStatus },
 				{}
 				};
 	
@@ -364,8 +402,9 @@ struct WebDAV::Multistatus : StateParser::Response {
 	
 	static constexpr StateParser::State::Transition
 			gTransitionsFromResponse[] = {
-				{ L"href", &gStateHREF },
-				{ L"propstat", &gStatePropertyStatus },
+				{ "href", &gStateHREF },
+				{ "propstat", &gStatePropertyStatus },
+				{ "status", &gStateResponseStatus },
 				{}
 				};
 	
@@ -392,7 +431,7 @@ struct WebDAV::Multistatus : StateParser::Response {
 					}()
 				};
 	
-	static constexpr wchar_t tag[] = L"response";
+	static constexpr char tag[] = "response";
 	static constexpr std::wstring_view gXML = L"";
 	
 	
@@ -440,7 +479,7 @@ protected:
 	
 	static constexpr StateParser::State::Transition
 			gTransitionsFromDocument[] = {
-				{ L"multistatus", &gStateMultistatus },
+				{ "multistatus", &gStateMultistatus },
 				{}
 				};
 	
@@ -450,14 +489,74 @@ public:
 	static constexpr StateParser::State
 			gStateDocument = { gTransitionsFromDocument };
 	
+	// the parser can keep track of these states without allocating
+	static_assert(StateParser::Depth(gStateDocument) <= StateParser::kFrames, "WebDAV response states nested too deeply");
+	
 	static constexpr std::wstring_view
 			gXML = { gXMLa.data(), gXMLa.size() };
 	
 	
 			Basic(M... m) : fTransitions(m...) {} 
+	
+	template <typename Input>
+	void		Interpret(const Input&);
+	template <typename Input>
+	void		Execute(const Input&);
+	template <typename Input>
+	void		Parse(const Input&);
 	};
 
 
+/*	Interpret
+	Parse the response by interpreting the state tables
+*/
+template <class... M>
+template <typename Input>
+void WebDAV::Basic<M...>::Interpret(
+	const Input	&input
+	)
+{
+StateParser events(gStateDocument, *this);
+XMLParser<StateParser> parser(events);
+parser(input);
+}
+
+
+/*	Execute
+	Parse the response by the state tables compiled into code
+*/
+template <class... M>
+template <typename Input>
+void WebDAV::Basic<M...>::Execute(
+	const Input	&input
+	)
+{
+CompiledStateParser<gStateDocument> events(*this);
+XMLParser<StateMachine> parser(events);
+parser(input);
+}
+
+
+/*	Parse
+	Parse the response, which is either the entire response or a function that receives it
+	
+	The tables remain the reference, and are what's used in debug builds, where they're easier
+	to follow; otherwise they're compiled.
+*/
+template <class... M>
+template <typename Input>
+void WebDAV::Basic<M...>::Parse(
+	const Input	&input
+	)
+{
+#ifdef _DEBUG
+Interpret(input);
+#else
+Execute(input);
+#endif
+}
+
+
 
 /*
 
@@ -468,17 +567,17 @@ public:
 /*	PropertyName
 	Example of a property with internal structure; and the internal structure consists of
 	unpredictable XML elements
-	RFC 4918 14.21
+	RFC 4918 §14.21
 */
 template <typename Callable>
 struct WebDAV::Find::PropertyName : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"propname";
+	static constexpr char tag[] = "propname";
 	static constexpr std::wstring_view gXML = L"<D:propname/>";
 	
 	static constexpr StateParser::State gStateAnything {
@@ -487,7 +586,7 @@ public:
 			};
 			
 	static constexpr StateParser::State::Transition gTransitionsFromState[2] = {
-			{ L"", &gStateAnything },
+			{ "", &gStateAnything },
 			{}
 			};
 	
@@ -501,18 +600,18 @@ public:
 
 
 /*	ContentType
-	The Content-Type header value (RFC 2616 14.17) as it would be returned by a GET method
-	RFC 4918 15.5
+	The Content-Type header value (RFC 2616 §14.17) as it would be returned by a GET method
+	RFC 4918 §15.5
 */
 template <typename Callable>
 struct WebDAV::Find::ContentType : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"getcontenttype";
+	static constexpr char tag[] = "getcontenttype";
 	static constexpr std::wstring_view gXML = L"<D:getcontenttype/>";
 	
 	static constexpr StateParser::State gState {
@@ -527,17 +626,17 @@ public:
 
 /*	CreationDate
 	Time and date a resource was created
-	RFC 4918 15.1
+	RFC 4918 §15.1
 */
 template <typename Callable>
 struct WebDAV::Find::CreationDate : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"creationdate";
+	static constexpr char tag[] = "creationdate";
 	static constexpr std::wstring_view gXML = L"<D:creationdate/>";
 	
 	static constexpr StateParser::State gState {
@@ -552,17 +651,17 @@ public:
 
 /*	DisplayName
 	Resource name suitable for presentation to user
-	RFC 4918 15.2
+	RFC 4918 §15.2
 */
 template <typename Callable>
 struct WebDAV::Find::DisplayName : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"displayname";
+	static constexpr char tag[] = "displayname";
 	static constexpr std::wstring_view gXML = L"<D:displayname/>";
 	
 	static constexpr StateParser::State gState {
@@ -583,10 +682,10 @@ struct WebDAV::Find::ETag : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"getetag";
+	static constexpr char tag[] = "getetag";
 	static constexpr std::wstring_view gXML = L"<D:getetag/>";
 	
 	static constexpr StateParser::State gState {
@@ -600,18 +699,18 @@ public:
 
 
 /*	LastModified
-	The Last-Modified header value (RFC 2616 14.29) as it would be returned by a GET method
-	RFC 4918 15.7
+	The Last-Modified header value (RFC 2616 §14.29) as it would be returned by a GET method
+	RFC 4918 §15.7
 */
 template <typename Callable>
 struct WebDAV::Find::LastModified : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"getlastmodified";
+	static constexpr char tag[] = "getlastmodified";
 	static constexpr std::wstring_view gXML = L"<D:getlastmodified/>";
 	
 	static constexpr StateParser::State gState {
@@ -666,10 +765,10 @@ struct WebDAV::Find::CurrentUserPrincipal : public StateParser::Response {
 protected:
 	Callable	FContent;
 	
-	void		Characters(const wchar_t content[]) { FContent(content); }
+	void		Characters(const XMLParser<StateParser>::String content) { Deliver(FContent, content); }
 
 public:
-	static constexpr wchar_t tag[] = L"current-user-principal";
+	static constexpr char tag[] = "current-user-principal";
 	static constexpr std::wstring_view gXML = L"<D:current-user-principal/>";
 	
 	static constexpr StateParser::State gStateHREF {
@@ -679,7 +778,7 @@ public:
 			};
 			
 	static constexpr StateParser::State::Transition gTransitionsFromState[2] = {
-			{ L"href", &gStateHREF },
+			{ "href", &gStateHREF },
 			{}
 			};
 	
@@ -694,17 +793,17 @@ public:
 
 /*	ResourceType
 	Return a type that specifies the nature of the resource
-	RFC 4918 15.9
+	RFC 4918 §15.9
 */
 template <typename Callable>
 struct WebDAV::Find::ResourceType : public StateParser::Response {
 protected:
 	Callable	FCalendarBegin;
 	
-	void		CalendarBegin(const wchar_t[]) { FCalendarBegin(); }
+	void		CalendarBegin(const XMLParser<StateParser>::String) { FCalendarBegin(); }
 
 public:
-	static constexpr wchar_t tag[] = L"resourcetype";
+	static constexpr char tag[] = "resourcetype";
 	static constexpr std::wstring_view gXML = L"<D:resourcetype/>";
 	
 	static constexpr StateParser::State gStateCalendar {
@@ -713,7 +812,7 @@ public:
 			};
 			
 	static constexpr StateParser::State::Transition gTransitionsFromState[2] = {
-			{ L"calendar", &gStateCalendar },
+			{ "calendar", &gStateCalendar },
 			{}
 			};
 	
@@ -799,10 +898,8 @@ DAV::PropertyFind(
 	path, depth,
 	decltype(response)::gXML.data(),
 	[&response](CHTTPClient::Response &httpResponse) {
-		// parse XML response
-		StateParser events(decltype(response)::gStateDocument, response);
-		XMLParser parser(events);
-		parser(httpResponse.Content());
+		// parse XML response as it arrives
+		response.Parse([&httpResponse](void *buffer, size_t bufferL) { return httpResponse.Receive(buffer, bufferL); });
 		}
 	);
 }
@@ -868,7 +965,7 @@ public:
 
 /*	Patch::Set
 	Set properties
-	RFC 4918 14.26
+	RFC 4918 §14.26
 */
 template <class... Is>
 struct WebDAV::Patch::Set : public StateParser::Response {
@@ -923,7 +1020,7 @@ public:
 	/*	response parser structures
 		Can't find this documented.  Twisted just returns the empty property "<displayname/>"	
 	*/
-	static constexpr wchar_t tag[] = L"displayname";
+	static constexpr char tag[] = "displayname";
 	
 	static constexpr StateParser::State gState {};
 	
@@ -959,10 +1056,8 @@ FormatString(
 			path, depth,
 			query,
 			[&response](CHTTPClient::Response &httpResponse) {
-				// parse XML response
-				StateParser events(decltype(response)::gStateDocument, response);
-				XMLParser parser(events);
-				parser(httpResponse.Content());
+				// parse XML response as it arrives
+				response.Parse([&httpResponse](void *buffer, size_t bufferL) { return httpResponse.Receive(buffer, bufferL); });
 				}
 			);
 		},
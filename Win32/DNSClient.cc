@@ -6,7 +6,7 @@
 	
 	2019/04/06	Originated
 	
-	Copyright  2019 by: Ben Hekster
+	Copyright © 2019 by: Ben Hekster
 */
 
 #include <assert.h>
@@ -12,8 +12,10 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include <cassert>
+#include <cstdio>
 
 #include <algorithm>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <optional>
@@ -23,6 +25,61 @@
 #include "NFile.h"
 
 #include "HTTPClient.h"
+#include "Transcode.h"
+
+
+/*
+
+	CHTTPClient::Address
+
+*/
+
+/*	Crack
+	Split a URL into its components; return false if it doesn't have a scheme (and so
+	is presumably just a path)
+*/
+bool CHTTPClient::Address::Crack(
+	const wchar_t	url[],
+	const std::function<void (std::wstring_view scheme, std::wstring_view host, unsigned short port, std::wstring_view path)> &Cracked
+	)
+{
+// crack open the URL
+URL_COMPONENTS components;
+components.dwStructSize = sizeof components;
+components.lpszScheme = nullptr;		// return scheme inside URL string
+components.dwSchemeLength = ~0;
+components.lpszHostName = nullptr;		// return host name inside URL string
+components.dwHostNameLength = ~0;
+components.lpszUserName = nullptr;		// don't need user name (not expecting to use a different one)
+components.dwUserNameLength = 0;
+components.lpszPassword = nullptr;		// don't need password (not expecting to use a different one)
+components.dwPasswordLength = 0;
+components.lpszUrlPath = nullptr;		// return path inside URL string
+components.dwUrlPathLength = ~0;
+components.lpszExtraInfo = nullptr;		// don't think I need 'extra' information (query or anchor part of URL)
+components.dwExtraInfoLength = 0;
+
+// unable to crack the URL?
+if (!WinHttpCrackUrl(url, 0 /* NUL-terminated */, 0 /* flags */, &components))
+	switch (const DWORD error = GetLastError()) {
+		// no scheme in URL?
+		case ERROR_WINHTTP_UNRECOGNIZED_SCHEME:
+			return false;
+		
+		default:
+			throw error;
+		}
+
+Cracked(
+	components.lpszScheme ? std::wstring_view(components.lpszScheme, components.dwSchemeLength) : std::wstring_view(),
+	components.lpszHostName ? std::wstring_view(components.lpszHostName, components.dwHostNameLength) : std::wstring_view(),
+	components.nPort,
+	components.lpszUrlPath ? std::wstring_view(components.lpszUrlPath, components.dwUrlPathLength) : std::wstring_view()
+	);
+
+return true;
+}
+
 
 
 /*
@@ -39,30 +96,54 @@ CHTTPClient::CHTTPClient(
 	const wchar_t	username[],
 	const wchar_t	password[]
 	) :
-	// create HTTP session
-	fSession(L"Casaubon User Agent", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, nullptr, nullptr, 0),
+	CHTTPClient(Pool::Default(), server, username, password)
+{
+}
 
-	// establish connection context
-	fConnection(fSession, server.fHost, server.fPort),
+CHTTPClient::CHTTPClient(
+	Pool		&pool,
+	const Address	&server,
+	const wchar_t	username[],
+	const wchar_t	password[]
+	) :
+	// share session and connection context with other clients to the same server
+	fServer(pool.CheckOut(server)),
 
 	fSecure(server.fSecure),
 	fAuthenticationScheme(0),
+	fChunked(true),
 	fUsername(username),
 	fPassword(password)
 {
 }
 
 
+/*	CHTTPClient
+	Make another client to the same server, with the same credentials; for use in parallel
+*/
+CHTTPClient::CHTTPClient(
+	const CHTTPClient &that
+	) :
+	fServer(that.fServer),
+	fSecure(that.fSecure),
+	fAuthenticationScheme(that.fAuthenticationScheme),
+	fChunked(that.fChunked),
+	fUsername(that.fUsername),
+	fPassword(that.fPassword)
+{
+}
+
+
 /*	CHTTPClient
 	Move constructor
 */
 CHTTPClient::CHTTPClient(
 	CHTTPClient	&&that
 	) :
-	fSession(std::move(that.fSession)),
-	fConnection(std::move(that.fConnection)),
+	fServer(std::move(that.fServer)),
 	fSecure(that.fSecure),
 	fAuthenticationScheme(that.fAuthenticationScheme),
+	fChunked(that.fChunked),
 	fUsername(that.fUsername),
 	fPassword(that.fPassword)
 {
@@ -82,7 +163,7 @@ void CHTTPClient::Request(
 {
 // prepare request
 Win32::HTTP::Request request(
-	fConnection,
+	fServer->fConnection,
 	verb,
 	path,
 	nullptr /* default version */,
@@ -105,6 +186,10 @@ Headers(
 		}
 	);
 
+// we can decompress the response
+if (!headers) headers.emplace();
+headers->append(L"Accept-Encoding: gzip, deflate\r\n");
+
 // last character should not be NUL
 /* (iCloud at least will return 405 Bad Request) */
 if (rekwest.fData && rekwest.fDataL > 0)
@@ -131,15 +216,44 @@ do {
 	   We attempt to avoid it, so we don't have to buffer the entire body in memory and thereby reduce latency. */
 	size_t length = rekwest.Length();
 	
+	// not known until it's been generated?
+	const bool
+		chunked = length == Rekwest::kLengthUnknown && fChunked,
+		buffered = length == Rekwest::kLengthUnknown && !fChunked;
+	std::string whole;
+	if (buffered) {
+		// the server won't take it in chunks, so generate all of it first after all
+		whole.assign(static_cast<const char*>(rekwest.fData), rekwest.fDataL);
+		for (bool pushed = true; pushed; ) {
+			pushed = false;
+			rekwest.Data([&whole, &pushed](const void *data, size_t dataL) { whole.append(static_cast<const char*>(data), dataL); pushed |= dataL > 0; });
+			}
+		length = whole.size();
+		}
+	
 	// send request with any initial body data
-	request.Send(headers ? headers->c_str() : nullptr, rekwest.fData, rekwest.fDataL, length, 0 /* context */);
-	assert(length >= rekwest.fDataL);
-	length -= rekwest.fDataL;
+	if (chunked) {
+		/* WinHTTP leaves the chunk framing to us */
+		std::wstring chunkedHeaders = headers ? *headers : std::wstring();
+		chunkedHeaders.append(L"Transfer-Encoding: chunked\r\n");
+		request.Send(chunkedHeaders.c_str(), nullptr, 0, WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH, 0 /* context */);
+		SendChunked(request, rekwest);
+		length = 0;
+		}
+	
+	else if (buffered) {
+		request.Send(headers ? headers->c_str() : nullptr, whole.data(), whole.size(), whole.size(), 0 /* context */);
+		length = 0;
+		}
+	
+	else {
+		request.Send(headers ? headers->c_str() : nullptr, rekwest.fData, rekwest.fDataL, length, 0 /* context */);
+		assert(length >= rekwest.fDataL);
+		length -= rekwest.fDataL;
+		}
 	
 	// stream remainder of body
 	while (length > 0) {
-		DebugBreak();
-		
 		// ask user to push more data
 		rekwest.Data(
 			[&request, &length](
@@ -168,15 +282,27 @@ do {
 		
 		// need authentication?
 		case HTTP_STATUS_DENIED:
-			if (fAuthenticationScheme) throw "can't log in even after authenticating";
+			if (fAuthenticationScheme) throw status;	// can't log in even after authenticating
 			fAuthenticationScheme = request.QueryAuthSchemes().supportedSchemes;
 			retry = true;
 			break;
 		
+		// server doesn't take a chunked request body?
+		case HTTP_STATUS_LENGTH_REQUIRED:
+		case HTTP_STATUS_NOT_SUPPORTED:
+			if (!chunked) throw status;
+			
+			// send it whole from now on
+			fChunked = false;
+			retry = true;
+			break;
+		
 		case HTTP_STATUS_BAD_REQUEST:
 		case HTTP_STATUS_SERVICE_UNAVAIL:
+		case HTTP_STATUS_FORBIDDEN:		// eg, sync-collection token no longer valid
 		case HTTP_STATUS_NOT_FOUND:
 		case HTTP_STATUS_BAD_METHOD:
+		case HTTP_STATUS_CONFLICT:
 		case HTTP_STATUS_SERVER_ERROR:
 			throw status;		// *** probably wrap this in an HTTP exception class
 		
@@ -195,6 +321,202 @@ AcceptResponse(response);
 }
 
 
+/*	SendChunked
+	Send the request body in chunks as the user generates it [RFC 9112 §7.1]
+*/
+void CHTTPClient::SendChunked(
+	Win32::HTTP::Request &request,
+	Rekwest		&rekwest
+	)
+{
+bool first = true;
+auto Chunk = [&request, &first](const void *data, size_t dataL) {
+	// a chunk of nothing would end the body
+	if (dataL == 0) return;
+	
+	// chunk size, after the end of the previous chunk
+	char size[24];
+	request.Write(size, snprintf(size, sizeof size, &"\r\n%zx\r\n"[first ? 2 : 0], dataL));
+	request.Write(data, dataL);
+	first = false;
+	};
+
+Chunk(rekwest.fData, rekwest.fDataL);
+for (bool pushed = true; pushed; ) {
+	pushed = false;
+	rekwest.Data([&Chunk, &pushed](const void *data, size_t dataL) { Chunk(data, dataL); pushed |= dataL > 0; });
+	}
+
+// last chunk, and no trailer
+request.Write(&"\r\n0\r\n\r\n"[first ? 2 : 0], first ? 5 : 7);
+}
+
+
+
+/*
+
+	CHTTPClient::Pool
+
+*/
+
+/*	Pool
+	Keep up to 'fMaxIdle' connections per server for up to 'fIdleTimeout' after the last
+	client to it is gone
+*/
+CHTTPClient::Pool::Pool() :
+	Pool(Options())
+{
+}
+
+CHTTPClient::Pool::Pool(
+	const Options	&options
+	) :
+	fOptions(options)
+{
+}
+
+
+/*	Default
+	Return the pool shared by all clients that aren't given one explicitly
+*/
+CHTTPClient::Pool &CHTTPClient::Pool::Default()
+{
+static Pool pool;
+return pool;
+}
+
+
+/*	Evict
+	Close the sessions, and so the sockets, of servers no client has used for too long
+	The caller holds the mutex
+*/
+void CHTTPClient::Pool::Evict(
+	std::chrono::steady_clock::time_point now
+	)
+{
+/* Only ask whether the server has expired; locking it could make us its last owner, and
+   then its destructor would want the mutex we're holding */
+std::erase_if(
+	fHosts,
+	[this, now](const auto &host) { return host.second.fServer.expired() && now - host.second.fSince > fOptions.fIdleTimeout; }
+	);
+}
+
+
+/*	Release
+	Note that the last client to the server is gone
+*/
+void CHTTPClient::Pool::Release(
+	const Key	&key
+	)
+{
+std::lock_guard lock(fMutex);
+
+if (const auto found = fHosts.find(key); found != fHosts.end())
+	found->second.fSince = std::chrono::steady_clock::now();
+}
+
+
+/*	CheckOut
+	Return the connection context for the given server, creating it if no client is using it
+*/
+std::shared_ptr<CHTTPClient::Server> CHTTPClient::Pool::CheckOut(
+	const Address	&server
+	)
+{
+std::lock_guard lock(fMutex);
+
+const auto now = std::chrono::steady_clock::now();
+Evict(now);
+
+const Key key { server.fSecure, server.fHost, server.fPort };
+Host &host = fHosts[key];
+host.fSince = now;
+
+std::shared_ptr<Server> result = host.fServer.lock();
+
+// no other client is using it (any more)?
+if (!result) {
+	// sockets idle for less than the timeout are still in the session
+	if (!host.fSession) {
+		host.fSession = std::make_shared<Win32::HTTP::Session>(L"Casaubon User Agent", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, nullptr, nullptr, 0);
+		
+		if (DWORD maxConnections = fOptions.fMaxIdle; maxConnections > 0)
+			host.fSession->SetOption(WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &maxConnections, sizeof maxConnections);
+		}
+	
+	result = std::make_shared<Server>(*this, key, host.fSession);
+	host.fServer = result;
+	}
+
+return result;
+}
+
+
+/*	Kept
+	Return the number of servers whose connections are kept although no client is using them
+*/
+size_t CHTTPClient::Pool::Kept()
+{
+std::lock_guard lock(fMutex);
+
+Evict(std::chrono::steady_clock::now());
+
+return std::ranges::count_if(fHosts, [](const auto &host) { return host.second.fServer.expired(); });
+}
+
+
+
+/*
+
+	CHTTPClient::Server
+
+*/
+
+/*	~Server
+	Let the pool know when the connections have gone idle
+*/
+CHTTPClient::Server::~Server()
+{
+fPool.Release(fKey);
+}
+
+
+
+/*
+
+	CHTTPClient::StreamRekwest
+
+*/
+
+/*	Data
+	Have the user write the body, and pass it on converted as it's written
+*/
+void CHTTPClient::StreamRekwest::Data(
+	const std::function<void (const void*, size_t)> &push
+	)
+{
+// it all goes the first time
+if (fSent) return;
+fSent = true;
+
+// a failure to send may well be swallowed by the user's stream; so remember it, and stop sending
+std::exception_ptr failure;
+const std::function<void (const void*, size_t)> sink = [&push, &failure](const void *data, size_t dataL) {
+	if (failure) return;
+	try { push(data, dataL); }
+	catch (...) { failure = std::current_exception(); throw; }
+	};
+
+aostreambuf<wchar_t, EncodingOutputAdapter<wchar_t>> osb(sink);
+fSender(osb);
+osb.pubsync();
+if (!failure) osb.adapter().narrow().drain(sink);
+
+if (failure) std::rethrow_exception(failure);
+}
+
+
 
 /*
 
@@ -202,6 +524,55 @@ AcceptResponse(response);
 
 */
 
+/*	Response
+	Represent the response to an HTTP request
+*/
+CHTTPClient::Response::Response(
+	Win32::HTTP::Request &request
+	) :
+	fRequest(request)
+{
+// decompress the body as it's read (RFC 9110 §8.4.1)
+std::wstring contentEncoding;
+try {
+	contentEncoding.resize(fRequest.QueryHeaderL(WINHTTP_QUERY_CONTENT_ENCODING) / sizeof(wchar_t)); // returns size including NUL terminator
+	contentEncoding.resize(fRequest.QueryHeader(WINHTTP_QUERY_CONTENT_ENCODING, contentEncoding.data(), static_cast<unsigned>(contentEncoding.size() * sizeof(wchar_t))) / sizeof(wchar_t));
+	}
+
+catch (const unsigned long error) {
+	if (error != ERROR_WINHTTP_HEADER_NOT_FOUND) throw;
+	return;
+	}
+
+Inflater::Format format;
+if (_wcsicmp(contentEncoding.c_str(), L"gzip") == 0 || _wcsicmp(contentEncoding.c_str(), L"x-gzip") == 0)
+	format = Inflater::kFormatGzip;
+else if (_wcsicmp(contentEncoding.c_str(), L"deflate") == 0)
+	format = Inflater::kFormatZlib;
+else if (_wcsicmp(contentEncoding.c_str(), L"identity") == 0)
+	return;
+else
+	throw "unsupported content coding";
+
+fInflater = std::make_unique<Inflater>(format, [this](void *buffer, size_t length) { return ReadEncoded(buffer, length); });
+}
+
+
+/*	ReadEncoded
+	Read body data, as sent, into the given buffer as soon as it arrives; return the amount
+	read, or zero at the end of the body
+*/
+size_t CHTTPClient::Response::ReadEncoded(
+	void		*buffer,
+	size_t		length
+	) const
+{
+/* WinHttpQueryDataAvailable blocks until data available, or EOF */
+const size_t available = fRequest.QueryDataAvailable();
+return available ? fRequest.Read(buffer, std::min(length, available)) : 0;
+}
+
+
 /*	Content
 	Get the response body as an HGLOBAL
 */
@@ -211,14 +582,15 @@ Win32::Memory::Global CHTTPClient::Response::Content() const
 /* CreateStreamOnHGlobal() requires it to be a movable HGLOBAL */
 /* Although I think HTTP requires Content-Length in the response, we can be resilient against not receiving it.
    For instance, iCloud PROPFIND responses don't have it. */
-const std::optional<unsigned> expected = fRequest.QueryHeaderAsUnsignedOptional(WINHTTP_QUERY_CONTENT_LENGTH);
+/* The length of compressed content says nothing about how long it will be decompressed. */
+const std::optional<unsigned> expected = fInflater ? std::nullopt : fRequest.QueryHeaderAsUnsignedOptional(WINHTTP_QUERY_CONTENT_LENGTH);
 unsigned
 	size = expected ? *expected : 0x100,			// size of handle *** can't allocate zero-length handle?
 	length = 0;						// length of data
 Win32::Memory::Global handle(size, GMEM_MOVEABLE);
 
 /* WinHttpQueryDataAvailable blocks until data available, or EOF */
-while (const unsigned long available = fRequest.QueryDataAvailable()) {
+while (const unsigned long available = static_cast<unsigned long>(Available())) {
 	// not enough space?
 	if (const unsigned need = length + available; need > size) {
 		// reallocate
@@ -230,7 +602,7 @@ while (const unsigned long available = fRequest.QueryDataAvailable()) {
 	Win32::Memory::Global::Lok data(handle);
 
 	// read data
-	length += fRequest.Read(static_cast<char*>(data.operator void*()) + length, size - length);
+	length += static_cast<unsigned>(Read(static_cast<char*>(data.operator void*()) + length, size - length));
 	}
 
 // trim handle size to length of data
@@ -241,6 +613,21 @@ return handle;
 }
 
 
+/*	Receive
+	Get the next part of the response body as soon as it arrives, as much as fits;
+	zero at the end of the body
+*/
+size_t CHTTPClient::Response::Receive(
+	void		*buffer,
+	size_t		length
+	) const
+{
+/* WinHttpQueryDataAvailable blocks until data available, or EOF */
+const size_t available = Available();
+return available ? Read(buffer, std::min(length, available)) : 0;
+}
+
+
 /*	GetLength
 	Get the length of a response header string
 */
@@ -345,7 +732,7 @@ void CHTTPClient::Response::Get(
 */
 
 /*	filter
-
+	Remove CRs; and unfold continuation lines, if so requested
 */
 char *CHTTPClient::DecodingInputAdapter<char>::filter(
 	char		*begin,
@@ -353,82 +740,7 @@ char *CHTTPClient::DecodingInputAdapter<char>::filter(
 	const char	*limit
 	)
 {
-Splicer<char> ci(begin, end, limit);
-
-// for each character of the buffer
-while (ci)
-	switch (const char c = ci.read()) {
-		// CR?  Assume CR/LF always appear in pairs, so just remove it
-		case '\r':	break;
-		
-		default:	ci << c; break;
-		}
-
-return ci.end();
-}
-
-
-/*	available
-	Return how many characters are available to be read from the associated character sequence
-*/
-size_t CHTTPClient::DecodingInputAdapter<wchar_t>::available()
-{
-size_t result;
-
-// flood narrow character input stream buffer
-fNarrow.pubsync();
-
-// any data available to convert?
-if (const size_t narrowL = fNarrow.size()) {
-	// calculate length of conversion from UTF-8
-	const int wideL = MultiByteToWideChar(
-		65001 /* UTF-8 */,
-		MB_ERR_INVALID_CHARS,
-		fNarrow.data(), fNarrow.size(),
-		nullptr, 0 // compute required output length
-		); if (!wideL) throw GetLastError(); // ***** errors
-	
-	result = wideL;
-	}
-
-else
-	result = 0;
-
-return result;
-}
-
-
-/*	house
-	Make input characters available at the given buffer; return the number of
-	characters produced
-*/
-size_t CHTTPClient::DecodingInputAdapter<wchar_t>::house(
-	wchar_t		*buffer,
-	size_t		bufferL
-	)
-{
-size_t result;
-
-// any data available to convert?
-if (const size_t narrowL = fNarrow.size()) {
-	// convert from UTF-8
-	const int wideL = MultiByteToWideChar(
-		65001 /* UTF-8 */,
-		MB_ERR_INVALID_CHARS,
-		fNarrow.data(), narrowL,
-		buffer, bufferL
-		); if (!wideL) throw GetLastError(); // ***** errors
-
-	// narrow-character data was consumed
-	fNarrow.claimed(narrowL);
-	
-	result = wideL;
-	}
-
-else
-	result = 0;
-
-return result;
+return fLines(begin, end, limit);
 }
 
 
@@ -439,41 +751,6 @@ return result;
 
 */
 
-/*	evict
-	Transform buffered wide-character data into the narrow-character buffer
-*/
-size_t CHTTPClient::EncodingOutputAdapter<wchar_t>::evict(
-	const wchar_t	*data,
-	size_t		dataL
-	)
-{
-// convert to UTF-8
-char *narrow = nullptr;
-int narrowL = 0;
-do {
-	// create space to convert into if size is known (second iteration)
-	if (narrowL) narrow = fNarrow.reserve(narrowL);
-	
-	// compute required buffer size (first iteration) or perform actual conversion (second iteration)
-	narrowL = WideCharToMultiByte(
-		65001 /* UTF-8 */,
-		WC_ERR_INVALID_CHARS,
-		data, dataL,
-		narrow, narrowL,
-		nullptr, /* use system default character */
-		nullptr /* used default character */
-		); if (!narrowL) throw GetLastError(); // ***** errors
-	
-	// while conversion not completed yet
-	} while (!narrow);
-
-// data was provided
-fNarrow.used(narrowL);
-
-return dataL;
-}
-
-
 /*	filter
 	Process data to make it suitable for eviction
 */
@@ -483,24 +760,10 @@ char *CHTTPClient::EncodingOutputAdapter<char>::filter(
 	const char	*limit
 	)
 {
-Splicer<char> ci(begin, end, limit);
-
-// for each character of the buffer
-while (ci)
-	switch (const char c = ci.read()) {
-		// CR?
-		/* We're assuming a 'C' style input containing only LF.  But just in case we do encounter CRLF,
-		   just consume CR now; and re-insert it when we see the LF.  This way we don't have to manage
-		   any other state in the conversion. */
-		case '\r':	break;
-		
-		// LF?
-		case '\n':	ci << '\r' << '\n'; break;
-		
-		default:	ci << c; break;
-		}
-
-return ci.end();
+/* We're assuming a 'C' style input containing only LF.  But just in case we do encounter CRLF,
+   just take out the CR; and put it back with the LF.  This way we don't have to manage any other
+   state in the conversion. */
+return LineFilter<char>::CRLF(begin, end, limit);
 }
 
 
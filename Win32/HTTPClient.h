@@ -12,9 +12,14 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <streambuf>
+#include <tuple>
+#include <string_view>
 
 #include <STRINGAPISET.H>
 
@@ -22,6 +27,8 @@
 #include "NMemory.h"
 
 #include "../AdaptableStreamBuffer.h"
+#include "../Inflate.h"
+#include "../Transcode.h"
 
 
 
@@ -41,6 +48,11 @@ public:
 		unsigned short	fPort;
 
 				Address(bool secure, const wchar_t host[], unsigned short port);
+		
+		static bool	Crack(
+					const wchar_t	url[],
+					const std::function<void (std::wstring_view scheme, std::wstring_view host, unsigned short port, std::wstring_view path)>&
+					);
 		};
 	
 	
@@ -69,20 +81,70 @@ public:
 		const void	*fData;
 		size_t		fDataL;
 		
-		/* Specifically not 'const' since computing the length may trigger generation of body data. */
+		/* Specifically not 'const' since computing the length may trigger generation of body data.
+		   If it's kLengthUnknown, Data() is called until it pushes nothing more. */
 		virtual size_t	Length() { return fDataL; }
 		virtual void	Data(const std::function<void (const void*, size_t)>&) {};
 		virtual void	Rewind() {};
 	
 	public:
+		// body is sent in chunks as it's generated [RFC 9112 §7.1]
+		static constexpr size_t kLengthUnknown = static_cast<size_t>(-1);
+		
 				Rekwest(const void *data, size_t dataL) : fData(data), fDataL(dataL) {}
 				Rekwest() : fData(nullptr), fDataL(0) {}
 		virtual		~Rekwest() = default;
 		};
 	
 	
+	/*	GatherRekwest
+		Request body that's in segments, such as a costreambuf; sent one after the other,
+		without ever putting them together
+	*/
+	template <class Segmented>
+	struct GatherRekwest : Rekwest {
+	protected:
+		const Segmented	&fSegments;
+	
+		size_t		Length() override { return fSegments.size(); }
+		void		Data(const std::function<void (const void*, size_t)> &push) override {
+					// all but the first, which went as the immediately available data
+					bool first = true;
+					fSegments.segments([&](const char *data, size_t dataL) { if (!first && dataL > 0) push(data, dataL); first = false; });
+					}
+	
+	public:
+		explicit	GatherRekwest(const Segmented &segments) : fSegments(segments) {
+					// there's always a first segment, so even an empty body has a 'Content-Length'
+					segments.segments([this](const char *data, size_t dataL) { if (!fData) fData = data, fDataL = dataL; });
+					}
+		};
+	
+	
+	/*	StreamRekwest
+		Request body that's written by the given function, converted and sent as it's written
+		The function is called again if the request has to be repeated, and must then write
+		the same body again
+	*/
+	struct StreamRekwest : Rekwest {
+	protected:
+		const std::function<void (std::wstreambuf&)> &fSender;
+		bool		fSent;
+	
+		size_t		Length() override { return kLengthUnknown; }
+		void		Data(const std::function<void (const void*, size_t)>&) override;
+		void		Rewind() override { fSent = false; }
+	
+	public:
+		explicit	StreamRekwest(const std::function<void (std::wstreambuf&)> &sender) : fSender(sender), fSent(false) {}
+		};
+	
+	
 	/*	Response
 		Response to HTTP request
+		
+		A body with a 'gzip' or 'deflate' content coding is decompressed as it's read, so
+		callers only ever see the content.
 	*/
 	struct Response {
 		friend CHTTPClient;
@@ -95,15 +157,19 @@ public:
 
 	protected:
 		Win32::HTTP::Request &fRequest;
+		std::unique_ptr<Inflater> fInflater;	// decompresses the body, if it has a content coding
 		
 		
 		explicit	Response(Win32::HTTP::Request&);
 		
-		size_t		Available() const { return fRequest.QueryDataAvailable(); }
-		size_t		Read(void *buffer, size_t length) { return fRequest.Read(buffer, length); }
+		size_t		AvailableEncoded() const { return fRequest.QueryDataAvailable(); }
+		size_t		ReadEncoded(void *buffer, size_t length) const;
+		size_t		Available() const { return fInflater ? fInflater->Available() : AvailableEncoded(); }
+		size_t		Read(void *buffer, size_t length) const { return fInflater ? fInflater->Read(buffer, length) : fRequest.Read(buffer, length); }
 	
 	public:
 		Win32::Memory::Global Content() const;
+		size_t		Receive(void *buffer, size_t length) const;
 		unsigned	GetLength(StandardHeader) const,
 				GetLength(const wchar_t header[]) const;
 		void		Get(StandardHeader header, char *buffer, unsigned bufferL) const,
@@ -145,17 +211,29 @@ public:
 	
 	template <typename Char>
 	struct EncodingOutputAdapter;
+	
+	
+	/*	Pool
+		WinHTTP session and connection handles, shared between clients to the same server
+	*/
+	struct Pool;
 
 protected:
-	Win32::HTTP::Session fSession;
-	Win32::HTTP::Connection fConnection;
+	struct Server;
+	
+	std::shared_ptr<Server> fServer;
 	bool		fSecure;
 	DWORD		fAuthenticationScheme;
+	bool		fChunked;			// server takes request bodies in chunks, as far as we know
 	const wchar_t	*fUsername,
 			*fPassword;
+	
+	void		SendChunked(Win32::HTTP::Request&, Rekwest&);
 
 public:
 			CHTTPClient(const Address&, const wchar_t username[], const wchar_t password[]);
+			CHTTPClient(Pool&, const Address&, const wchar_t username[], const wchar_t password[]);
+	explicit	CHTTPClient(const CHTTPClient&);
 			CHTTPClient(CHTTPClient&&);
 	
 	void		Request(
@@ -169,6 +247,77 @@ public:
 
 
 
+/*
+
+	CHTTPClient::Pool
+
+	WinHTTP keeps its own keep-alive sockets per session handle, and uses them for any request
+	on any connection handle to the same server.  So it isn't sockets we have to pool, but the
+	handles: as long as clients to the same server share them, they share the sockets as well.
+	Dead sockets are detected by WinHTTP itself.
+	
+	Each server gets a session handle of its own, limited to as many connections as the pool
+	allows idle ones.  When no client has used the server for the idle timeout, its session
+	is closed, and with it all of its sockets.
+
+*/
+
+struct CHTTPClient::Pool {
+public:
+	struct Options {
+		unsigned	fMaxIdle = 4;			// most keep-alive connections per server
+		std::chrono::seconds fIdleTimeout { 30 };	// how long a server's connections outlive its last client
+		};
+
+protected:
+	friend struct Server;
+	
+	using Key = std::tuple<bool, std::wstring, unsigned short>;
+	
+	struct Host {
+		std::shared_ptr<Win32::HTTP::Session> fSession;
+		std::weak_ptr<Server> fServer;
+		std::chrono::steady_clock::time_point fSince;	// last checked out or let go of
+		};
+	
+	const Options	fOptions;
+	std::mutex	fMutex;
+	std::map<Key, Host> fHosts;
+	
+	void		Evict(std::chrono::steady_clock::time_point now);
+	void		Release(const Key&);
+
+public:
+			Pool();
+	explicit	Pool(const Options&);
+			Pool(const Pool&) = delete;
+	
+	std::shared_ptr<Server> CheckOut(const Address&);
+	size_t		Kept();
+	
+	static Pool	&Default();
+	};
+
+
+struct CHTTPClient::Server {
+	Pool		&fPool;
+	const Pool::Key	fKey;
+	
+	// connection handle mustn't outlive its session
+	const std::shared_ptr<Win32::HTTP::Session> fSession;
+	Win32::HTTP::Connection fConnection;
+	
+			Server(Pool &pool, const Pool::Key &key, const std::shared_ptr<Win32::HTTP::Session> &session) :
+				fPool(pool),
+				fKey(key),
+				fSession(session),
+				fConnection(*session, std::get<std::wstring>(key).c_str(), std::get<unsigned short>(key))
+				{}
+			~Server();
+	};
+
+
+
 /*
 
 	CHTTPClient::InputAdapter
@@ -177,11 +326,11 @@ public:
 
 struct CHTTPClient::InputAdapter {
 protected:
-	Win32::HTTP::Request &fRequest;
+	CHTTPClient::Response &fResponse;
 
 public:
 			InputAdapter(CHTTPClient::Response &response) :
-				fRequest(response.fRequest)
+				fResponse(response)
 				{}
 	
 	size_t		available();
@@ -193,8 +342,8 @@ public:
 	Return how many characters are available to be read from the associated character sequence
 */
 inline size_t CHTTPClient::InputAdapter::available() {
-	// return how much data is available on HTTP
-	return fRequest.QueryDataAvailable();
+	// return how much (decompressed) data is available on HTTP
+	return fResponse.Available();
 	}
 
 
@@ -205,7 +354,7 @@ inline size_t CHTTPClient::InputAdapter::house(
 	char		*buffer,
 	size_t		bufferL
 	) {
-	return fRequest.Read(buffer, bufferL);
+	return fResponse.Read(buffer, bufferL);
 	}
 
 
@@ -218,6 +367,10 @@ inline size_t CHTTPClient::InputAdapter::house(
 
 template<>
 struct CHTTPClient::DecodingInputAdapter<char> : public CHTTPClient::InputAdapter {
+protected:
+	LineFilter<char> fLines;
+	
+public:
 	// fraction of buffer space that may be needed to properly filter some amount of input:
 	static constexpr unsigned
 			kOverflowNumerator = 1,
@@ -228,6 +381,9 @@ struct CHTTPClient::DecodingInputAdapter<char> : public CHTTPClient::InputAdapte
 				CHTTPClient::InputAdapter(response)
 				{}
 	
+	// also unfold continuation lines [RFC5545 §3.1]
+	void		unfold() { fLines.unfold(); }
+	
 	char		*filter(char *begin, char *end, const char *limit);
 	};
 
@@ -240,25 +396,11 @@ struct CHTTPClient::DecodingInputAdapter<char> : public CHTTPClient::InputAdapte
 */
 
 template<>
-struct CHTTPClient::DecodingInputAdapter<wchar_t> {
-protected:
-	// narrow-character adapter and stream buffer that actually contains the user-defined filters
-	aistreambuf<char, DecodingInputAdapter<char>> fNarrow;
-
+struct CHTTPClient::DecodingInputAdapter<wchar_t> : public UTF8DecodingAdapter<ristreambuf<char, DecodingInputAdapter<char>>> {
 public:
-	// fraction of buffer space that may be needed to properly filter some amount of input (1/1)
-	static constexpr unsigned
-			kOverflowNumerator = 1,
-			kOverflowDenominator = 1;
-	
-	
 			DecodingInputAdapter(CHTTPClient::Response &response) :
-				fNarrow(response)
+				UTF8DecodingAdapter(response)
 				{}
-	
-	size_t		available();
-	size_t		house(wchar_t*, size_t);
-	wchar_t		*filter(wchar_t *begin, wchar_t *end, const wchar_t *limit) { return end; }
 	};
 
 
@@ -272,6 +414,13 @@ public:
 template<>
 struct CHTTPClient::EncodingOutputAdapter<char> /* : public CHTTPClient::InputAdapter */ {
 public:
+	// fraction of buffer space that may be needed to properly filter some amount of output
+	/* Twice as much, for a CR before every LF */
+	static constexpr unsigned
+			kOverflowNumerator = 2,
+			kOverflowDenominator = 1;
+	
+	
 			EncodingOutputAdapter()	{}
 	
 	size_t		evict(const char*, size_t) { return 0; }
@@ -287,18 +436,10 @@ public:
 */
 
 template<>
-struct CHTTPClient::EncodingOutputAdapter<wchar_t> {
-protected:
-	// narrow-character adapter and stream buffer that actually contains the user-defined filters
-	aostreambuf<char, EncodingOutputAdapter<char>> fNarrow;
-
+struct CHTTPClient::EncodingOutputAdapter<wchar_t> : public UTF8EncodingAdapter<costreambuf<char, EncodingOutputAdapter<char>>> {
 public:
 			EncodingOutputAdapter() {}
-	
-	aostreambuf<char, EncodingOutputAdapter<char>> &narrow() { return fNarrow; }
-	
-	size_t		evict(const wchar_t*, size_t);
-	wchar_t		*filter(wchar_t *begin, wchar_t *end, const wchar_t *limit) { return end; }
+	explicit	EncodingOutputAdapter(const std::function<void (const void*, size_t)> &sink) : UTF8EncodingAdapter(sink) {}
 	};
 
 
@@ -376,12 +517,3 @@ inline CHTTPClient::Address::Address(
 		)
 	{}
 
-
-/*	Response
-	Represent the response to an HTTP request
-*/
-inline CHTTPClient::Response::Response(
-	Win32::HTTP::Request &request
-	) :
-	fRequest(request)
-	{}
@@ -0,0 +1,63 @@
+/*
+	MappedFile
+	
+	Read-only view of a whole file
+	Win32
+	
+	2023/10/11	Originated
+	
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include <stdint.h>
+
+#include "MappedFile.h"
+
+
+
+/*	MappedFile
+	Map the named file
+*/
+MappedFile::MappedFile(
+	const wchar_t	path[]
+	) :
+	fFile(CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)),
+	fMapping(nullptr),
+	fContents(nullptr),
+	fContentsL(0)
+{
+if (fFile == INVALID_HANDLE_VALUE) throw GetLastError();
+
+try {
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(fFile, &size)) throw GetLastError();
+	if (static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) throw "file too large to map";
+	
+	// can't map an empty file
+	if (size.QuadPart > 0) {
+		fMapping = CreateFileMapping(fFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!fMapping) throw GetLastError();
+		
+		fContents = static_cast<const char*>(MapViewOfFile(fMapping, FILE_MAP_READ, 0, 0, 0));
+		if (!fContents) throw GetLastError();
+		fContentsL = static_cast<size_t>(size.QuadPart);
+		}
+	}
+
+catch (...) {
+	if (fMapping) CloseHandle(fMapping);
+	CloseHandle(fFile);
+	throw;
+	}
+}
+
+
+/*	~MappedFile
+	Unmap the file
+*/
+MappedFile::~MappedFile()
+{
+if (fContents) UnmapViewOfFile(fContents);
+if (fMapping) CloseHandle(fMapping);
+CloseHandle(fFile);
+}
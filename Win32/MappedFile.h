@@ -0,0 +1,39 @@
+/*
+	MappedFile
+	
+	Read-only view of a whole file
+	Win32
+	
+	2023/10/11	Originated
+	
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#pragma once
+
+#include <string_view>
+
+#include <WINDEF.H>
+#include <WINBASE.H>
+
+
+
+/*	MappedFile
+	The contents of a file, mapped into memory for as long as this exists
+*/
+class MappedFile {
+protected:
+	HANDLE		fFile,
+			fMapping;				// or null if the file is empty
+	const char	*fContents;
+	size_t		fContentsL;
+
+public:
+	explicit	MappedFile(const wchar_t path[]);
+			MappedFile(const MappedFile&) = delete;
+			~MappedFile();
+	
+	MappedFile	&operator=(const MappedFile&) = delete;
+	
+	std::string_view Contents() const { return std::string_view(fContents, fContentsL); }
+	};
@@ -6,28 +6,32 @@
 	
 	2018/10/09	Originated
 	
-	Copyright  2018-2023 by: Ben Hekster
+	Copyright © 2018-2023 by: Ben Hekster
 */
 
 #pragma once
 
 #include <WINDEF.H>
 #include <WINBASE.H>
-#include <XMLLITE.H>
 
+#include <functional>
 #include <map>
 #include <string>
+#include <string_view>
 
+#include "../XMLTokenizer.h"
 
-/*	XMLParser
 
+/*	XMLParser
+	Parse UTF-8 XML documents with the portable tokenizer
 */
 template <class Events>
 struct XMLParser {
 public:
 	using Data = HGLOBAL;
-	using Literal = const wchar_t*;
-	using String = wchar_t[];
+	using Receiver = std::function<size_t (void *buffer, size_t bufferL)>;	// returns zero at the end
+	using Literal = const char*;
+	using String = std::string_view;				// UTF-8, only valid for the duration of the event
 	using Attributes = const std::map<std::string, std::string>&;
 
 
@@ -36,12 +40,12 @@ public:
 	*/
 	struct StringRep {
 	protected:
-		const wchar_t	*const fString;
+		const std::string_view fString;
 
 	public:
-				StringRep(const wchar_t string[]) : fString(string) {}
+				StringRep(const std::string_view string) : fString(string) {}
 
-		bool		operator==(const wchar_t s[]) { return wcscmp(fString, s) == 0; }
+		bool		operator==(const char s[]) { return fString == s; }
 		};
 
 
@@ -60,15 +64,11 @@ public:
 
 protected:
 	Events		&fCallback;
-	IXmlReader	*fReader;
 
-	void		StartElement(),
-			EndElement(),
-			Characters();
-	
 public:
-	explicit	XMLParser(Events&);
-			~XMLParser();
+	explicit	XMLParser(Events &callback) : fCallback(callback) {}
 
-	void		operator()(const Data);
+	void		operator()(const Data),
+			operator()(const Receiver&);
 	};
+
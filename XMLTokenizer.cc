@@ -0,0 +1,608 @@
+/*
+	XMLTokenizer
+
+	Portable streaming XML tokenizer
+
+	2023/06/14	Originated
+
+	Copyright © 2023 by: Ben Hekster
+*/
+
+#include <string.h>
+
+#include <algorithm>
+#include <string_view>
+
+#include "XMLTokenizer.h"
+
+
+
+/*	Append
+	Append a Unicode code point to a UTF-8 string
+*/
+static inline void Append(
+	std::string	&to,
+	char32_t	c
+	)
+{
+if (c < 0x80)
+	to.push_back(static_cast<char>(c));
+
+else if (c < 0x800) {
+	to.push_back(static_cast<char>(0xC0 | c >> 6));
+	to.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+	}
+
+else if (c < 0x10000) {
+	to.push_back(static_cast<char>(0xE0 | c >> 12));
+	to.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3F)));
+	to.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+	}
+
+else {
+	to.push_back(static_cast<char>(0xF0 | c >> 18));
+	to.push_back(static_cast<char>(0x80 | (c >> 12 & 0x3F)));
+	to.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3F)));
+	to.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+	}
+}
+
+
+/*	Find
+	Return the first occurrence of 'pattern' in the range, or 'end' if there is none
+*/
+static inline const char *Find(
+	const char	*begin,
+	const char	*end,
+	std::string_view pattern
+	)
+{
+return std::search(begin, end, pattern.begin(), pattern.end());
+}
+
+
+/*	StartsWith
+	Whether the range starts with the literal: 1 if it does, 0 if it doesn't, -1 if it's
+	too short to tell
+*/
+static inline int StartsWith(
+	const char	*begin,
+	const char	*end,
+	std::string_view literal
+	)
+{
+const size_t length = std::min<size_t>(end - begin, literal.size());
+if (literal.compare(0, length, begin, length) != 0) return 0;
+return length == literal.size() ? 1 : -1;
+}
+
+
+/*	IsSpace
+	Whether the character is XML white space
+*/
+static inline bool IsSpace(
+	char		c
+	)
+{
+return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+
+/*	Scan
+	Check that the range is valid UTF-8, and note whether it's other than white space; return
+	where it ends in an incomplete character
+*/
+static const char *Scan(
+	const char	*at,
+	const char	*const end,
+	bool		&significant
+	)
+{
+while (at < end) {
+	const unsigned char c = *at;
+
+	if (c < 0x80) {
+		if (!significant && !IsSpace(c)) significant = true;
+		at++;
+		continue;
+		}
+
+	// length of sequence from its lead byte
+	const ptrdiff_t length =
+		c >= 0xF8 ? 0 :
+		c >= 0xF0 ? 4 :
+		c >= 0xE0 ? 3 :
+		c >= 0xC0 ? 2 :
+		0;
+	if (length == 0) throw "invalid UTF-8 in XML";
+	if (end - at < length) return at;
+
+	for (ptrdiff_t i = 1; i < length; i++)
+		if ((at[i] & 0xC0) != 0x80) throw "invalid UTF-8 in XML";
+
+	significant = true;
+	at += length;
+	}
+
+return at;
+}
+
+
+
+/*	XMLTokenizer
+	Prepare to tokenize a document
+*/
+template <class Events>
+XMLTokenizer<Events>::XMLTokenizer(
+	Events		&events
+	) :
+	fEvents(events),
+	fState(kText),
+	fStarted(false),
+	fCR(false),
+	fSignificant(false),
+
+	// the one prefix that is always bound [Namespaces in XML §3]
+	fBindings { { "xml", "http://www.w3.org/XML/1998/namespace" } }
+{
+}
+
+
+/*	()
+	Tokenize the next part of the document
+*/
+template <class Events>
+void XMLTokenizer<Events>::operator()(
+	const char	data[],
+	size_t		dataL
+	)
+{
+// nothing left over from before?
+if (fPending.empty()) {
+	// tokenize in place, and only keep what couldn't be
+	const char *const end = data + dataL;
+	fPending.assign(Tokenize(data, end), end);
+	}
+
+else {
+	fPending.append(data, dataL);
+	const char *const begin = fPending.data();
+	fPending.erase(0, Tokenize(begin, begin + fPending.size()) - begin);
+	}
+}
+
+
+/*	End
+	There is no more to the document
+*/
+template <class Events>
+void XMLTokenizer<Events>::End()
+{
+// anything left unfinished?
+if (!fStarted || fState != kText || !fPending.empty() || !fElements.empty()) throw "XML document ended unexpectedly";
+
+// trailing text
+Flush();
+
+fEvents.EndDocument();
+}
+
+
+/*	Tokenize
+	Generate events for the input range; return where the input is incomplete
+*/
+template <class Events>
+const char *XMLTokenizer<Events>::Tokenize(
+	const char	*at,
+	const char	*const end
+	)
+{
+// at the very start of the document?
+if (!fStarted) {
+	// skip the byte order mark
+	switch (StartsWith(at, end, "\xEF\xBB\xBF")) {
+		case -1: return at;
+		case 1: at += 3; break;
+		}
+
+	fStarted = true;
+	fEvents.StartDocument();
+	}
+
+while (at < end)
+	switch (fState) {
+		case kText: {
+			// text up to the next markup
+			const char *const markup = static_cast<const char*>(memchr(at, '<', end - at));
+
+			/* All of the text at hand, nothing in it to replace, and it ends at a tag?  Comments
+			   and processing instructions don't end text, so text before them is kept, just as
+			   it would be if it had arrived in pieces */
+			if (
+				markup && end - markup >= 2 && markup[1] != '!' && markup[1] != '?' &&
+				fText.empty() && !fCR &&
+				!memchr(at, '&', markup - at) && !memchr(at, '\r', markup - at)
+				) {
+				// deliver it in place
+				if (Scan(at, markup, fSignificant) != markup) throw "invalid XML text";
+				if (fSignificant) fEvents.Characters(std::string_view(at, markup - at));
+				fSignificant = false;
+				}
+
+			else {
+				const char *const decoded = Decode(at, markup ? markup : end, fText, true);
+
+				// no markup yet?
+				if (!markup) return decoded;
+				if (decoded != markup) throw "invalid XML text";
+				}
+
+			// need more of the markup?
+			if (const char *const next = Markup(markup, end); next != markup)
+				at = next;
+			else
+				return markup;
+			}
+			break;
+
+		case kCDATA: {
+			const char *const terminator = Find(at, end, "]]>");
+
+			// not yet terminated?
+			if (terminator == end)
+				// keep what may be the start of the terminator
+				return Decode(at, end - std::min<ptrdiff_t>(end - at, 2), fText, false);
+
+			// all of the section at hand, and no line ends in it to normalize?
+			if (fText.empty() && !memchr(at, '\r', terminator - at)) {
+				bool significant = false;
+				if (Scan(at, terminator, significant) != terminator) throw "invalid XML CDATA section";
+
+				// deliver it in place, even if it's just white space
+				fEvents.Characters(std::string_view(at, terminator - at));
+				}
+
+			else {
+				if (Decode(at, terminator, fText, false) != terminator) throw "invalid XML CDATA section";
+
+				// deliver even if it's just white space
+				fSignificant = true;
+				Flush();
+				}
+
+			at = terminator + 3;
+			fState = kText;
+			}
+			break;
+
+		case kComment: {
+			const char *const terminator = Find(at, end, "-->");
+
+			// not yet terminated?
+			if (terminator == end)
+				return end - std::min<ptrdiff_t>(end - at, 2);
+
+			at = terminator + 3;
+			fState = kText;
+			}
+			break;
+		}
+
+return at;
+}
+
+
+/*	Markup
+	Interpret the markup starting at 'begin'; return where it ends, or 'begin' if it's incomplete
+*/
+template <class Events>
+const char *XMLTokenizer<Events>::Markup(
+	const char	*const begin,
+	const char	*const end
+	)
+{
+if (end - begin < 2) return begin;
+
+switch (begin[1]) {
+	// end tag
+	case '/': {
+		const char *const close = static_cast<const char*>(memchr(begin + 2, '>', end - begin - 2));
+		if (!close) return begin;
+
+		Flush();
+		EndTag(begin + 2, close);
+		return close + 1;
+		}
+
+	// XML declaration or processing instruction
+	case '?': {
+		const char *const close = Find(begin + 2, end, "?>");
+		if (close == end) return begin;
+
+		return close + 2;
+		}
+
+	case '!':
+		switch (StartsWith(begin, end, "<!--")) {
+			case -1: return begin;
+			case 1:
+				fState = kComment;
+				return begin + 4;
+			}
+
+		switch (StartsWith(begin, end, "<![CDATA[")) {
+			case -1: return begin;
+			case 1:
+				Flush();
+				fState = kCDATA;
+				return begin + 9;
+			}
+
+		/* A multistatus response has no business having a document type declaration; and
+		   not having to support them means there are no entities other than the predefined ones. */
+		throw "XML document type declarations aren't supported";
+
+	// start tag
+	default: {
+		// find the end of the tag, which may also appear inside attribute values
+		char quote = '\0';
+		const char *close = begin + 1;
+		for (; close < end; close++)
+			if (quote) {
+				if (*close == quote) quote = '\0';
+				}
+
+			else if (*close == '"' || *close == '\'')
+				quote = *close;
+
+			else if (*close == '>')
+				break;
+
+		if (close == end) return begin;
+
+		Flush();
+		Tag(begin + 1, close);
+		return close + 1;
+		}
+	}
+}
+
+
+/*	Tag
+	Interpret a start tag or empty element tag, given what's between its angle brackets
+*/
+template <class Events>
+void XMLTokenizer<Events>::Tag(
+	const char	*const begin,
+	const char	*end
+	)
+{
+// empty element?
+const bool empty = end > begin && end[-1] == '/';
+if (empty) end--;
+
+// qualified name
+const char *at = begin;
+while (at < end && !IsSpace(*at)) at++;
+if (at == begin) throw "invalid XML element";
+
+Element element { std::string(begin, at), fBindings.size(), std::string::npos };
+
+// attributes
+for (;;) {
+	while (at < end && IsSpace(*at)) at++;
+	if (at == end) break;
+
+	// name
+	const char *const name = at;
+	while (at < end && *at != '=' && !IsSpace(*at)) at++;
+	const std::string_view attribute(name, at - name);
+
+	while (at < end && IsSpace(*at)) at++;
+	if (at == end || *at++ != '=') throw "invalid XML attribute";
+	while (at < end && IsSpace(*at)) at++;
+
+	// quoted value
+	if (at == end || (*at != '"' && *at != '\'')) throw "invalid XML attribute";
+	const char quote = *at++;
+	const char *const value = at;
+	at = static_cast<const char*>(memchr(at, quote, end - at));
+	if (!at) throw "invalid XML attribute";
+	const char *const valueEnd = at++;
+
+	// namespace declaration?
+	/* Other attributes don't occur in multistatus responses, and aren't reported. */
+	if (attribute == "xmlns" || attribute.starts_with("xmlns:")) {
+		Binding &binding = fBindings.emplace_back();
+		binding.fPrefix = attribute.substr(std::min<size_t>(attribute.size(), 6));
+		if (Decode(value, valueEnd, binding.fURI, true) != valueEnd) throw "invalid XML attribute";
+		}
+	}
+
+// namespace and local name
+const size_t colon = element.fName.find(':');
+element.fBinding = Resolve(colon == std::string::npos ? std::string_view() : std::string_view(element.fName).substr(0, colon));
+
+const std::string_view local = std::string_view(element.fName).substr(colon == std::string::npos ? 0 : colon + 1);
+if (bool significant = false; Scan(local.data(), local.data() + local.size(), significant) != local.data() + local.size()) throw "invalid XML element";
+
+// decoding attribute values doesn't make text
+fCR = fSignificant = false;
+
+fEvents.StartElement(Namespace(element), local, {});
+
+// no content?
+if (empty) {
+	fEvents.EndElement(Namespace(element), local);
+
+	// bindings go out of scope
+	fBindings.resize(element.fBindingsN);
+	}
+
+else
+	fElements.push_back(std::move(element));
+}
+
+
+/*	EndTag
+	Interpret an end tag, given what's between '</' and '>'
+*/
+template <class Events>
+void XMLTokenizer<Events>::EndTag(
+	const char	*const begin,
+	const char	*end
+	)
+{
+while (end > begin && IsSpace(end[-1])) end--;
+
+// must match the innermost element
+if (fElements.empty() || std::string_view(begin, end - begin) != fElements.back().fName) throw "mismatched XML end tag";
+const Element &element = fElements.back();
+
+const size_t colon = element.fName.find(':');
+fEvents.EndElement(
+	Namespace(element),
+	std::string_view(element.fName).substr(colon == std::string::npos ? 0 : colon + 1)
+	);
+
+// bindings go out of scope
+fBindings.resize(element.fBindingsN);
+fElements.pop_back();
+}
+
+
+/*	Flush
+	Deliver the text so far, unless it's just white space
+*/
+template <class Events>
+void XMLTokenizer<Events>::Flush()
+{
+if (fSignificant) fEvents.Characters(fText);
+
+fText.clear();
+fCR = fSignificant = false;
+}
+
+
+/*	Resolve
+	Return the binding of the namespace prefix, or npos if there is no namespace
+*/
+template <class Events>
+size_t XMLTokenizer<Events>::Resolve(
+	std::string_view prefix
+	) const
+{
+// innermost declaration
+for (size_t i = fBindings.size(); i-- > 0;)
+	if (fBindings[i].fPrefix == prefix) return i;
+
+// only the default namespace may be left undeclared
+if (!prefix.empty()) throw "undeclared XML namespace prefix";
+
+return std::string::npos;
+}
+
+
+/*	Namespace
+	Return the namespace URI of the element, or the empty string if it has none
+*/
+template <class Events>
+std::string_view XMLTokenizer<Events>::Namespace(
+	const Element	&element
+	) const
+{
+return element.fBinding == std::string::npos ? std::string_view() : std::string_view(fBindings[element.fBinding].fURI);
+}
+
+
+/*	Decode
+	Append the UTF-8 range to the string, normalizing line ends and (optionally) replacing
+	references; return where the range ends in an incomplete character or reference
+*/
+template <class Events>
+const char *XMLTokenizer<Events>::Decode(
+	const char	*at,
+	const char	*const end,
+	std::string	&to,
+	bool		entities
+	)
+{
+while (at < end) {
+	// LF following CR has already been accounted for
+	if (fCR) {
+		fCR = false;
+		if (*at == '\n') { at++; continue; }
+		}
+
+	switch (*at) {
+		// line ends are normalized to LF [XML §2.11]
+		case '\r':
+			to.push_back('\n');
+			fCR = true;
+			at++;
+			break;
+
+		case '&':
+			if (entities) {
+				// (longest is "&#x10FFFF;")
+				constexpr ptrdiff_t kReferenceMaximum = 10;
+
+				const char *const semicolon = static_cast<const char*>(memchr(at, ';', std::min(end - at, kReferenceMaximum)));
+				if (!semicolon) {
+					if (end - at < kReferenceMaximum) return at;
+					throw "invalid XML reference";
+					}
+
+				const std::string_view name(at + 1, semicolon - at - 1);
+				if (name == "lt") to.push_back('<');
+				else if (name == "gt") to.push_back('>');
+				else if (name == "amp") to.push_back('&');
+				else if (name == "quot") to.push_back('"');
+				else if (name == "apos") to.push_back('\'');
+
+				// character reference
+				else if (name.size() >= 2 && name[0] == '#') {
+					const bool hex = name[1] == 'x';
+					char *digitsEnd;
+					const unsigned long code = strtoul(name.data() + (hex ? 2 : 1), &digitsEnd, hex ? 16 : 10);
+					if (digitsEnd != semicolon || code > 0x10FFFF) throw "invalid XML reference";
+					Append(to, static_cast<char32_t>(code));
+					}
+
+				else
+					throw "undefined XML entity";
+
+				fSignificant = true;
+				at = semicolon + 1;
+				break;
+				}
+			[[fallthrough]];
+
+		default: {
+			// run up to the next character that needs attention
+			const char *run = at + 1;
+			while (run < end && *run != '\r' && (*run != '&' || !entities)) run++;
+
+			// copied as it is
+			const char *const scanned = Scan(at, run, fSignificant);
+			to.append(at, scanned);
+			if (scanned != run) {
+				// a character can only be incomplete at the end of the input
+				if (run != end) throw "invalid UTF-8 in XML";
+				return scanned;
+				}
+
+			at = run;
+			}
+			break;
+		}
+	}
+
+return at;
+}
+
+
+// explicit instantiation
+#include "ParseXMLStates.h"
+template struct XMLTokenizer<StateParser>;
+template struct XMLTokenizer<StateMachine>;
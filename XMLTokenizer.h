@@ -0,0 +1,96 @@
+/*
+	XMLTokenizer
+
+	Portable streaming XML tokenizer
+
+	2023/06/14	Originated
+
+	Copyright © 2023 by: Ben Hekster
+
+	Made to measure for WebDAV multistatus responses: no DTDs, a small vocabulary of
+	elements in a handful of namespaces, and the occasional very large text node (calendar
+	data).  The input is UTF-8, and may be supplied in arbitrary pieces as it arrives from
+	the network; names and text are delivered as UTF-8 as well, straight from the input where
+	possible.
+
+	Not a validating parser, and barely a checking one: it will reject a document where it
+	can't make sense of the markup, or where elements aren't properly nested.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+/*	XMLTokenizer
+	Turn a stream of UTF-8 bytes into XML parse events
+
+	The events are the same as those generated by XMLParser:
+		StartDocument()
+		EndDocument()
+		StartElement(namespaceURI, localName, attributes)
+		EndElement(namespaceURI, localName)
+		Characters(text)
+
+	Attributes aren't reported (only namespace declarations are interpreted); and text that
+	is only whitespace isn't either.  Each text node or CDATA section is delivered whole, with
+	line ends normalized; comments and processing instructions don't interrupt text, so however
+	the input is split up, the events are the same.  The strings are only valid for the duration
+	of the event.
+*/
+template <class Events>
+struct XMLTokenizer {
+protected:
+	enum State {
+		kText,				// character data, or the start of markup
+		kCDATA,				// inside <![CDATA[ ... ]]>
+		kComment			// inside <!-- ... -->
+		};
+
+	// namespace prefix in scope
+	struct Binding {
+		std::string	fPrefix;
+		std::string	fURI;
+		};
+
+	// element not yet ended
+	struct Element {
+		std::string	fName;		// qualified
+		size_t		fBindingsN;	// number of bindings in scope before the element
+		size_t		fBinding;	// of the element's namespace
+		};
+
+	Events		&fEvents;
+	State		fState;
+	bool		fStarted,			// StartDocument() issued
+			fCR,				// last character of text was a CR
+			fSignificant;			// text contains other than whitespace
+
+	std::string	fPending;			// input not yet tokenized
+	std::string	fText;				// text node so far, if it couldn't be delivered in place
+	std::vector<Binding> fBindings;
+	std::vector<Element> fElements;
+
+
+	const char	*Tokenize(const char *begin, const char *end);
+	const char	*Markup(const char *begin, const char *end);
+	void		Tag(const char *begin, const char *end);
+	void		EndTag(const char *begin, const char *end);
+	void		Flush();
+
+	const char	*Decode(const char *begin, const char *end, std::string&, bool entities);
+	size_t		Resolve(std::string_view prefix) const;
+	std::string_view Namespace(const Element&) const;
+
+public:
+	explicit	XMLTokenizer(Events&);
+			XMLTokenizer(const XMLTokenizer&) = delete;
+
+	void		operator()(const char data[], size_t dataL);
+	void		End();
+	};
@@ -10,17 +10,28 @@
 */
 
 #define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#define _CRT_RAND_S
 
+#include <winsock2.h>
+#include <sddl.h>
 #include <io.h>
 #include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include <algorithm>
 #include <codecvt>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
+#include "DiscoveryCache.h"
 #include "Dynamic.h"
 #include "Edit.h"
 #include "ServiceLocation.h"
 #include "Session.h"
+#include "String.h"
 
 
 
@@ -96,6 +107,25 @@ session.ExportCalendar(calendarPath);
 }
 
 
+/*	MirrorCalendar
+	Export a calendar from a local mirror, bringing it up to date first
+*/
+static void MirrorCalendar(
+	Session		&session,
+	int		argc,
+	const wchar_t	*argv[]
+	)
+{
+// calendar name and mirror file
+if (argc != 2) throw "mirror-calendar path file";
+const wchar_t
+	*const calendarPath = (--argc, *argv++),
+	*const mirrorPath = (--argc, *argv++);
+
+session.ExportCalendarMirrored(calendarPath, mirrorPath);
+}
+
+
 /*	SynchronizeCalendar
 	Synchronize calendar using a synchronization token
 */
@@ -234,10 +264,16 @@ static void ReadCalendarItems(
 	const wchar_t	*argv[]
 	)
 {
+// names are interned for this command only, rather than for the life of the process (or daemon)
+InternTable<char> intern;
+
 // for each URL argument
-for (; argc > 0; --argc, argv++)
-	// print parsed calendar item to standard output
-	std::wcout << session.ReadCalendarItemFromCalDAV(*argv);
+for (; argc > 0; --argc, argv++) {
+	// print parsed calendar item to standard output, widened only for that
+	std::ostringstream os;
+	os << session.ReadCalendarItemFromCalDAV(*argv, intern);
+	std::wcout << Widen(os.view());
+	}
 }
 
 
@@ -268,15 +304,19 @@ static void EditCalendarItem(
 if (argc < 1) throw "edit-cal-items: path [commands...]";
 const wchar_t *const path = (--argc, *argv++);
 
-// read from file
-DynamicCalendar<wchar_t> calendarItem = session.ReadCalendarItemFromCalDAV(path);
+// read from file, interning names for this command only
+InternTable<char> intern;
+DynamicCalendar<char> calendarItem = session.ReadCalendarItemFromCalDAV(path, intern);
 
 // apply editing commands to calendar item
 ApplyEditsToCalendarItem(calendarItem, argc, argv);
 
 // write back
 session.WriteCalendarItemToCalDAV(path, calendarItem);
-std::wcout << calendarItem;
+
+std::ostringstream os;
+os << calendarItem;
+std::wcout << Widen(os.view());
 }
 
 
@@ -312,6 +352,424 @@ session.SupportedCollationSett(path);
 }
 
 
+/*	Command
+	Command that needs a service connection
+*/
+struct Command {
+	const wchar_t	*name;
+	void		(*action)(Session&, int argc, const wchar_t *argv[]);
+	};
+
+static const Command gCommands[] = {
+	{ L"create-calendar", CreateCalendar },
+	{ L"delete-calendar", DeleteCalendar },
+	{ L"rename-calendar", RenameCalendar },
+	{ L"export-calendar", ExportCalendar },
+	{ L"mirror-calendar", MirrorCalendar },
+	{ L"synchronize-calendar", SynchronizeCalendar },
+	{ L"query-calendar", QueryCalendar },
+	{ L"list-calendars", ListCalendars },
+	{ L"list-items", ListCalendarItems },
+	{ L"read-items", ReadItems },
+	{ L"read-items-properties", ReadItemsProperties },
+	{ L"read-items-property-names", ReadItemsPropertyNames },
+	{ L"write-items", WriteItems },
+	{ L"read-cal-items", ReadCalendarItems },
+	{ L"write-cal-items", WriteCalendarItems },
+	{ L"edit-cal-item", EditCalendarItem },
+	{ L"supported-report-set", SupportedReportSet },
+	{ L"supported-collation-set", SupportedCollationSett }
+	};
+
+
+/*	FindCommand
+	Return the named command
+*/
+static const Command &FindCommand(
+	const wchar_t	name[]
+	)
+{
+const Command *const command = std::find_if(
+	std::begin(gCommands), std::end(gCommands),
+	[name](const Command &c) { return wcscmp(c.name, name) == 0; }
+	); if (command == std::end(gCommands)) throw "unknown command";
+
+return *command;
+}
+
+
+/*	Performer
+	Performs a command, given its name and subarguments, against the one session
+*/
+using Performer = std::function<void (int argc, const wchar_t *argv[])>;
+
+
+/*	ReportError
+	Describe the exception currently being handled
+*/
+static void ReportError(
+	std::wostream	&out
+	)
+{
+try {
+	throw;
+	}
+
+catch (const std::exception &error) {
+	out << "error: " << error.what() << std::endl;
+	}
+
+catch (const char error[]) {
+	out << "error: " << error << std::endl;
+	}
+
+catch (const unsigned long error) {
+	out << "error " << error << std::endl;
+	}
+
+catch (const unsigned status) {
+	out << "error: HTTP status " << status << std::endl;
+	}
+
+catch (...) {
+	out << "error" << std::endl;
+	}
+}
+
+
+/*	Arguments
+	Split a command line into its arguments
+	
+	Arguments are separated by whitespace; an argument containing whitespace can be put
+	in double quotes.
+*/
+static std::vector<std::wstring> Arguments(
+	const std::wstring_view line
+	)
+{
+std::vector<std::wstring> result;
+
+for (auto c = line.begin(); ; ) {
+	// skip whitespace
+	while (c != line.end() && iswspace(*c)) c++;
+	if (c == line.end()) break;
+	
+	std::wstring &argument = result.emplace_back();
+	for (bool quoted = false; c != line.end() && (quoted || !iswspace(*c)); c++)
+		if (*c == L'"')
+			quoted = !quoted;
+		else
+			argument += *c;
+	}
+
+return result;
+}
+
+
+/*	PerformLine
+	Perform one command line of a batch, reporting rather than throwing its error; return
+	whether it succeeded
+*/
+static bool PerformLine(
+	const std::wstring_view line,
+	const Performer	&Perform,
+	std::wostream	&errors
+	)
+{
+const std::vector<std::wstring> arguments = Arguments(line);
+
+// blank line or comment?
+if (arguments.empty() || arguments.front()[0] == L'#') return true;
+
+std::vector<const wchar_t*> argv;
+for (const std::wstring &argument: arguments)
+	argv.push_back(argument.c_str());
+
+try {
+	Perform(static_cast<int>(argv.size()), argv.data());
+	}
+
+catch (...) {
+	ReportError(errors);
+	return false;
+	}
+
+return true;
+}
+
+
+/*	BatchLines
+	Perform each line of a script in UTF-8; return whether they all succeeded
+*/
+static bool BatchLines(
+	std::istream	&script,
+	const Performer	&Perform
+	)
+{
+bool result = true;
+
+for (std::string line; std::getline(script, line); std::wcout.flush()) {
+	// written on Windows, but read as bytes?
+	if (line.ends_with('\r')) line.pop_back();
+	
+	if (!PerformLine(Widen(line), Perform, std::wcerr)) result = false;
+	}
+
+return result;
+}
+
+
+/*	Batch
+	Perform commands read a line at a time from a script file, or else standard input; return
+	whether they all succeeded
+*/
+static bool Batch(
+	int		argc,
+	const wchar_t	*argv[],
+	const Performer	&Perform
+	)
+{
+if (argc > 1) throw "batch [file]";
+
+// from a script file?  that's in UTF-8
+if (argc == 1) {
+	std::ifstream ifs(std::filesystem::path(*argv), std::ios::in);
+	if (!ifs) throw "can't open batch file";
+	
+	return BatchLines(ifs, Perform);
+	}
+
+// from a pipe or a redirected file?  that's in UTF-8 too, not the console's UTF-16
+if (!_isatty(_fileno(stdin))) {
+	_setmode(_fileno(stdin), _O_BINARY);
+	return BatchLines(std::cin, Perform);
+	}
+
+// from the console, which is already wide
+bool result = true;
+for (std::wstring line; std::getline(std::wcin, line); std::wcout.flush())
+	if (!PerformLine(line, Perform, std::wcerr)) result = false;
+
+return result;
+}
+
+
+/*	AppDataPath
+	Return where to keep the named file of ours; or empty if there's nowhere to keep it
+*/
+static std::wstring AppDataPath(
+	const wchar_t	name[]
+	)
+{
+std::wstring result;
+
+wchar_t *directory;
+size_t directoryL;
+if (_wdupenv_s(&directory, &directoryL, L"LOCALAPPDATA") == 0 && directory) {
+	result = std::wstring(directory) + L"\\Casaubon\\" + name;
+	free(directory);
+	}
+
+return result;
+}
+
+
+/*	WinSock
+	Keep the Windows Sockets library initialized
+*/
+struct WinSock {
+			WinSock()
+			{
+			WSADATA data;
+			if (const int error = WSAStartup(MAKEWORD(2, 2), &data)) throw static_cast<unsigned long>(error);
+			}
+			WinSock(const WinSock&) = delete;
+			~WinSock() { WSACleanup(); }
+	};
+
+
+/*	Socket
+	Owned socket
+*/
+struct Socket {
+	const SOCKET	fSocket;
+	
+	explicit	Socket(SOCKET socket) : fSocket(socket) { if (fSocket == INVALID_SOCKET) throw static_cast<unsigned long>(WSAGetLastError()); }
+			Socket(const Socket&) = delete;
+			~Socket() { closesocket(fSocket); }
+	
+			operator SOCKET() const { return fSocket; }
+	};
+
+
+/*	DaemonToken
+	Make up the secret that the daemon's clients must send first, and leave it in the given file
+	
+	The file is made afresh every time, with a DACL that only lets its owner at it; rather than
+	overwritten, which would keep the DACL of whatever file was there.
+*/
+static std::string DaemonToken(
+	const std::wstring &path
+	)
+{
+// 256 random bits, in hex
+std::string result;
+for (unsigned i = 0; i < 8; i++) {
+	unsigned int random;
+	if (rand_s(&random)) throw "can't make daemon token";
+	
+	char hex[9];
+	snprintf(hex, sizeof hex, "%08x", random);
+	result += hex;
+	}
+
+std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+if (!DeleteFileW(path.c_str()) && GetLastError() != ERROR_FILE_NOT_FOUND) throw GetLastError();
+
+// protected from inheritance, and full access for the owner only
+SECURITY_ATTRIBUTES attributes { sizeof attributes, nullptr, FALSE };
+if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(L"D:P(A;;FA;;;OW)", SDDL_REVISION_1, &attributes.lpSecurityDescriptor, nullptr))
+	throw GetLastError();
+
+const HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, &attributes, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+const DWORD createError = GetLastError();
+LocalFree(attributes.lpSecurityDescriptor);
+if (file == INVALID_HANDLE_VALUE) throw createError;
+
+const std::string line = result + '\n';
+DWORD writtenL;
+const BOOL written = WriteFile(file, line.data(), static_cast<DWORD>(line.size()), &writtenL, nullptr);
+const DWORD writeError = GetLastError();
+CloseHandle(file);
+if (!written) throw writeError;
+
+return result;
+}
+
+
+/*	Reply
+	Return a command's output as it's sent back to the client
+	
+	In UTF-8 and terminated by a line consisting of a single '.'; like SMTP [RFC 5321 §4.5.2],
+	a line of output that itself begins with '.' gets another one in front of it.
+*/
+static std::string Reply(
+	const std::wstring_view output
+	)
+{
+std::string result;
+
+for (size_t lineB = 0; lineB < output.size(); ) {
+	const size_t lineE = std::min(output.find(L'\n', lineB), output.size());
+	const std::wstring_view line = output.substr(lineB, lineE - lineB);
+	
+	if (!line.empty() && line.front() == L'.') result += '.';
+	
+	// append the line in UTF-8
+	result += Narrow(line);
+	result += '\n';
+	
+	lineB = lineE + 1;
+	}
+
+result += ".\n";
+return result;
+}
+
+
+/*	Daemon
+	Perform commands received over connections to a loopback TCP port
+	
+	Each line received is a command, and its Reply is its output and any error.  Connections
+	are served one at a time, since they all share the one session.
+	
+	Anyone who can connect acts with the user's credentials; so only the loopback address is
+	listened on, with the port bound exclusively, and the first line of a connection must be
+	the token the daemon left in "daemon.token" beside the discovery cache, where only the
+	user can read it.  A connection that starts with anything else (such as a web page's
+	request) is dropped unanswered.
+*/
+static void Daemon(
+	int		argc,
+	const wchar_t	*argv[],
+	const Performer	&Perform
+	)
+{
+if (argc != 1) throw "daemon port";
+const unsigned long port = wcstoul(*argv, nullptr, 10);
+if (port == 0 || port > 0xFFFF) throw "daemon port";
+
+const std::wstring tokenPath = AppDataPath(L"daemon.token");
+if (tokenPath.empty()) throw "nowhere to keep the daemon token";
+const std::string token = DaemonToken(tokenPath);
+
+const WinSock winSock;
+
+// listen on the loopback address; and don't let anyone else bind the port as well
+const Socket listener(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+const BOOL exclusive = TRUE;
+if (setsockopt(listener, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&exclusive), sizeof exclusive))
+	throw static_cast<unsigned long>(WSAGetLastError());
+
+sockaddr_in address {};
+address.sin_family = AF_INET;
+address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+address.sin_port = htons(static_cast<u_short>(port));
+if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof address)) throw static_cast<unsigned long>(WSAGetLastError());
+if (listen(listener, SOMAXCONN)) throw static_cast<unsigned long>(WSAGetLastError());
+
+for (;;) {
+	const Socket connection(accept(listener, nullptr, nullptr));
+	bool authenticated = false;
+	
+	// perform a line received, unless it's not from one of our clients
+	const auto Serve = [&](std::string_view line) {
+		if (line.ends_with('\r')) line.remove_suffix(1);
+		
+		// first line must be the token
+		if (!authenticated) return authenticated = line == token;
+		
+		// collect the command's output
+		std::wostringstream output;
+		std::wstreambuf *const console = std::wcout.rdbuf(output.rdbuf());
+		PerformLine(Widen(line), Perform, output);
+		std::wcout.rdbuf(console);
+		
+		// send it back
+		const std::string reply = Reply(output.str());
+		for (std::string_view unsent = reply; !unsent.empty(); ) {
+			const int sent = send(connection, unsent.data(), static_cast<int>(unsent.size()), 0);
+			if (sent == SOCKET_ERROR) break;
+			unsent.remove_prefix(sent);
+			}
+		
+		return true;
+		};
+	
+	// receive until the client shuts down the connection, or it fails, or it's not one of ours
+	std::string received;
+	char buffer[0x1000];
+	bool serving = true;
+	int bufferL;
+	while (serving && (bufferL = recv(connection, buffer, sizeof buffer, 0)) > 0) {
+		received.append(buffer, bufferL);
+		
+		// perform each complete line
+		for (size_t lineE; serving && (lineE = received.find('\n')) != std::string::npos; received.erase(0, lineE + 1))
+			serving = Serve(std::string_view(received).substr(0, lineE));
+		
+		// no token among the first few bytes?
+		if (!authenticated && received.size() > token.size() + 2) serving = false;
+		}
+	
+	// last line without a line end, from a client that shut down its side in good order?
+	/* Not after a failure, as the line may have been cut short */
+	if (serving && bufferL == 0 && !received.empty())
+		Serve(received);
+	}
+}
+
+
 /*	main
 	Command-line entry point
 */
@@ -346,6 +804,8 @@ std::locale gLocale(
 	);
 std::wcout.imbue(gLocale);
 
+int result = EXIT_SUCCESS;
+
 try {
 	// must have at least all required command-line arguments
 	if (argc < 5) throw "caldavutil hostname username password command";
@@ -360,21 +820,26 @@ try {
 		*const password = (--argc, *argv++);
 	
 	
+	const auto Locate = [hostname]() {
+		std::optional<DAVServiceLocation> locationp = DAVServiceLocation::Locate(
+			DAVServiceLocation::kCalDAVSecure, L"tcp",
+			hostname
+			);
+		if (!locationp) throw "unable to locate service";
+		return std::move(*locationp);
+		};
+	
+	
 	/*
 	
 		commands that need service location, but not connection
 	
 	*/
 	
-	std::optional<DAVServiceLocation> locationp = DAVServiceLocation::Locate(
-		DAVServiceLocation::kCalDAVSecure, L"tcp",
-		hostname
-		);
-	if (!locationp) throw "unable to locate service";
-	DAVServiceLocation &location = *locationp;
-	
 	// locate service?
 	if (std::wcscmp(*argv, L"location") == 0) {
+		const DAVServiceLocation location = Locate();
+		
 		// print the resolved location of the CalDAV service
 		std::wcout << location.fHost << ':' << location.fPort << location.fPath << '\n';
 		}
@@ -387,66 +852,80 @@ try {
 	*/
 	
 	else {
-		const static struct Command {
-			const wchar_t	*name;
-			void		(*action)(Session&, int argc, const wchar_t *argv[]);
-			} commands[] = {
-			{ L"create-calendar", CreateCalendar },
-			{ L"delete-calendar", DeleteCalendar },
-			{ L"rename-calendar", RenameCalendar },
-			{ L"export-calendar", ExportCalendar },
-			{ L"synchronize-calendar", SynchronizeCalendar },
-			{ L"query-calendar", QueryCalendar },
-			{ L"list-calendars", ListCalendars },
-			{ L"list-items", ListCalendarItems },
-			{ L"read-items", ReadItems },
-			{ L"read-items-properties", ReadItemsProperties },
-			{ L"read-items-property-names", ReadItemsPropertyNames },
-			{ L"write-items", WriteItems },
-			{ L"read-cal-items", ReadCalendarItems },
-			{ L"write-cal-items", WriteCalendarItems },
-			{ L"edit-cal-item", EditCalendarItem },
-			{ L"supported-report-set", SupportedReportSet },
-			{ L"supported-collation-set", SupportedCollationSett }
-			};
+		// one command given on the command line, rather than many from elsewhere?
+		const bool batch = std::wcscmp(*argv, L"batch") == 0,
+			daemon = std::wcscmp(*argv, L"daemon") == 0;
+		if (!batch && !daemon) FindCommand(*argv);
 		
-		// find command to perform
-		const Command *const command = std::find_if(
-			std::begin(commands), std::end(commands),
-			[arg = *argv](const Command &c) { return wcscmp(c.name, arg) == 0; }
-			); if (command == std::end(commands)) throw "unknown command";
-		--argc, argv++;
+		// what was discovered about the service the last time, if anywhere to keep it
+		std::optional<DiscoveryCache> cache;
+		if (const std::wstring cachePath = AppDataPath(L"discovery.cache"); !cachePath.empty())
+			cache.emplace(cachePath.c_str());
 		
-		// resolve the DNS address
-		CHTTPClient::Address address(true, location.fHost.c_str(), location.fPort);
+		// connections kept alive between the commands of a batch or daemon
+		CHTTPClient::Pool pool;
 		
-		// connect to the service
-		Session session = Session::MakeFromServiceLocation(
-			address,
-			location.fPath.c_str(),
-			username, password
-			);
+		std::optional<Session> session;
+		
+		// still know where everything is?
+		if (const DiscoveryCache::Entry *const cached = cache ? cache->Find(hostname, username) : nullptr)
+			session.emplace(Session::MakeFromDiscovery(pool, *cached, username, password));
+		
+		else {
+			const DAVServiceLocation location = Locate();
+			
+			// resolve the DNS address
+			CHTTPClient::Address address(true, location.fHost.c_str(), location.fPort);
+			
+			// connect to the service
+			DiscoveryCache::Entry discovered;
+			session.emplace(
+				Session::MakeFromServiceLocation(
+					pool,
+					address,
+					location.fPath.c_str(),
+					username, password,
+					&discovered
+					)
+				);
+			
+			if (cache) cache->Store(hostname, username, std::move(discovered));
+			}
+		
+		const Performer Perform = [&](int argc, const wchar_t *argv[]) {
+			const Command &command = FindCommand(*argv);
+			
+			try {
+				(*command.action)(*session, argc - 1, argv + 1);
+				}
+			
+			catch (const unsigned status) {
+				/* The credentials might have changed, or the home set moved; either way, discover
+				   everything again the next time.  But a path the user gave that isn't found says
+				   nothing about what was discovered. */
+				if (cache && (status == 401 || (status == 404 && !session->HomeSetFound())))
+					cache->Forget(hostname, username);
+				throw;
+				}
+			};
 		
-		// perform command
-		(*command->action)(session, argc, argv);
+		// perform commands
+		if (batch) {
+			if (!Batch(argc - 1, argv + 1, Perform)) result = EXIT_FAILURE;
+			}
+		
+		else if (daemon)
+			Daemon(argc - 1, argv + 1, Perform);
+		
+		else
+			Perform(argc, argv);
 		}
 	}
 
-catch (const std::exception &error) {
-	std::wcerr << "error: " << error.what() << std::endl;
-	}
-
-catch (const char error[]) {
-	std::wcerr << "error: " << error << std::endl;
-	}
-
-catch (const unsigned long error) {
-	std::wcerr << "error " << error << std::endl;
-	}
-
 catch (...) {
-	std::wcerr << "error" << std::endl;
+	ReportError(std::wcerr);
+	result = EXIT_FAILURE;
 	}
 
-return 0;
+return result;
 }